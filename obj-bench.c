@@ -0,0 +1,842 @@
+/**************************************************************************************************
+ * Obj Reader
+ *
+ * File: obj-bench.c
+ *
+ * Author: Jordan Emme
+ *
+ * Description: Benchmark of the obj reader.
+ *
+ *    Generates a synthetic wavefront file, or takes existing ones, and times obj_read end to end as
+ * well as the phases of a read: the counting pass, the allocation of the mesh arrays, and the
+ * parsing of the vertex and face lines. The meshes read are also timed as they are written back
+ * with obj_write, on one thread and on several. Throughputs are reported in MB/s and lines/s so
+ * that they can be compared across changes. The library source is included rather than linked, so
+ * that its internal phases can be timed on their own. The throughputs can be saved as a baseline,
+ * which later runs over the same corpus are then gated against. Build with:
+ *
+ *    cc -O2 -o obj-bench obj-bench.c -pthread -lm
+ *
+ * Copyright (c) 2025 Jordan Emme
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions: The above copyright notice and this
+ * permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+/**************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+
+#include <stdarg.h>
+
+#include "obj-reader.c"
+
+/**************************************************************************************************
+ * Macros
+ *************************************************************************************************/
+
+#define BENCH_DEFAULT_PATH "obj-bench.obj"
+
+// Scratch file the meshes read are written back to, and threads of the multithreaded writes
+#define BENCH_WRITE_PATH    "obj-bench-write.obj"
+#define BENCH_WRITE_THREADS (4u)
+
+// Longest file path and phase name of a baseline, and default slowdown allowed against it
+#define BENCH_MAX_KEY_LEN       (512u)
+#define BENCH_DEFAULT_TOLERANCE (10u)
+
+/**************************************************************************************************
+ * Types
+ *************************************************************************************************/
+
+typedef enum Obj_BenchIndexStyle {
+    OBJ_BENCH_INDEX_P   = 0,  // p
+    OBJ_BENCH_INDEX_PT  = 1,  // p/t
+    OBJ_BENCH_INDEX_PN  = 2,  // p//n
+    OBJ_BENCH_INDEX_PTN = 3,  // p/t/n
+} Obj_BenchIndexStyle;
+
+/*
+ * Obj_BenchOptions:
+ *
+ * Command line options of the benchmark
+ * @numVerts: number of vertex positions of the generated file, and of its texture coordinates and
+ *  normals when its faces refer to them
+ * @numFaces: number of faces of the generated file
+ * @arity: number of vertices per face
+ * @indexStyle: form of the face vertices
+ * @negativeIndices: whether faces use relative (negative) indices
+ * @noise: whether to insert extra blanks, comments, blank lines and CRLF line endings
+ * @seed: seed of the generated values
+ * @numRuns: number of timed runs, of which the fastest is reported
+ * @outPath: path the generated file is written to
+ * @keep: whether to keep the generated file once done
+ * @baselinePath: file of the baseline throughputs the runs are gated against, or NULL
+ * @savePath: file the throughputs measured are saved to as a baseline, or NULL
+ * @tolerance: slowdown allowed against the baseline, in percent of its throughputs
+ */
+typedef struct Obj_BenchOptions {
+    uint32_t            numVerts;
+    uint32_t            numFaces;
+    uint32_t            arity;
+    Obj_BenchIndexStyle indexStyle;
+    bool                negativeIndices;
+    bool                noise;
+    uint64_t            seed;
+    uint32_t            numRuns;
+    const char         *outPath;
+    bool                keep;
+    const char         *baselinePath;
+    const char         *savePath;
+    uint32_t            tolerance;
+} Obj_BenchOptions;
+
+/*
+ * Obj_BenchBuffer:
+ *
+ * Growing buffer the generated file is written to
+ */
+typedef struct Obj_BenchBuffer {
+    char  *data;
+    size_t len;
+    size_t capacity;
+} Obj_BenchBuffer;
+
+/*
+ * Obj_BenchCorpus:
+ *
+ * File being benchmarked, loaded in memory
+ * @facesBegin: offset of the first face line. Lines before it are timed as vertex lines and lines
+ *  after it as face lines.
+ */
+typedef struct Obj_BenchCorpus {
+    const char *path;
+    char       *data;
+    size_t      len;
+    size_t      facesBegin;
+    uint64_t    numLines;
+    uint64_t    numVertexLines;
+} Obj_BenchCorpus;
+
+typedef struct Obj_BenchPhases {
+    double count;
+    double alloc;
+    double vertices;
+    double faces;
+} Obj_BenchPhases;
+
+/*
+ * Obj_BenchPhase:
+ *
+ * Timing of a phase of the reads of a file
+ * @bytes, @lines: input the phase goes through, none for the phases which do not read the file
+ */
+typedef struct Obj_BenchPhase {
+    const char *name;
+    double      seconds;
+    size_t      bytes;
+    uint64_t    lines;
+} Obj_BenchPhase;
+
+/*
+ * Obj_BenchBaseline:
+ *
+ * Throughput of a phase of the reads of a file, in MB/s, as saved by an earlier run
+ */
+typedef struct Obj_BenchBaseline {
+    char   file[BENCH_MAX_KEY_LEN];
+    char   phase[BENCH_MAX_KEY_LEN];
+    double throughput;
+} Obj_BenchBaseline;
+
+/*
+ * Obj_BenchGate:
+ *
+ * Throughput gate the runs are checked against
+ * @baselines, @numBaselines: throughputs of the baseline, none when the runs are not gated
+ * @tolerance: slowdown allowed against the baseline, as a fraction of its throughputs
+ * @saved: file the throughputs measured are saved to, or NULL
+ * @passed: whether no phase fell below its baseline so far
+ */
+typedef struct Obj_BenchGate {
+    Obj_BenchBaseline *baselines;
+    uint32_t           numBaselines;
+    double             tolerance;
+    FILE              *saved;
+    bool               passed;
+} Obj_BenchGate;
+
+/**************************************************************************************************
+ * Static helpers
+ *************************************************************************************************/
+
+static double min_double(double a, double b) {
+    return a < b ? a : b;
+}
+
+/*
+ * xorshift64* generator, so that corpora only depend on their seed
+ */
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static float random_float(uint64_t *state, float min, float max) {
+    return min + (max - min) * (float)(next_random(state) >> 40) / (float)(1u << 24);
+}
+
+static bool reserve_buffer(Obj_BenchBuffer *buffer, size_t needed) {
+    if (buffer->len + needed <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 1u << 16;
+    while (capacity < buffer->len + needed) {
+        capacity *= 2u;
+    }
+    char *data = realloc(buffer->data, capacity);
+    if (!data) {
+        return false;
+    }
+    buffer->data     = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static bool append_format(Obj_BenchBuffer *buffer, const char *format, ...) {
+    // Every fragment appended by the generator fits in 64 bytes
+    if (!reserve_buffer(buffer, 64u)) {
+        return false;
+    }
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer->data + buffer->len, buffer->capacity - buffer->len, format, args);
+    va_end(args);
+    if (len < 0) {
+        return false;
+    }
+    buffer->len += (size_t)len;
+    return true;
+}
+
+/*
+ * Appends the blanks separating two tokens, which are a single space unless noise is asked for
+ */
+static bool append_separator(
+    Obj_BenchBuffer        *buffer,
+    const Obj_BenchOptions *options,
+    uint64_t               *rng
+) {
+    if (!options->noise) {
+        return append_format(buffer, " ");
+    }
+    static const char *SEPARATORS[] = {" ", " ", "  ", "\t", " \t", "   "};
+    return append_format(buffer, "%s", SEPARATORS[next_random(rng) % 6u]);
+}
+
+static bool append_line_end(
+    Obj_BenchBuffer        *buffer,
+    const Obj_BenchOptions *options,
+    uint64_t               *rng
+) {
+    if (!options->noise) {
+        return append_format(buffer, "\n");
+    }
+    uint64_t roll = next_random(rng) % 16u;
+    switch (roll) {
+        case 0:
+            return append_format(buffer, " \n");
+        case 1:
+            return append_format(buffer, "\r\n");
+        case 2:
+            return append_format(buffer, "\n\n");
+        case 3:
+            return append_format(buffer, "\n# noise comment\n");
+        default:
+            return append_format(buffer, "\n");
+    }
+}
+
+static bool append_vector(
+    Obj_BenchBuffer        *buffer,
+    const Obj_BenchOptions *options,
+    uint64_t               *rng,
+    const char             *keyword,
+    uint32_t                numValues,
+    float                   min,
+    float                   max
+) {
+    bool appended = append_format(buffer, "%s", keyword);
+    for (uint32_t i = 0u; appended && i < numValues; ++i) {
+        appended = append_separator(buffer, options, rng)
+                && append_format(buffer, "%.6f", (double)random_float(rng, min, max));
+    }
+    return appended && append_line_end(buffer, options, rng);
+}
+
+/*
+ * Appends the index of element @idx, out of the @numElements declared before the faces
+ */
+static bool append_index(
+    Obj_BenchBuffer        *buffer,
+    const Obj_BenchOptions *options,
+    uint32_t                idx,
+    uint32_t                numElements
+) {
+    if (options->negativeIndices) {
+        return append_format(buffer, "-%u", numElements - idx);
+    }
+    return append_format(buffer, "%u", idx + 1u);
+}
+
+static bool append_face(
+    Obj_BenchBuffer        *buffer,
+    const Obj_BenchOptions *options,
+    uint64_t               *rng,
+    uint32_t                face
+) {
+    bool     hasTex   = options->indexStyle == OBJ_BENCH_INDEX_PT
+                     || options->indexStyle == OBJ_BENCH_INDEX_PTN;
+    bool     hasNorm  = options->indexStyle == OBJ_BENCH_INDEX_PN
+                     || options->indexStyle == OBJ_BENCH_INDEX_PTN;
+    uint32_t numVerts = options->numVerts;
+
+    bool appended = append_format(buffer, "f");
+    for (uint32_t i = 0u; appended && i < options->arity; ++i) {
+        // Faces walk the vertices in order, like the strips of a scanned mesh
+        uint32_t idx = (uint32_t)(((uint64_t)face + i) % numVerts);
+
+        appended = append_separator(buffer, options, rng)
+                && append_index(buffer, options, idx, numVerts);
+        if (appended && (hasTex || hasNorm)) {
+            appended = append_format(buffer, "/");
+        }
+        if (appended && hasTex) {
+            appended = append_index(buffer, options, idx, numVerts);
+        }
+        if (appended && hasNorm) {
+            appended = append_format(buffer, "/") && append_index(buffer, options, idx, numVerts);
+        }
+    }
+    return appended && append_line_end(buffer, options, rng);
+}
+
+/*
+ * Generates the synthetic file of @options in @buffer, which declares all the vertex attributes
+ * before the faces
+ */
+static bool generate_corpus(const Obj_BenchOptions *options, Obj_BenchBuffer *buffer) {
+    uint64_t rng     = options->seed ? options->seed : 1u;
+    bool     hasTex  = options->indexStyle == OBJ_BENCH_INDEX_PT
+                    || options->indexStyle == OBJ_BENCH_INDEX_PTN;
+    bool     hasNorm = options->indexStyle == OBJ_BENCH_INDEX_PN
+                    || options->indexStyle == OBJ_BENCH_INDEX_PTN;
+
+    bool generated = append_format(buffer, "# obj-bench synthetic corpus\n");
+    for (uint32_t i = 0u; generated && i < options->numVerts; ++i) {
+        generated = append_vector(buffer, options, &rng, "v", 3u, -100.f, 100.f);
+    }
+    for (uint32_t i = 0u; generated && hasTex && i < options->numVerts; ++i) {
+        generated = append_vector(buffer, options, &rng, "vt", 2u, 0.f, 1.f);
+    }
+    for (uint32_t i = 0u; generated && hasNorm && i < options->numVerts; ++i) {
+        generated = append_vector(buffer, options, &rng, "vn", 3u, -1.f, 1.f);
+    }
+
+    for (uint32_t i = 0u; generated && i < options->numFaces; ++i) {
+        generated = append_face(buffer, options, &rng, i);
+    }
+    return generated;
+}
+
+static bool write_corpus(const char *path, const Obj_BenchBuffer *buffer) {
+    FILE *fptr = fopen(path, "wb");
+    if (!fptr) {
+        return false;
+    }
+    bool written = fwrite(buffer->data, 1u, buffer->len, fptr) == buffer->len;
+    return fclose(fptr) == 0 && written;
+}
+
+static bool load_corpus(const char *path, Obj_BenchCorpus *corpus) {
+    *corpus = (Obj_BenchCorpus) {.path = path};
+
+    FILE *fptr = fopen(path, "rb");
+    if (!fptr) {
+        return false;
+    }
+    bool loaded = fseek(fptr, 0, SEEK_END) == 0;
+    long len    = loaded ? ftell(fptr) : -1;
+    loaded      = len >= 0 && fseek(fptr, 0, SEEK_SET) == 0;
+    if (loaded) {
+        corpus->len  = (size_t)len;
+        corpus->data = malloc(corpus->len ? corpus->len : 1u);
+        loaded       = corpus->data && fread(corpus->data, 1u, corpus->len, fptr) == corpus->len;
+    }
+    fclose(fptr);
+    if (!loaded) {
+        free(corpus->data);
+        corpus->data = NULL;
+        return false;
+    }
+
+    // Split the vertex and face lines at the first face
+    const char *end   = corpus->data + corpus->len;
+    corpus->facesBegin = corpus->len;
+    for (const char *line = corpus->data; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        lineEnd             = lineEnd ? lineEnd : end;
+        if (corpus->facesBegin == corpus->len && get_line_type(line, lineEnd) == OBJ_FACE) {
+            corpus->facesBegin = (size_t)(line - corpus->data);
+        }
+        ++corpus->numLines;
+        corpus->numVertexLines += corpus->facesBegin == corpus->len;
+        line = lineEnd + 1;
+    }
+    return true;
+}
+
+/*
+ * Times the phases of a two-pass read of @corpus, the same ones obj_read goes through once the
+ * file is in memory
+ */
+static bool time_phases(const Obj_BenchCorpus *corpus, Obj_BenchPhases *phases) {
+    const char *begin      = corpus->data;
+    const char *facesBegin = corpus->data + corpus->facesBegin;
+    const char *end        = corpus->data + corpus->len;
+
+    Obj_Parser parser;
+    init_parser(&parser, NULL);
+    parser.path = corpus->path;
+
+    double        start = get_seconds();
+    Obj_MeshSizes sizes = get_sizes_from_buffer(begin, end, parser.options.loadFlags, NULL);
+    double        count = get_seconds();
+
+    Obj_ParseState state;
+    void          *block = NULL;
+    bool           timed = init_parse_state(&state, &parser, sizes, &block);
+    double         alloc = get_seconds();
+
+    timed           = timed && parse_buffer(&state, begin, facesBegin);
+    double vertices = get_seconds();
+    timed           = timed && parse_buffer(&state, facesBegin, end);
+    double faces    = get_seconds();
+
+    free_mesh_data(&parser.options.allocator, &state.data, block);
+    release_parser(&parser);
+
+    phases->count    = min_double(phases->count, count - start);
+    phases->alloc    = min_double(phases->alloc, alloc - count);
+    phases->vertices = min_double(phases->vertices, vertices - alloc);
+    phases->faces    = min_double(phases->faces, faces - vertices);
+    return timed;
+}
+
+/*
+ * Times @read on @path, returning a negative time when it fails
+ */
+static double time_read(
+    Obj_Return (*read)(const char *, const Obj_ReadOptions *),
+    const char *path
+) {
+    double     start   = get_seconds();
+    Obj_Return ret     = read(path, NULL);
+    double     elapsed = get_seconds() - start;
+    obj_free(&ret.mesh);
+    return ret.successfulRead ? elapsed : -1.0;
+}
+
+/*
+ * Times the write of @mesh as a wavefront file on @numThreads threads, keeping the fastest time in
+ * @seconds and the size of the file in @size. Returns false when the write fails.
+ */
+static bool time_write(const Obj_Mesh *mesh, uint32_t numThreads, double *seconds, size_t *size) {
+    Obj_WriteOptions options = {.numThreads = numThreads};
+    double           start   = get_seconds();
+    bool             written = obj_write(mesh, BENCH_WRITE_PATH, &options);
+    *seconds                 = min_double(*seconds, get_seconds() - start);
+
+    FILE *fptr = written ? fopen(BENCH_WRITE_PATH, "rb") : NULL;
+    written    = fptr && fseek(fptr, 0, SEEK_END) == 0;
+    long len   = written ? ftell(fptr) : -1;
+    if (fptr) {
+        fclose(fptr);
+    }
+    *size = len >= 0 ? (size_t)len : 0u;
+    return len >= 0;
+}
+
+/*
+ * Returns the throughput of @phase in MB/s, or 0 for the phases which do not read the file
+ */
+static double phase_throughput(const Obj_BenchPhase *phase) {
+    if (phase->seconds <= 0.0 || phase->bytes == 0u) {
+        return 0.0;
+    }
+    return (double)phase->bytes / (1024.0 * 1024.0) / phase->seconds;
+}
+
+static void print_throughput(const Obj_BenchPhase *phase) {
+    double throughput = phase_throughput(phase);
+    if (throughput <= 0.0) {
+        printf("%-14s %10.3f %12s %12s\n", phase->name, phase->seconds * 1e3, "-", "-");
+        return;
+    }
+    printf(
+        "%-14s %10.3f %12.1f %12.2f\n",
+        phase->name,
+        phase->seconds * 1e3,
+        throughput,
+        (double)phase->lines / 1e6 / phase->seconds
+    );
+}
+
+/*
+ * Loads the baseline throughputs saved at @path into @gate, one tab separated file, phase and
+ * MB/s per line
+ */
+static bool load_baselines(const char *path, Obj_BenchGate *gate) {
+    FILE *fptr = fopen(path, "r");
+    if (!fptr) {
+        return false;
+    }
+
+    char     line[2u * BENCH_MAX_KEY_LEN + 64u];
+    uint32_t capacity = 0u;
+    bool     loaded   = true;
+    while (loaded && fgets(line, sizeof(line), fptr)) {
+        if (gate->numBaselines == capacity) {
+            capacity                     = capacity ? 2u * capacity : 16u;
+            Obj_BenchBaseline *baselines = realloc(gate->baselines, capacity * sizeof(*baselines));
+            loaded                       = baselines != NULL;
+            gate->baselines              = baselines ? baselines : gate->baselines;
+        }
+
+        Obj_BenchBaseline *baseline = gate->baselines + gate->numBaselines;
+        loaded = loaded
+              && sscanf(line, "%511[^\t]\t%511[^\t]\t%lf", baseline->file, baseline->phase,
+                        &baseline->throughput)
+                     == 3;
+        gate->numBaselines += loaded;
+    }
+    loaded = loaded && !ferror(fptr) && gate->numBaselines > 0u;
+    fclose(fptr);
+    return loaded;
+}
+
+/*
+ * Saves the throughput of @phase of the reads of @file when asked for, and checks it against its
+ * baseline when gated
+ */
+static void gate_phase(Obj_BenchGate *gate, const char *file, const Obj_BenchPhase *phase) {
+    double throughput = phase_throughput(phase);
+    if (throughput <= 0.0) {
+        return;
+    }
+    if (gate->saved) {
+        fprintf(gate->saved, "%s\t%s\t%.3f\n", file, phase->name, throughput);
+    }
+    if (gate->numBaselines == 0u) {
+        return;
+    }
+
+    for (uint32_t i = 0u; i < gate->numBaselines; ++i) {
+        const Obj_BenchBaseline *baseline = gate->baselines + i;
+        if (strcmp(baseline->file, file) != 0 || strcmp(baseline->phase, phase->name) != 0) {
+            continue;
+        }
+        double floor = baseline->throughput * (1.0 - gate->tolerance);
+        if (throughput < floor) {
+            fprintf(
+                stderr,
+                "Regression, %s %s at %.1f MB/s, below %.1f MB/s (baseline %.1f MB/s)\n",
+                file,
+                phase->name,
+                throughput,
+                floor,
+                baseline->throughput
+            );
+            gate->passed = false;
+        }
+        return;
+    }
+    fprintf(stderr, "Error, no baseline for %s %s\n", file, phase->name);
+    gate->passed = false;
+}
+
+static bool bench_corpus(const char *path, uint32_t numRuns, Obj_BenchGate *gate) {
+    Obj_BenchCorpus corpus;
+    if (!load_corpus(path, &corpus)) {
+        fprintf(stderr, "Error, could not load %s\n", path);
+        return false;
+    }
+
+    Obj_BenchPhases phases   = {DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX};
+    double          read     = DBL_MAX;
+    double          readMmap = DBL_MAX;
+    double          write    = DBL_MAX;
+    double          writeMt  = DBL_MAX;
+    size_t          written  = 0u;
+    Obj_Return      mesh     = obj_read_mmap(path, NULL);
+    bool            timed    = mesh.successfulRead;
+    for (uint32_t run = 0u; timed && run < numRuns; ++run) {
+        timed = time_phases(&corpus, &phases);
+
+        double elapsed = time_read(obj_read_ex, path);
+        read           = min_double(read, elapsed);
+        timed          = timed && elapsed >= 0.0;
+
+        elapsed  = time_read(obj_read_mmap, path);
+        readMmap = min_double(readMmap, elapsed);
+        timed    = timed && elapsed >= 0.0;
+
+        timed = timed && time_write(&mesh.mesh, 1u, &write, &written)
+             && time_write(&mesh.mesh, BENCH_WRITE_THREADS, &writeMt, &written);
+    }
+    Obj_MeshSizes sizes = mesh.mesh.sizes;
+    obj_free(&mesh.mesh);
+    remove(BENCH_WRITE_PATH);
+    if (!timed) {
+        fprintf(stderr, "Error, could not read %s\n", path);
+        free(corpus.data);
+        return false;
+    }
+
+    size_t   vertexBytes = corpus.facesBegin;
+    size_t   faceBytes   = corpus.len - corpus.facesBegin;
+    uint64_t faceLines   = corpus.numLines - corpus.numVertexLines;
+    uint64_t writeLines  = (uint64_t)sizes.nPos + sizes.nTex + sizes.nNorms + sizes.nFaces;
+
+    printf(
+        "\n%s: %.2f MB, %llu lines, best of %u runs\n",
+        path,
+        (double)corpus.len / (1024.0 * 1024.0),
+        (unsigned long long)corpus.numLines,
+        numRuns
+    );
+    const Obj_BenchPhase results[] = {
+        {"count", phases.count, corpus.len, corpus.numLines},
+        {"alloc", phases.alloc, 0u, 0u},
+        {"vertex parse", phases.vertices, vertexBytes, corpus.numVertexLines},
+        {"face parse", phases.faces, faceBytes, faceLines},
+        {"obj_read", read, corpus.len, corpus.numLines},
+        {"obj_read_mmap", readMmap, corpus.len, corpus.numLines},
+        {"obj_write", write, written, writeLines},
+        {"obj_write_mt", writeMt, written, writeLines},
+    };
+    printf("%-14s %10s %12s %12s\n", "phase", "time (ms)", "MB/s", "Mlines/s");
+    for (size_t i = 0u; i < sizeof(results) / sizeof(*results); ++i) {
+        print_throughput(results + i);
+        gate_phase(gate, path, results + i);
+    }
+
+    free(corpus.data);
+    return true;
+}
+
+static bool parse_uint(const char *arg, uint64_t max, uint64_t *value) {
+    char              *end;
+    unsigned long long parsed = strtoull(arg, &end, 10);
+    if (end == arg || *end != '\0' || parsed > max) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+static bool parse_index_style(const char *arg, Obj_BenchIndexStyle *style) {
+    static const char *STYLES[] = {"p", "p/t", "p//n", "p/t/n"};
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        if (strcmp(arg, STYLES[i]) == 0) {
+            *style = (Obj_BenchIndexStyle)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void print_usage(const char *program) {
+    fprintf(
+        stderr,
+        "Usage: %s [options] [file.obj...]\n"
+        "Benchmarks the given files, or a generated one when none is given.\n"
+        "  --verts N       vertices of the generated file (default 1000000)\n"
+        "  --faces N       faces of the generated file (default twice the vertices)\n"
+        "  --arity N       vertices per face (default 3)\n"
+        "  --index STYLE   face vertex form: p, p/t, p//n or p/t/n (default p/t/n)\n"
+        "  --negative      use relative (negative) face indices\n"
+        "  --noise         insert extra blanks, comments, blank lines and CRLF line endings\n"
+        "  --seed N        seed of the generated values (default 1)\n"
+        "  --runs N        timed runs, the fastest of which is reported (default 5)\n"
+        "  --out PATH      path of the generated file (default " BENCH_DEFAULT_PATH ")\n"
+        "  --keep          keep the generated file\n"
+        "  --save-baseline PATH\n"
+        "                  save the throughputs measured as a baseline\n"
+        "  --baseline PATH fail when a throughput falls below the one saved in the baseline\n"
+        "  --tolerance PCT slowdown allowed against the baseline (default 10)\n",
+        program
+    );
+}
+
+/*
+ * Parses the command line into @options, and sets @firstFile to the index of the first file to
+ * benchmark, or to @argc when there is none
+ */
+static bool parse_args(int argc, char **argv, Obj_BenchOptions *options, int *firstFile) {
+    bool     facesSet = false;
+    uint64_t value;
+    int      i = 1;
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; ++i) {
+        const char *arg    = argv[i];
+        const char *next   = i + 1 < argc ? argv[i + 1] : NULL;
+        bool        parsed = true;
+        if (strcmp(arg, "--negative") == 0) {
+            options->negativeIndices = true;
+            continue;
+        }
+        if (strcmp(arg, "--noise") == 0) {
+            options->noise = true;
+            continue;
+        }
+        if (strcmp(arg, "--keep") == 0) {
+            options->keep = true;
+            continue;
+        }
+        if (!next) {
+            return false;
+        }
+
+        ++i;
+        if (strcmp(arg, "--verts") == 0) {
+            parsed            = parse_uint(next, INT32_MAX, &value) && value > 0u;
+            options->numVerts = (uint32_t)value;
+        } else if (strcmp(arg, "--faces") == 0) {
+            parsed            = parse_uint(next, INT32_MAX, &value);
+            options->numFaces = (uint32_t)value;
+            facesSet          = true;
+        } else if (strcmp(arg, "--arity") == 0) {
+            parsed         = parse_uint(next, 64u, &value) && value >= 3u;
+            options->arity = (uint32_t)value;
+        } else if (strcmp(arg, "--index") == 0) {
+            parsed = parse_index_style(next, &options->indexStyle);
+        } else if (strcmp(arg, "--seed") == 0) {
+            parsed        = parse_uint(next, UINT64_MAX, &value);
+            options->seed = value;
+        } else if (strcmp(arg, "--runs") == 0) {
+            parsed           = parse_uint(next, UINT32_MAX, &value) && value > 0u;
+            options->numRuns = (uint32_t)value;
+        } else if (strcmp(arg, "--out") == 0) {
+            options->outPath = next;
+        } else if (strcmp(arg, "--baseline") == 0) {
+            options->baselinePath = next;
+        } else if (strcmp(arg, "--save-baseline") == 0) {
+            options->savePath = next;
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            parsed             = parse_uint(next, 100u, &value);
+            options->tolerance = (uint32_t)value;
+        } else {
+            parsed = false;
+        }
+        if (!parsed) {
+            return false;
+        }
+    }
+
+    if (!facesSet) {
+        uint64_t numFaces = 2u * (uint64_t)options->numVerts;
+        options->numFaces = numFaces > INT32_MAX ? INT32_MAX : (uint32_t)numFaces;
+    }
+    *firstFile = i;
+    return true;
+}
+
+static bool bench_files(char **paths, int numPaths, uint32_t numRuns, Obj_BenchGate *gate) {
+    bool benched = true;
+    for (int i = 0; i < numPaths; ++i) {
+        benched = bench_corpus(paths[i], numRuns, gate) && benched;
+    }
+    return benched;
+}
+
+static bool bench_generated(const Obj_BenchOptions *options, Obj_BenchGate *gate) {
+    Obj_BenchBuffer buffer = {};
+    double          start  = get_seconds();
+    if (!generate_corpus(options, &buffer) || !write_corpus(options->outPath, &buffer)) {
+        fprintf(stderr, "Error, could not generate %s\n", options->outPath);
+        free(buffer.data);
+        return false;
+    }
+    free(buffer.data);
+    printf("Generated %s in %.1f ms\n", options->outPath, (get_seconds() - start) * 1e3);
+
+    bool benched = bench_corpus(options->outPath, options->numRuns, gate);
+    if (!options->keep) {
+        remove(options->outPath);
+    }
+    return benched;
+}
+
+/**************************************************************************************************
+ * Main
+ *************************************************************************************************/
+
+int main(int argc, char **argv) {
+    Obj_BenchOptions options = {
+        .numVerts   = 1000000u,
+        .arity      = 3u,
+        .indexStyle = OBJ_BENCH_INDEX_PTN,
+        .seed       = 1u,
+        .numRuns    = 5u,
+        .outPath    = BENCH_DEFAULT_PATH,
+        .tolerance  = BENCH_DEFAULT_TOLERANCE,
+    };
+    int firstFile;
+    if (!parse_args(argc, argv, &options, &firstFile)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Obj_BenchGate gate = {.tolerance = options.tolerance / 100.0, .passed = true};
+    if (options.baselinePath && !load_baselines(options.baselinePath, &gate)) {
+        fprintf(stderr, "Error, could not load the baseline %s\n", options.baselinePath);
+        free(gate.baselines);
+        return EXIT_FAILURE;
+    }
+    if (options.savePath && !(gate.saved = fopen(options.savePath, "w"))) {
+        fprintf(stderr, "Error, could not create the baseline %s\n", options.savePath);
+        free(gate.baselines);
+        return EXIT_FAILURE;
+    }
+
+    bool benched = firstFile < argc
+                     ? bench_files(argv + firstFile, argc - firstFile, options.numRuns, &gate)
+                     : bench_generated(&options, &gate);
+
+    bool saved = !gate.saved || fclose(gate.saved) == 0;
+    if (!saved) {
+        fprintf(stderr, "Error, could not save the baseline %s\n", options.savePath);
+    }
+    if (benched && gate.numBaselines > 0u && gate.passed) {
+        printf(
+            "\nThroughput gate passed, within %u%% of %s\n",
+            options.tolerance,
+            options.baselinePath
+        );
+    }
+    free(gate.baselines);
+    return benched && saved && gate.passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1382 @@
+/**************************************************************************************************
+ * Obj Reader
+ *
+ * File: obj-fuzz.c
+ *
+ * Author: Jordan Emme
+ *
+ * Description: Fuzzing harness of the obj reader.
+ *
+ *    Reads each input from memory under several configurations, covering the two pass, single
+ * pass, chunked and incremental reads, the load flags and the error policies, and checks every
+ * read against a slow reference parser written to be obviously right rather than fast: elements,
+ * face ranges and errors must match exactly, floats bit for bit. Incremental reads are then
+ * reloaded from files holding random local edits of the input, and checked in the same way. Some
+ * meshes are also written as wavefront files and caches, which must read back to the same mesh.
+ * These files are written to the working directory. The chunk sizes are shrunk so that the small
+ * inputs fuzzers work with get split across threads too. Mismatches abort, so that fuzzers keep
+ * the input. Build with libFuzzer:
+ *
+ *    clang -g -O1 -fsanitize=fuzzer,address,undefined -DOBJ_FUZZ_LIBFUZZER -o obj-fuzz \
+ *        obj-fuzz.c -pthread -lm
+ *    ./obj-fuzz corpus/
+ *
+ * Or as a plain program, which checks the files given, the way AFL runs it, or random inputs:
+ *
+ *    cc -g -O1 -fsanitize=address,undefined -o obj-fuzz obj-fuzz.c -pthread -lm
+ *    afl-fuzz -i corpus -o findings -- ./obj-fuzz @@
+ *    ./obj-fuzz --random 100000
+ *
+ * Copyright (c) 2025 Jordan Emme
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions: The above copyright notice and this
+ * permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+/**************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+
+// Chunks this small split inputs of a few hundred bytes across threads
+#define MIN_CHUNK_SIZE             (64u)
+#define INCREMENTAL_CUT_LINES      (4u)
+#define MIN_INCREMENTAL_CHUNK_SIZE (32u)
+
+#include "obj-reader.c"
+
+/**************************************************************************************************
+ * Macros
+ *************************************************************************************************/
+
+// Errors recorded by the reads, and cap of the configuration failing at the cap
+#define FUZZ_MAX_ERRORS (256u)
+#define FUZZ_CAP_ERRORS (3u)
+
+// Largest number of lines of the random inputs
+#define FUZZ_MAX_RANDOM_LINES (96u)
+
+#define FUZZ_FAILURE_PATH "obj-fuzz-failure.obj"
+
+// Files the edited inputs are reloaded from, and the meshes read are written to
+#define FUZZ_RELOAD_PATH "obj-fuzz-reload.obj"
+#define FUZZ_WRITE_PATH  "obj-fuzz-write.obj"
+#define FUZZ_CACHE_PATH  "obj-fuzz-write.cache"
+
+// Edits each input goes through, reloading it after each one, in incremental configurations
+#define FUZZ_NUM_RELOADS (2u)
+
+#define RANDOM_PICK(rng, array) ((array)[random_below((rng), sizeof(array) / sizeof(*(array)))])
+
+/**************************************************************************************************
+ * Types
+ *************************************************************************************************/
+
+/*
+ * Obj_FuzzConfig:
+ *
+ * Configuration every input is read with
+ * @name: name reported when the read differs from the reference
+ * @options: options of the read
+ * @writes: whether the mesh read is also written as a wavefront file and as a cache, which must
+ *  read back to the same mesh
+ */
+typedef struct Obj_FuzzConfig {
+    const char     *name;
+    Obj_ReadOptions options;
+    bool            writes;
+} Obj_FuzzConfig;
+
+/*
+ * Obj_RefRange:
+ *
+ * Face range of the reference parser, also standing for the last statement of its kind
+ * @name, @nameLen: name of o, g and usemtl statements, pointing into the input
+ * @group: smoothing group of s statements
+ */
+typedef struct Obj_RefRange {
+    uint32_t    firstFace;
+    uint32_t    numFaces;
+    uint32_t    firstCorner;
+    uint32_t    numCorners;
+    const char *name;
+    size_t      nameLen;
+    uint32_t    group;
+} Obj_RefRange;
+
+/*
+ * Obj_RefMesh:
+ *
+ * Mesh read by the reference parser, its arrays being sized for the worst case of the input
+ * @positions: x, y, z and w of each position
+ * @texcoords: u and v of each texture coordinate
+ * @normals: x, y and z of each normal
+ * @ranges, @numRanges: face ranges of each Obj_RangeKind
+ * @errors, @numErrors: errors in file order, up to the one failing the read
+ * @successfulRead: whether the read went through the whole input
+ */
+typedef struct Obj_RefMesh {
+    Obj_MeshSizes sizes;
+    float        *positions;
+    float        *texcoords;
+    float        *normals;
+    Obj_VertIdx  *faces;
+    uint32_t     *faceSizes;
+    Obj_RefRange *ranges[OBJ_NUM_RANGE_KINDS];
+    uint32_t      numRanges[OBJ_NUM_RANGE_KINDS];
+    Obj_Error    *errors;
+    uint32_t      numErrors;
+    bool          successfulRead;
+} Obj_RefMesh;
+
+/*
+ * Obj_RefRead:
+ *
+ * State of a read of the reference parser
+ * @statements, @stated: last statement of each Obj_RangeKind, and whether there was one
+ * @lineNum, @lineOffset: number and byte offset of the line being read
+ */
+typedef struct Obj_RefRead {
+    const Obj_ReadOptions *options;
+    Obj_RefMesh           *mesh;
+    Obj_RefRange           statements[OBJ_NUM_RANGE_KINDS];
+    bool                   stated[OBJ_NUM_RANGE_KINDS];
+    uint32_t               lineNum;
+    uint64_t               lineOffset;
+} Obj_RefRead;
+
+/*
+ * Obj_FuzzCheck:
+ *
+ * Step of the checks of an input, reported when it differs from what it is checked against
+ * @data, @len: input checked, which the reloaded edits and the files written derive from
+ * @step: what is checked of the input, its read, its reloads or what reading the mesh written gives
+ */
+typedef struct Obj_FuzzCheck {
+    const char           *data;
+    size_t                len;
+    const Obj_FuzzConfig *config;
+    const char           *step;
+} Obj_FuzzCheck;
+
+typedef struct Obj_FuzzBuffer {
+    char  *data;
+    size_t len;
+    size_t capacity;
+} Obj_FuzzBuffer;
+
+/**************************************************************************************************
+ * Constants
+ *************************************************************************************************/
+
+static const Obj_FuzzConfig CONFIGS[] = {
+    {"two pass", {.maxErrors = FUZZ_MAX_ERRORS}, true},
+    {"single pass", {.singlePass = true, .shrinkToFit = true, .maxErrors = FUZZ_MAX_ERRORS}, false},
+    {"single block", {.singleBlock = true, .maxErrors = FUZZ_MAX_ERRORS}, false},
+    {"chunked", {.numThreads = 4u, .maxErrors = FUZZ_MAX_ERRORS}, false},
+    {
+        "chunked single block",
+        {.numThreads = 3u, .singleBlock = true, .maxErrors = FUZZ_MAX_ERRORS},
+        false,
+    },
+    {"incremental", {.numThreads = 2u, .incremental = true, .maxErrors = FUZZ_MAX_ERRORS}, false},
+    {
+        "skipped streams",
+        {
+            .numThreads = 2u,
+            .loadFlags  = OBJ_LOAD_SKIP_TEXCOORDS | OBJ_LOAD_SKIP_NORMALS | OBJ_LOAD_SKIP_POSW,
+            .maxErrors  = FUZZ_MAX_ERRORS,
+        },
+        true,
+    },
+    {
+        "skipped faces",
+        {.singlePass = true, .loadFlags = OBJ_LOAD_SKIP_FACES, .maxErrors = FUZZ_MAX_ERRORS},
+        false,
+    },
+    {
+        "fail fast",
+        {.numThreads = 4u, .maxErrors = FUZZ_MAX_ERRORS, .errorPolicy = OBJ_ERRORS_FAIL_FAST},
+        false,
+    },
+    {"fail at cap", {.maxErrors = FUZZ_CAP_ERRORS, .errorPolicy = OBJ_ERRORS_FAIL_AT_CAP}, false},
+};
+
+#define FUZZ_NUM_CONFIGS (sizeof(CONFIGS) / sizeof(*CONFIGS))
+
+// Bytes the random edits of the inputs write
+static const char EDIT_BYTES[] = {' ', '\t', '\r', '\n', '/', '-', '.', 'e', '0', '\0', 'f'};
+
+/**************************************************************************************************
+ * Globals
+ *************************************************************************************************/
+
+// Parsers of each configuration, kept across inputs
+static Obj_Parser *parsers[FUZZ_NUM_CONFIGS];
+
+// File the input is written to before aborting on a mismatch, when it is not kept by a fuzzer
+static const char *failurePath = NULL;
+
+/**************************************************************************************************
+ * Reference parser
+ *************************************************************************************************/
+
+/*
+ * The reference parser reads the input one token at a time, following the grammar the library
+ * implements: lines are split on '\n', tokens on ' ', '\t' and '\r', keywords must be followed by a
+ * blank, numbers are whatever strtof accepts whole, and face vertices take the p, p/t, p//n and
+ * p/t/n forms. It shares no code with the library.
+ */
+
+static bool ref_is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*
+ * Returns the first token of [cursor, end) and points @tokenEnd right after it. The token is empty
+ * once the line is exhausted.
+ */
+static const char *ref_token(const char *cursor, const char *end, const char **tokenEnd) {
+    while (cursor < end && ref_is_blank(*cursor)) {
+        ++cursor;
+    }
+    const char *c = cursor;
+    while (c < end && !ref_is_blank(*c)) {
+        ++c;
+    }
+    *tokenEnd = c;
+    return cursor;
+}
+
+static bool ref_float(const char *token, const char *tokenEnd, float *value) {
+    size_t len  = (size_t)(tokenEnd - token);
+    char  *copy = malloc(len + 1u);
+    if (!copy) {
+        abort();
+    }
+    memcpy(copy, token, len);
+    copy[len] = '\0';
+
+    // Hexadecimal floats go through strtod, as some glibc versions round the subnormal ones wrong
+    // in strtof, and the short ones the fuzzer makes fit a double
+    char *numEnd;
+    *value      = strpbrk(copy, "xX") ? (float)strtod(copy, &numEnd) : strtof(copy, &numEnd);
+    bool parsed = len > 0u && numEnd == copy + len;
+    free(copy);
+
+    // The library gives all NaNs the default payload, which strtof may take from the token
+    if (isnan(*value)) {
+        *value = signbit(*value) ? -NAN : NAN;
+    }
+    return parsed;
+}
+
+/*
+ * Parses up to @maxCount floats out of [cursor, end), stopping at the first token which is not one
+ */
+static uint32_t ref_floats(const char *cursor, const char *end, float *values, uint32_t maxCount) {
+    uint32_t    numValues = 0u;
+    const char *tokenEnd;
+    for (; numValues < maxCount; cursor = tokenEnd) {
+        const char *token = ref_token(cursor, end, &tokenEnd);
+        if (token == tokenEnd || !ref_float(token, tokenEnd, values + numValues)) {
+            break;
+        }
+        ++numValues;
+    }
+    return numValues;
+}
+
+/*
+ * Parses the [begin, end) index of a face vertex, resolving relative indices against the
+ * @numElements read so far. Indices of @skipped streams only need to be well formed, and are
+ * left at -1.
+ */
+static bool ref_index(
+    const char *begin,
+    const char *end,
+    uint32_t    numElements,
+    bool        skipped,
+    int32_t    *index
+) {
+    *index = -1;
+
+    bool negative = begin < end && *begin == '-';
+    if (begin < end && (*begin == '-' || *begin == '+')) {
+        ++begin;
+    }
+    if (begin == end) {
+        return false;
+    }
+
+    // Saturated past INT32_MAX, which no index may exceed
+    int64_t value = 0;
+    for (const char *c = begin; c < end; ++c) {
+        if (*c < '0' || *c > '9') {
+            return false;
+        }
+        value = value > INT32_MAX ? value : value * 10 + (*c - '0');
+    }
+    if (skipped) {
+        return true;
+    }
+
+    if (value == 0 || value > INT32_MAX) {
+        return false;
+    }
+    if (negative) {
+        value = (int64_t)numElements + 1 - value;
+    }
+    if (value < 1) {
+        return false;
+    }
+    *index = (int32_t)value;
+    return true;
+}
+
+static bool ref_face_vertex(
+    const char   *token,
+    const char   *tokenEnd,
+    Obj_MeshSizes numRead,
+    uint32_t      loadFlags,
+    Obj_VertIdx  *vertIdx
+) {
+    const char *slashes[2];
+    uint32_t    numSlashes = 0u;
+    for (const char *c = token; c < tokenEnd; ++c) {
+        if (*c == '/') {
+            if (numSlashes == 2u) {
+                return false;
+            }
+            slashes[numSlashes++] = c;
+        }
+    }
+
+    *vertIdx            = (Obj_VertIdx) {-1, -1, -1};
+    const char *posEnd  = numSlashes > 0u ? slashes[0] : tokenEnd;
+    bool        skipTex = loadFlags & OBJ_LOAD_SKIP_TEXCOORDS;
+    bool        skipNrm = loadFlags & OBJ_LOAD_SKIP_NORMALS;
+    if (!ref_index(token, posEnd, numRead.nPos, false, &vertIdx->posIdx)) {
+        return false;
+    }
+    if (numSlashes == 0u) {
+        return true;
+    }
+
+    // Only the p//n form leaves the texture coordinate index out
+    const char *texBegin = slashes[0] + 1;
+    const char *texEnd   = numSlashes == 2u ? slashes[1] : tokenEnd;
+    if ((numSlashes == 1u || texEnd > texBegin)
+        && !ref_index(texBegin, texEnd, numRead.nTex, skipTex, &vertIdx->texIdx)) {
+        return false;
+    }
+    return numSlashes == 1u
+        || ref_index(slashes[1] + 1, tokenEnd, numRead.nNorms, skipNrm, &vertIdx->normIdx);
+}
+
+/*
+ * Records an error of @code about the line being read, and returns whether the read goes on past
+ * it: never for @fatal errors, otherwise as the error policy decides
+ */
+static bool ref_line_error(Obj_RefRead *read, Obj_ErrorCode code, bool fatal) {
+    Obj_RefMesh *mesh = read->mesh;
+    mesh->errors[mesh->numErrors++] = (Obj_Error) {code, read->lineNum, read->lineOffset};
+    if (fatal) {
+        return false;
+    }
+
+    uint32_t maxErrors = read->options->maxErrors ? read->options->maxErrors : DEFAULT_MAX_ERRORS;
+    switch (read->options->errorPolicy) {
+        case OBJ_ERRORS_FAIL_FAST:
+            return false;
+        case OBJ_ERRORS_FAIL_AT_CAP:
+            return mesh->numErrors < maxErrors;
+        case OBJ_ERRORS_SKIP:
+        default:
+            return true;
+    }
+}
+
+static bool ref_same_range_name(const Obj_RefRange *a, const Obj_RefRange *b) {
+    return a->group == b->group && a->nameLen == b->nameLen
+        && (a->nameLen == 0u || memcmp(a->name, b->name, a->nameLen) == 0);
+}
+
+/*
+ * Adds the face about to be read, of @numVertices vertices, to the range of the last @kind
+ * statement, which extends the previous range when it repeats its name
+ */
+static void ref_add_range_face(Obj_RefRead *read, uint32_t kind, uint32_t numVertices) {
+    Obj_RefMesh  *mesh      = read->mesh;
+    uint32_t     *numRanges = mesh->numRanges + kind;
+    Obj_RefRange *last      = *numRanges > 0u ? mesh->ranges[kind] + *numRanges - 1u : NULL;
+    if (last && last->firstFace + last->numFaces == mesh->sizes.nFaces
+        && ref_same_range_name(last, read->statements + kind)) {
+        ++last->numFaces;
+        last->numCorners += numVertices;
+        return;
+    }
+
+    Obj_RefRange *range = mesh->ranges[kind] + (*numRanges)++;
+    *range              = read->statements[kind];
+    range->firstFace    = mesh->sizes.nFaces;
+    range->numFaces     = 1u;
+    range->firstCorner  = mesh->sizes.flatFacesSize;
+    range->numCorners   = numVertices;
+}
+
+static bool ref_face(Obj_RefRead *read, const char *cursor, const char *end) {
+    Obj_RefMesh   *mesh        = read->mesh;
+    Obj_MeshSizes *sizes       = &mesh->sizes;
+    Obj_VertIdx   *faceVerts   = mesh->faces + sizes->flatFacesSize;
+    uint32_t       loadFlags   = read->options->loadFlags;
+    uint32_t       numVertices = 0u;
+    bool           valid       = true;
+
+    const char *tokenEnd;
+    for (const char *token = ref_token(cursor, end, &tokenEnd); valid && token < tokenEnd;
+         token             = ref_token(tokenEnd, end, &tokenEnd)) {
+        valid = ref_face_vertex(token, tokenEnd, *sizes, loadFlags, faceVerts + numVertices++);
+    }
+
+    // Malformed faces are kept without vertices, and faces with too few of them as they are
+    if (!valid) {
+        numVertices = 0u;
+        if (!ref_line_error(read, OBJ_ERROR_INVALID_FACE, false)) {
+            return false;
+        }
+    } else if (numVertices < 3u && !ref_line_error(read, OBJ_ERROR_DEGENERATE_FACE, false)) {
+        return false;
+    }
+
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        if (read->stated[kind]) {
+            ref_add_range_face(read, kind, numVertices);
+        }
+    }
+    mesh->faceSizes[sizes->nFaces++] = numVertices;
+    sizes->flatFacesSize += numVertices;
+    return true;
+}
+
+static bool ref_smoothing_group(const char *begin, const char *end, uint32_t *group) {
+    if (end - begin == 3 && memcmp(begin, "off", 3u) == 0) {
+        *group = 0u;
+        return true;
+    }
+
+    uint64_t value = 0u;
+    for (const char *c = begin; c < end; ++c) {
+        if (*c < '0' || *c > '9') {
+            return false;
+        }
+        value = value > UINT32_MAX ? value : value * 10u + (uint64_t)(*c - '0');
+    }
+    *group = (uint32_t)value;
+    return begin < end && value <= UINT32_MAX;
+}
+
+/*
+ * Reads the o, g, usemtl or s statement of @kind, whose name or group is the [cursor, end) line
+ * remainder stripped of its blanks. Names stop at their first null character, if any.
+ */
+static bool ref_statement(Obj_RefRead *read, uint32_t kind, const char *cursor, const char *end) {
+    while (cursor < end && ref_is_blank(*cursor)) {
+        ++cursor;
+    }
+    while (end > cursor && ref_is_blank(end[-1])) {
+        --end;
+    }
+
+    Obj_RefRange statement = {.name = cursor, .nameLen = (size_t)(end - cursor)};
+    if (kind == OBJ_RANGE_SMOOTHING) {
+        statement.name    = NULL;
+        statement.nameLen = 0u;
+        if (!ref_smoothing_group(cursor, end, &statement.group)) {
+            return ref_line_error(read, OBJ_ERROR_INVALID_SMOOTHING_GROUP, false);
+        }
+    } else {
+        const char *null = memchr(cursor, '\0', statement.nameLen);
+        statement.nameLen = null ? (size_t)(null - cursor) : statement.nameLen;
+    }
+    read->statements[kind] = statement;
+    read->stated[kind]     = true;
+    return true;
+}
+
+static bool ref_line(Obj_RefRead *read, const char *line, const char *end) {
+    static const char *const KEYWORDS[] = {
+        "v", "vt", "vn", "vp", "f", "l", "mtllib", "usemtl", "o", "g", "s",
+    };
+    static const uint32_t NUM_KEYWORDS = sizeof(KEYWORDS) / sizeof(*KEYWORDS);
+
+    Obj_RefMesh *mesh      = read->mesh;
+    uint32_t     loadFlags = read->options->loadFlags;
+    if (line == end || line[0] == '#') {
+        return true;
+    }
+
+    const char *keywordEnd;
+    const char *keyword = ref_token(line, end, &keywordEnd);
+    if (keyword != line) {
+        // Lines starting with a blank only hold blanks, or are unknown
+        return keyword == end || ref_line_error(read, OBJ_ERROR_UNKNOWN_LINE, false);
+    }
+
+    uint32_t kw = 0u;
+    while (kw < NUM_KEYWORDS
+           && (strlen(KEYWORDS[kw]) != (size_t)(keywordEnd - keyword)
+               || memcmp(KEYWORDS[kw], keyword, (size_t)(keywordEnd - keyword)) != 0)) {
+        ++kw;
+    }
+    if (kw == NUM_KEYWORDS || keywordEnd == end) {
+        return ref_line_error(read, OBJ_ERROR_UNKNOWN_LINE, false);
+    }
+
+    // Values start past the blank following the keyword
+    const char *cursor = keywordEnd + 1;
+    const char *name   = KEYWORDS[kw];
+    float       values[4];
+    uint32_t    numValues;
+    if (strcmp(name, "v") == 0) {
+        numValues = ref_floats(cursor, end, values, loadFlags & OBJ_LOAD_SKIP_POSW ? 3u : 4u);
+        if (numValues < 3u) {
+            return ref_line_error(read, OBJ_ERROR_INVALID_POSITION, true);
+        }
+        float *position = mesh->positions + 4u * mesh->sizes.nPos++;
+        memcpy(position, values, 3u * sizeof(*values));
+        position[3] = numValues == 4u ? values[3] : 1.0f;
+    } else if (strcmp(name, "vt") == 0 && !(loadFlags & OBJ_LOAD_SKIP_TEXCOORDS)) {
+        numValues = ref_floats(cursor, end, values, 2u);
+        if (numValues < 1u) {
+            return ref_line_error(read, OBJ_ERROR_INVALID_TEXCOORD, true);
+        }
+        float *texcoord = mesh->texcoords + 2u * mesh->sizes.nTex++;
+        texcoord[0]     = values[0];
+        texcoord[1]     = numValues == 2u ? values[1] : 0.0f;
+    } else if (strcmp(name, "vn") == 0 && !(loadFlags & OBJ_LOAD_SKIP_NORMALS)) {
+        if (ref_floats(cursor, end, values, 3u) < 3u) {
+            return ref_line_error(read, OBJ_ERROR_INVALID_NORMAL, true);
+        }
+        memcpy(mesh->normals + 3u * mesh->sizes.nNorms++, values, 3u * sizeof(*values));
+    } else if (loadFlags & OBJ_LOAD_SKIP_FACES) {
+        return true;
+    } else if (strcmp(name, "f") == 0) {
+        return ref_face(read, cursor, end);
+    } else if (strcmp(name, "o") == 0) {
+        return ref_statement(read, OBJ_RANGE_OBJECT, keywordEnd, end);
+    } else if (strcmp(name, "g") == 0) {
+        return ref_statement(read, OBJ_RANGE_GROUP, keywordEnd, end);
+    } else if (strcmp(name, "usemtl") == 0) {
+        return ref_statement(read, OBJ_RANGE_MATERIAL, keywordEnd, end);
+    } else if (strcmp(name, "s") == 0) {
+        return ref_statement(read, OBJ_RANGE_SMOOTHING, keywordEnd, end);
+    }
+    return true;
+}
+
+static void free_ref_mesh(Obj_RefMesh *mesh) {
+    free(mesh->positions);
+    free(mesh->texcoords);
+    free(mesh->normals);
+    free(mesh->faces);
+    free(mesh->faceSizes);
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        free(mesh->ranges[kind]);
+    }
+    free(mesh->errors);
+    *mesh = (Obj_RefMesh) {};
+}
+
+/*
+ * Allocates the arrays of @mesh for the worst case of the @len bytes at @data: an element, face,
+ * range and error per line, and a face vertex per two bytes
+ */
+static bool alloc_ref_mesh(Obj_RefMesh *mesh, const char *data, size_t len) {
+    size_t numLines = 1u;
+    for (const char *c = data; (c = memchr(c, '\n', len - (size_t)(c - data))); ++c) {
+        ++numLines;
+    }
+
+    *mesh = (Obj_RefMesh) {
+        .positions = malloc(4u * numLines * sizeof(*mesh->positions)),
+        .texcoords = malloc(2u * numLines * sizeof(*mesh->texcoords)),
+        .normals   = malloc(3u * numLines * sizeof(*mesh->normals)),
+        .faces     = malloc((len / 2u + 1u) * sizeof(*mesh->faces)),
+        .faceSizes = malloc(numLines * sizeof(*mesh->faceSizes)),
+        .errors    = malloc(numLines * sizeof(*mesh->errors)),
+    };
+    bool allocated = mesh->positions && mesh->texcoords && mesh->normals && mesh->faces
+                  && mesh->faceSizes && mesh->errors;
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        mesh->ranges[kind] = malloc(numLines * sizeof(**mesh->ranges));
+        allocated          = allocated && mesh->ranges[kind];
+    }
+    if (!allocated) {
+        free_ref_mesh(mesh);
+    }
+    return allocated;
+}
+
+/*
+ * Reads the @len bytes at @data into @mesh, allocated by alloc_ref_mesh, with @options
+ */
+static void ref_read(
+    const char            *data,
+    size_t                 len,
+    const Obj_ReadOptions *options,
+    Obj_RefMesh           *mesh
+) {
+    mesh->sizes     = (Obj_MeshSizes) {0u, 0u, 0u, 0u, 0u};
+    mesh->numErrors = 0u;
+    memset(mesh->numRanges, 0, sizeof(mesh->numRanges));
+
+    Obj_RefRead read    = {.options = options, .mesh = mesh};
+    const char *end     = data + len;
+    bool        reading = true;
+    for (const char *line = data; reading && line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        lineEnd             = lineEnd ? lineEnd : end;
+        ++read.lineNum;
+        read.lineOffset = (uint64_t)(line - data);
+        reading         = ref_line(&read, line, lineEnd);
+        line            = lineEnd + 1;
+    }
+    mesh->successfulRead = reading;
+}
+
+/**************************************************************************************************
+ * Random lines
+ *************************************************************************************************/
+
+/*
+ * xorshift64* generator, so that random inputs only depend on their seed
+ */
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t random_below(uint64_t *rng, uint32_t count) {
+    return (uint32_t)(next_random(rng) % count);
+}
+
+static bool append_bytes(Obj_FuzzBuffer *buffer, const char *bytes, size_t len) {
+    if (len == 0u) {
+        return true;
+    }
+    if (buffer->len + len > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 1u << 12;
+        while (capacity < buffer->len + len) {
+            capacity *= 2u;
+        }
+        char *data = realloc(buffer->data, capacity);
+        if (!data) {
+            return false;
+        }
+        buffer->data     = data;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->len, bytes, len);
+    buffer->len += len;
+    return true;
+}
+
+static bool append_string(Obj_FuzzBuffer *buffer, const char *string) {
+    return append_bytes(buffer, string, strlen(string));
+}
+
+/*
+ * Appends a float, either one of the forms the fast path of the library leaves to the slow one, or
+ * a random one printed with a random precision, near halfway cases included
+ */
+static bool append_random_float(Obj_FuzzBuffer *buffer, uint64_t *rng) {
+    static const char *const FLOATS[] = {
+        "0", "-0", "1", "-1.5", "+2", ".5", "5.", "3.25e2", "1E-3", "6.02214076e23", "1e39",
+        "-1e-46", "1.17549435e-38", "16777217", "0.30000001192092896", "9007199254740993",
+        "12345678901234567890123", "1e100000000", "inf", "-nan", "0x1p3", "1e", "--1", "1,5", ".",
+        "-Infinity", "nan(12ab_)", "nan(", "0x1.fffffeP127", "0X.8p-148", "0x1.000001p0", "0x",
+        "0x1p", "7.0064923216240861e-46", "3.4028235677973366e38", "1.401298464324817e-45", "+.e1",
+    };
+    static const int PRECISIONS[] = {3, 6, 9, 17, 25, 40};
+
+    char     token[128];
+    uint32_t roll = random_below(rng, 4u);
+    if (roll == 0u) {
+        return append_string(buffer, RANDOM_PICK(rng, FLOATS));
+    }
+
+    uint32_t bits  = (uint32_t)next_random(rng);
+    float    value = 0.0f;
+    bits           = (bits & 0x807fffffu) | ((100u + random_below(rng, 55u)) << 23);
+    memcpy(&value, &bits, sizeof(value));
+
+    // Halfway between value and the next float, which only a correct rounding gets right
+    double halfway   = (double)(nextafterf(value, INFINITY) - value) / 2.0;
+    double printed   = roll == 1u ? (double)value + halfway : (double)value;
+    int    precision = RANDOM_PICK(rng, PRECISIONS);
+    snprintf(token, sizeof(token), roll == 3u ? "%.*e" : "%.*g", precision, printed);
+    return append_string(buffer, token);
+}
+
+static bool append_random_index(Obj_FuzzBuffer *buffer, uint64_t *rng, uint32_t numElements) {
+    static const char *const INDICES[] = {"0", "-0", "+1", "2147483647", "2147483648", "-x", ""};
+
+    char     token[32];
+    uint32_t roll = random_below(rng, 8u);
+    if (roll == 0u) {
+        return append_string(buffer, RANDOM_PICK(rng, INDICES));
+    }
+    uint32_t idx = random_below(rng, numElements + 2u) + 1u;
+    snprintf(token, sizeof(token), roll < 3u ? "-%u" : "%u", idx);
+    return append_string(buffer, token);
+}
+
+static bool append_random_blank(Obj_FuzzBuffer *buffer, uint64_t *rng) {
+    static const char *const BLANKS[] = {" ", " ", " ", "  ", "\t", " \t", "\r "};
+    return append_string(buffer, RANDOM_PICK(rng, BLANKS));
+}
+
+static bool append_random_face(Obj_FuzzBuffer *buffer, uint64_t *rng, uint32_t numElements) {
+    static const char *const FORMS[] = {"p", "p/t", "p//n", "p/t/n", "p/", "p//", "p/t/"};
+
+    uint32_t form        = random_below(rng, 16u);
+    form                 = form < 4u ? form : (form < 14u ? 3u : form - 10u);
+    uint32_t numVertices = random_below(rng, 7u);
+    bool     appended    = append_string(buffer, "f");
+    for (uint32_t i = 0u; appended && i < numVertices; ++i) {
+        appended = append_random_blank(buffer, rng);
+        for (const char *c = FORMS[form]; appended && *c; ++c) {
+            appended = *c == '/' ? append_string(buffer, "/")
+                                 : append_random_index(buffer, rng, numElements);
+        }
+    }
+    return appended;
+}
+
+static bool append_random_line(Obj_FuzzBuffer *buffer, uint64_t *rng, uint32_t line) {
+    static const char *const NAMES[] = {"a", "b", "", " a b ", "\ta\t", "mat.001"};
+    static const char *const GROUPS[] = {"off", "0", "1", "2", "x", "4294967295", "4294967296", ""};
+    static const char *const OTHERS[] = {
+        "# comment", "", "   ", "\r", "vx 1 2 3", "v", "vt", "f", "mtllibx", "l 1 2", "vp 1",
+        "junk", "#", "  v 1 2 3", "s", "o",
+    };
+
+    bool     appended;
+    uint32_t roll = random_below(rng, 20u);
+    if (roll < 6u) {
+        appended = append_string(buffer, "v");
+        for (uint32_t i = 0u, n = 2u + random_below(rng, 4u); appended && i < n; ++i) {
+            appended = append_random_blank(buffer, rng) && append_random_float(buffer, rng);
+        }
+    } else if (roll < 8u) {
+        appended = append_string(buffer, "vt");
+        for (uint32_t i = 0u, n = random_below(rng, 4u); appended && i < n; ++i) {
+            appended = append_random_blank(buffer, rng) && append_random_float(buffer, rng);
+        }
+    } else if (roll < 10u) {
+        appended = append_string(buffer, "vn");
+        for (uint32_t i = 0u, n = 2u + random_below(rng, 3u); appended && i < n; ++i) {
+            appended = append_random_blank(buffer, rng) && append_random_float(buffer, rng);
+        }
+    } else if (roll < 15u) {
+        appended = append_random_face(buffer, rng, line);
+    } else if (roll < 17u) {
+        static const char *const STATEMENTS[] = {"o", "g", "usemtl"};
+        appended = append_string(buffer, STATEMENTS[random_below(rng, 3u)])
+                && append_random_blank(buffer, rng)
+                && append_string(buffer, RANDOM_PICK(rng, NAMES));
+    } else if (roll < 18u) {
+        appended = append_string(buffer, "s ")
+                && append_string(buffer, RANDOM_PICK(rng, GROUPS));
+    } else {
+        appended = append_string(buffer, RANDOM_PICK(rng, OTHERS));
+    }
+    return appended && append_string(buffer, random_below(rng, 8u) == 0u ? "\r\n" : "\n");
+}
+
+/*
+ * Copies the @len bytes at @data to @edited with a random local edit: a random line or a comment
+ * inserted before one of the lines, a random line replacing it, the line removed, or one of its
+ * bytes changed
+ */
+static bool edit_random_input(Obj_FuzzBuffer *edited, const char *data, size_t len, uint64_t *rng) {
+    size_t pos       = (size_t)(next_random(rng) % (len + 1u));
+    size_t lineBegin = pos;
+    while (lineBegin > 0u && data[lineBegin - 1u] != '\n') {
+        --lineBegin;
+    }
+    const char *newline = pos < len ? memchr(data + pos, '\n', len - pos) : NULL;
+    size_t      lineEnd = newline ? (size_t)(newline - data) + 1u : len;
+
+    edited->len   = 0u;
+    uint32_t roll = random_below(rng, 5u);
+    if (roll == 3u && pos < len) {
+        bool appended = append_bytes(edited, data, len);
+        if (appended) {
+            edited->data[pos] = RANDOM_PICK(rng, EDIT_BYTES);
+        }
+        return appended;
+    }
+
+    size_t restBegin = roll == 1u || roll == 2u ? lineEnd : lineBegin;
+    bool   appended  = append_bytes(edited, data, lineBegin);
+    if (roll == 4u) {
+        // Comments only move the lines after them, whose chunks are then reused with their errors
+        appended = appended && append_string(edited, "# edit\n");
+    } else if (roll != 2u) {
+        appended = appended && append_random_line(edited, rng, (uint32_t)(lineBegin / 2u));
+    }
+    return appended && append_bytes(edited, data + restBegin, len - restBegin);
+}
+
+/**************************************************************************************************
+ * Checks
+ *************************************************************************************************/
+
+/*
+ * Reports the step of @check differing from what it is checked against at element @idx of @what,
+ * and aborts
+ */
+static void fail_check(const Obj_FuzzCheck *check, const char *what, uint64_t idx) {
+    fprintf(
+        stderr,
+        "obj-fuzz: %s %s differs: %s %llu\n",
+        check->config->name,
+        check->step,
+        what,
+        (unsigned long long)idx
+    );
+    FILE *fptr = failurePath ? fopen(failurePath, "wb") : NULL;
+    if (fptr) {
+        fwrite(check->data, 1u, check->len, fptr);
+        fclose(fptr);
+        fprintf(stderr, "obj-fuzz: input written to %s\n", failurePath);
+    }
+    abort();
+}
+
+static bool same_float(float a, float b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static void check_floats(
+    const Obj_FuzzCheck *check,
+    const char          *what,
+    const float         *array,
+    uint32_t             idx,
+    float                expected
+) {
+    if (!array || !same_float(array[idx], expected)) {
+        fail_check(check, what, idx);
+    }
+}
+
+static void check_elements(
+    const Obj_FuzzCheck *check,
+    const Obj_RefMesh   *ref,
+    const Obj_Mesh      *mesh
+) {
+    const Obj_MeshData *data = &mesh->data;
+    const uint32_t      flags = check->config->options.loadFlags;
+
+    if (mesh->sizes.nPos != ref->sizes.nPos || mesh->sizes.nTex != ref->sizes.nTex
+        || mesh->sizes.nNorms != ref->sizes.nNorms || mesh->sizes.nFaces != ref->sizes.nFaces
+        || mesh->sizes.flatFacesSize != ref->sizes.flatFacesSize) {
+        fail_check(check, "sizes", 0u);
+    }
+
+    for (uint32_t i = 0u; i < ref->sizes.nPos; ++i) {
+        const float *position = ref->positions + 4u * i;
+        check_floats(check, "position x", data->posX, i, position[0]);
+        check_floats(check, "position y", data->posY, i, position[1]);
+        check_floats(check, "position z", data->posZ, i, position[2]);
+        if (!(flags & OBJ_LOAD_SKIP_POSW)) {
+            check_floats(check, "position w", data->posW, i, position[3]);
+        }
+    }
+    if ((flags & OBJ_LOAD_SKIP_POSW) && data->posW) {
+        fail_check(check, "position w", 0u);
+    }
+    for (uint32_t i = 0u; i < ref->sizes.nTex; ++i) {
+        check_floats(check, "texcoord u", data->texU, i, ref->texcoords[2u * i]);
+        check_floats(check, "texcoord v", data->texV, i, ref->texcoords[2u * i + 1u]);
+    }
+    for (uint32_t i = 0u; i < ref->sizes.nNorms; ++i) {
+        check_floats(check, "normal x", data->normX, i, ref->normals[3u * i]);
+        check_floats(check, "normal y", data->normY, i, ref->normals[3u * i + 1u]);
+        check_floats(check, "normal z", data->normZ, i, ref->normals[3u * i + 2u]);
+    }
+
+    for (uint32_t i = 0u; i < ref->sizes.nFaces; ++i) {
+        if (data->faceSizes[i] != ref->faceSizes[i]) {
+            fail_check(check, "face size", i);
+        }
+    }
+    for (uint32_t i = 0u; i < ref->sizes.flatFacesSize; ++i) {
+        Obj_VertIdx got = data->faces[i];
+        Obj_VertIdx exp = ref->faces[i];
+        if (got.posIdx != exp.posIdx || got.texIdx != exp.texIdx || got.normIdx != exp.normIdx) {
+            fail_check(check, "face vertex", i);
+        }
+    }
+}
+
+static void check_ranges(const Obj_FuzzCheck *check, const Obj_RefMesh *ref, const Obj_Mesh *mesh) {
+    const Obj_FaceRanges *ranges = &mesh->faceRanges;
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        if (ranges->numRanges[kind] != ref->numRanges[kind]) {
+            fail_check(check, "number of ranges of kind", kind);
+        }
+        for (uint32_t i = 0u; i < ref->numRanges[kind]; ++i) {
+            const Obj_FaceRange *got = ranges->ranges[kind] + i;
+            const Obj_RefRange  *exp = ref->ranges[kind] + i;
+            if (got->firstFace != exp->firstFace || got->numFaces != exp->numFaces
+                || got->firstCorner != exp->firstCorner || got->numCorners != exp->numCorners) {
+                fail_check(check, "range", i);
+            }
+
+            bool sameName = got->name == exp->group;
+            if (kind != OBJ_RANGE_SMOOTHING) {
+                const char *name = got->name < ranges->numNames
+                                     ? ranges->names + ranges->nameOffsets[got->name]
+                                     : NULL;
+                sameName = name && strlen(name) == exp->nameLen
+                        && memcmp(name, exp->name, exp->nameLen) == 0;
+            }
+            if (!sameName) {
+                fail_check(check, "range name", i);
+            }
+        }
+    }
+}
+
+/*
+ * Checks the errors of the read of @parser against the reference, along with the @first one the
+ * read returned, unless it returns none. Chunked reads drop the errors past the chunk failing,
+ * but count the errors of all chunks towards the cap of OBJ_ERRORS_FAIL_AT_CAP, so their errors
+ * then only start like the reference ones. Past their cap, they record the errors of the threads
+ * claiming the slots first, which are left unchecked.
+ */
+static void check_errors(
+    const Obj_FuzzCheck *check,
+    const Obj_RefMesh   *ref,
+    const Obj_Parser    *parser,
+    const Obj_Error     *first
+) {
+    const Obj_ReadOptions *options = &check->config->options;
+    bool                   serial  = options->numThreads <= 1u && !options->incremental;
+
+    uint32_t         numRecorded;
+    const Obj_Error *errors    = obj_parser_errors(parser, &numRecorded);
+    uint32_t         numErrors = obj_parser_num_errors(parser);
+    bool             allErrors = serial || ref->successfulRead
+                     || options->errorPolicy != OBJ_ERRORS_FAIL_AT_CAP;
+    if (allErrors ? numErrors != ref->numErrors : numErrors < ref->numErrors) {
+        fail_check(check, "number of errors", numErrors);
+    }
+    if (numRecorded != (numErrors < options->maxErrors ? numErrors : options->maxErrors)) {
+        fail_check(check, "number of errors recorded", numRecorded);
+    }
+
+    if (serial || numErrors <= options->maxErrors) {
+        uint32_t numChecked = numRecorded < ref->numErrors ? numRecorded : ref->numErrors;
+        for (uint32_t i = 0u; i < numChecked; ++i) {
+            const Obj_Error *got = errors + i;
+            const Obj_Error *exp = ref->errors + i;
+            if (got->code != exp->code || got->line != exp->line || got->offset != exp->offset) {
+                fail_check(check, "error", i);
+            }
+        }
+    }
+
+    Obj_Error recorded = numRecorded > 0u ? errors[0] : (Obj_Error) {OBJ_ERROR_NONE, 0u, 0u};
+    if (first
+        && (first->code != recorded.code || first->line != recorded.line
+            || first->offset != recorded.offset)) {
+        fail_check(check, "first error", 0u);
+    }
+}
+
+static bool same_written_float(float a, float b, bool anyNan) {
+    return same_float(a, b) || (anyNan && isnan(a) && isnan(b));
+}
+
+static void check_written_floats(
+    const Obj_FuzzCheck *check,
+    const char          *what,
+    const float         *got,
+    const float         *expected,
+    uint32_t             count,
+    bool                 anyNan
+) {
+    if ((got == NULL) != (expected == NULL)) {
+        fail_check(check, what, 0u);
+    }
+    for (uint32_t i = 0u; got && i < count; ++i) {
+        if (!same_written_float(got[i], expected[i], anyNan)) {
+            fail_check(check, what, i);
+        }
+    }
+}
+
+/*
+ * Checks that @got, read back from the file @mesh was written to, holds the same elements and face
+ * ranges. Wavefront files do not keep the sign and payload of NaNs, so @anyNan matches them all.
+ */
+static void check_same_mesh(
+    const Obj_FuzzCheck *check,
+    const Obj_Mesh      *mesh,
+    const Obj_Mesh      *got,
+    bool                 anyNan
+) {
+    const Obj_MeshData *data = &got->data;
+    const Obj_MeshData *exp  = &mesh->data;
+    if (memcmp(&got->sizes, &mesh->sizes, sizeof(mesh->sizes)) != 0) {
+        fail_check(check, "sizes", 0u);
+    }
+
+    uint32_t nPos = mesh->sizes.nPos;
+    check_written_floats(check, "position x", data->posX, exp->posX, nPos, anyNan);
+    check_written_floats(check, "position y", data->posY, exp->posY, nPos, anyNan);
+    check_written_floats(check, "position z", data->posZ, exp->posZ, nPos, anyNan);
+    check_written_floats(check, "position w", data->posW, exp->posW, nPos, anyNan);
+    check_written_floats(check, "texcoord u", data->texU, exp->texU, mesh->sizes.nTex, anyNan);
+    check_written_floats(check, "texcoord v", data->texV, exp->texV, mesh->sizes.nTex, anyNan);
+    check_written_floats(check, "normal x", data->normX, exp->normX, mesh->sizes.nNorms, anyNan);
+    check_written_floats(check, "normal y", data->normY, exp->normY, mesh->sizes.nNorms, anyNan);
+    check_written_floats(check, "normal z", data->normZ, exp->normZ, mesh->sizes.nNorms, anyNan);
+
+    for (uint32_t i = 0u; i < mesh->sizes.nFaces; ++i) {
+        if (data->faceSizes[i] != exp->faceSizes[i]) {
+            fail_check(check, "face size", i);
+        }
+    }
+    for (uint32_t i = 0u; i < mesh->sizes.flatFacesSize; ++i) {
+        Obj_VertIdx a = data->faces[i];
+        Obj_VertIdx b = exp->faces[i];
+        if (a.posIdx != b.posIdx || a.texIdx != b.texIdx || a.normIdx != b.normIdx) {
+            fail_check(check, "face vertex", i);
+        }
+    }
+
+    const Obj_FaceRanges *gotRanges = &got->faceRanges;
+    const Obj_FaceRanges *expRanges = &mesh->faceRanges;
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        if (gotRanges->numRanges[kind] != expRanges->numRanges[kind]) {
+            fail_check(check, "number of ranges of kind", kind);
+        }
+        for (uint32_t i = 0u; i < expRanges->numRanges[kind]; ++i) {
+            Obj_FaceRange a = gotRanges->ranges[kind][i];
+            Obj_FaceRange b = expRanges->ranges[kind][i];
+            if (a.firstFace != b.firstFace || a.numFaces != b.numFaces
+                || a.firstCorner != b.firstCorner || a.numCorners != b.numCorners) {
+                fail_check(check, "range", i);
+            }
+            bool sameName = kind == OBJ_RANGE_SMOOTHING
+                              ? a.name == b.name
+                              : strcmp(
+                                    gotRanges->names + gotRanges->nameOffsets[a.name],
+                                    expRanges->names + expRanges->nameOffsets[b.name]
+                                ) == 0;
+            if (!sameName) {
+                fail_check(check, "range name", i);
+            }
+        }
+    }
+}
+
+/*
+ * Writes @mesh, which @parser read with the configuration of @check, as a wavefront file and as a
+ * cache, and checks that reading them back gives the same mesh. The faces of the wavefront file
+ * only report again being degenerate, as do the faces the lines skipped left without vertices.
+ * Files which cannot be written are skipped, as are the wavefront files of inputs holding NUL
+ * bytes, whose names may end with blanks the NUL bytes kept from being trimmed.
+ */
+static void check_writes(const Obj_FuzzCheck *check, Obj_Parser *parser, const Obj_Mesh *mesh) {
+    Obj_FuzzCheck    written = {check->data, check->len, check->config, "write"};
+    Obj_WriteOptions options = {.format = OBJ_WRITE_WAVEFRONT, .numThreads = 2u};
+    bool             textual = !memchr(check->data, '\0', check->len);
+    if (textual && obj_write(mesh, FUZZ_WRITE_PATH, &options)) {
+        Obj_Return ret = obj_parser_read(parser, FUZZ_WRITE_PATH);
+        if (!ret.successfulRead) {
+            fail_check(&written, "successful read", ret.successfulRead);
+        }
+        uint32_t         numErrors;
+        const Obj_Error *errors = obj_parser_errors(parser, &numErrors);
+        for (uint32_t i = 0u; i < numErrors; ++i) {
+            if (errors[i].code != OBJ_ERROR_DEGENERATE_FACE) {
+                fail_check(&written, "error", i);
+            }
+        }
+        check_same_mesh(&written, mesh, &ret.mesh, true);
+        obj_free(&ret.mesh);
+        remove(FUZZ_WRITE_PATH);
+    }
+
+    Obj_FuzzCheck cached = {check->data, check->len, check->config, "cache"};
+    options.format       = OBJ_WRITE_CACHE;
+    if (obj_write(mesh, FUZZ_CACHE_PATH, &options)) {
+        Obj_Return ret = obj_read_cache(FUZZ_CACHE_PATH);
+        if (!ret.successfulRead) {
+            fail_check(&cached, "first error", ret.error.code);
+        }
+        check_same_mesh(&cached, mesh, &ret.mesh, false);
+        obj_free(&ret.mesh);
+        remove(FUZZ_CACHE_PATH);
+    }
+}
+
+static bool write_input_file(const char *path, const char *data, size_t len) {
+    FILE *fptr    = fopen(path, "wb");
+    bool  written = fptr && fwrite(data, 1u, len, fptr) == len;
+    return fptr && fclose(fptr) == 0 && written;
+}
+
+/*
+ * Edits the input of @check FUZZ_NUM_RELOADS times in turn, and reloads @mesh, which @parser read
+ * out of it, from a file holding each edited input. Each reload is checked against the reference
+ * read of the edited bytes, which a full read would also give. The edits are drawn from a hash of
+ * the input, so that the input alone reproduces a failure.
+ */
+static void check_reloads(const Obj_FuzzCheck *check, Obj_Parser *parser, Obj_Mesh *mesh) {
+    Obj_FuzzCheck  reload    = {check->data, check->len, check->config, "reload"};
+    Obj_FuzzBuffer inputs[2] = {};
+    uint64_t       rng       = hash_bytes(check->data, check->data + check->len) | 1u;
+    bool           edited    = append_bytes(inputs, check->data, check->len);
+    for (uint32_t i = 0u; edited && i < FUZZ_NUM_RELOADS; ++i) {
+        const Obj_FuzzBuffer *input  = inputs + i % 2u;
+        Obj_FuzzBuffer       *output = inputs + (i + 1u) % 2u;
+        edited           = edit_random_input(output, input->data, input->len, &rng);
+        const char *data = output->len > 0u ? output->data : "";
+
+        Obj_RefMesh ref;
+        edited = edited && write_input_file(FUZZ_RELOAD_PATH, data, output->len)
+              && alloc_ref_mesh(&ref, data, output->len);
+        if (edited) {
+            ref_read(data, output->len, &check->config->options, &ref);
+            bool reloaded = obj_parser_reload(parser, FUZZ_RELOAD_PATH, mesh);
+            if (reloaded != ref.successfulRead) {
+                fail_check(&reload, "successful read", reloaded);
+            }
+            check_errors(&reload, &ref, parser, NULL);
+            if (reloaded) {
+                check_elements(&reload, &ref, mesh);
+                check_ranges(&reload, &ref, mesh);
+            }
+            free_ref_mesh(&ref);
+        }
+    }
+    remove(FUZZ_RELOAD_PATH);
+    free(inputs[0].data);
+    free(inputs[1].data);
+}
+
+static Obj_Parser *get_parser(uint32_t config) {
+    if (!parsers[config]) {
+        parsers[config] = obj_parser_create(&CONFIGS[config].options);
+    }
+    return parsers[config];
+}
+
+/*
+ * Reads the @len bytes at @data with every configuration, and checks them against the reference
+ */
+static void check_input(const char *data, size_t len) {
+    Obj_RefMesh ref;
+    if (!alloc_ref_mesh(&ref, data, len)) {
+        return;
+    }
+
+    for (uint32_t i = 0u; i < FUZZ_NUM_CONFIGS; ++i) {
+        Obj_Parser *parser = get_parser(i);
+        if (!parser) {
+            continue;
+        }
+        Obj_FuzzCheck check = {data, len, CONFIGS + i, "read"};
+        ref_read(data, len, &CONFIGS[i].options, &ref);
+
+        Obj_Return ret = obj_parser_read_from_memory(parser, data, len);
+        if (ret.successfulRead != ref.successfulRead) {
+            fail_check(&check, "successful read", ret.successfulRead);
+        }
+        check_errors(&check, &ref, parser, &ret.error);
+        if (ret.successfulRead) {
+            check_elements(&check, &ref, &ret.mesh);
+            check_ranges(&check, &ref, &ret.mesh);
+        }
+        if (ret.successfulRead && CONFIGS[i].writes) {
+            check_writes(&check, parser, &ret.mesh);
+        }
+        if (CONFIGS[i].options.incremental) {
+            check_reloads(&check, parser, &ret.mesh);
+        }
+        obj_free(&ret.mesh);
+    }
+    free_ref_mesh(&ref);
+}
+
+/**************************************************************************************************
+ * Fuzzer entry point
+ *************************************************************************************************/
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    check_input((const char *)data, size);
+    return 0;
+}
+
+// Plain programs check files or random inputs instead
+#if !defined(OBJ_FUZZ_LIBFUZZER)
+
+/**************************************************************************************************
+ * Random inputs
+ *************************************************************************************************/
+
+/*
+ * Generates a random input in @buffer, out of random lines followed by a few random byte edits
+ */
+static bool generate_random_input(Obj_FuzzBuffer *buffer, uint64_t *rng) {
+    buffer->len        = 0u;
+    uint32_t numLines  = random_below(rng, FUZZ_MAX_RANDOM_LINES + 1u);
+    bool     generated = true;
+    for (uint32_t i = 0u; generated && i < numLines; ++i) {
+        generated = append_random_line(buffer, rng, i);
+    }
+    if (!generated) {
+        return false;
+    }
+
+    // The last line is often left without its newline
+    if (buffer->len > 0u && random_below(rng, 4u) == 0u) {
+        --buffer->len;
+    }
+    for (uint32_t i = 0u, n = random_below(rng, 4u); buffer->len > 0u && i < n; ++i) {
+        size_t pos = next_random(rng) % buffer->len;
+        switch (random_below(rng, 3u)) {
+            case 0:
+                buffer->data[pos] = RANDOM_PICK(rng, EDIT_BYTES);
+                break;
+            case 1:
+                memmove(buffer->data + pos, buffer->data + pos + 1u, buffer->len - pos - 1u);
+                --buffer->len;
+                break;
+            default:
+                if (!append_bytes(buffer, " ", 1u)) {
+                    return false;
+                }
+                memmove(buffer->data + pos + 1u, buffer->data + pos, buffer->len - pos - 1u);
+                buffer->data[pos] = RANDOM_PICK(rng, EDIT_BYTES);
+                break;
+        }
+    }
+    return true;
+}
+
+/*
+ * Checks @count random inputs generated from @seed, copied to exactly sized buffers so that the
+ * sanitizers catch reads past their end
+ */
+static bool check_random_inputs(uint64_t count, uint64_t seed) {
+    Obj_FuzzBuffer buffer = {};
+    uint64_t       rng    = seed ? seed : 1u;
+    bool           ok     = true;
+    failurePath           = FUZZ_FAILURE_PATH;
+    for (uint64_t i = 0u; ok && i < count; ++i) {
+        ok         = generate_random_input(&buffer, &rng);
+        char *data = ok ? malloc(buffer.len ? buffer.len : 1u) : NULL;
+        ok         = data != NULL;
+        if (ok) {
+            memcpy(data, buffer.data, buffer.len);
+            check_input(data, buffer.len);
+        }
+        free(data);
+    }
+    free(buffer.data);
+    return ok;
+}
+
+static bool check_file(const char *path) {
+    FILE *fptr = fopen(path, "rb");
+    if (!fptr) {
+        return false;
+    }
+    bool  loaded = fseek(fptr, 0, SEEK_END) == 0;
+    long  len    = loaded ? ftell(fptr) : -1;
+    char *data   = NULL;
+    loaded       = len >= 0 && fseek(fptr, 0, SEEK_SET) == 0;
+    if (loaded) {
+        data   = malloc(len ? (size_t)len : 1u);
+        loaded = data && fread(data, 1u, (size_t)len, fptr) == (size_t)len;
+    }
+    fclose(fptr);
+    if (loaded) {
+        check_input(data, (size_t)len);
+    }
+    free(data);
+    return loaded;
+}
+
+static void release_parsers(void) {
+    for (uint32_t i = 0u; i < FUZZ_NUM_CONFIGS; ++i) {
+        obj_parser_destroy(parsers[i]);
+        parsers[i] = NULL;
+    }
+}
+
+/**************************************************************************************************
+ * Main
+ *************************************************************************************************/
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(
+            stderr,
+            "Usage: %s file.obj...\n"
+            "       %s --random COUNT [SEED]\n"
+            "Checks the reads of the given files, or of random inputs, against a reference\n"
+            "parser.\n",
+            argv[0],
+            argv[0]
+        );
+        return EXIT_FAILURE;
+    }
+
+    bool checked = true;
+    if (strcmp(argv[1], "--random") == 0) {
+        char              *end;
+        unsigned long long count = argc > 2 ? strtoull(argv[2], &end, 10) : 0u;
+        unsigned long long seed  = argc > 3 ? strtoull(argv[3], NULL, 10) : 1u;
+        if (argc < 3 || argc > 4 || *end != '\0') {
+            fprintf(stderr, "Error, invalid random input count\n");
+            return EXIT_FAILURE;
+        }
+        checked = check_random_inputs(count, seed);
+        if (checked) {
+            printf("Checked %llu random inputs from seed %llu\n", count, seed);
+        }
+    } else {
+        for (int i = 1; i < argc; ++i) {
+            if (!check_file(argv[i])) {
+                fprintf(stderr, "Error, could not load %s\n", argv[i]);
+                checked = false;
+            }
+        }
+    }
+    release_parsers();
+    return checked ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif
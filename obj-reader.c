@@ -11,9 +11,10 @@
  * a binary representation of it, and which should be easier to work with/get started. Any
  * re-ordering of the data, such as storing vertices in their own structs/classes using things like
  * float3s or vec3s is left for the user to do. 
- *    Currently, only vertex positions, normals, texture coordinates and faces are supported, and
- * only if the .obj doesn't use relative indices. The author is planning to support groups, objects
- * material declaration and usage, and lines.
+ *    Currently, only vertex positions, normals, texture coordinates and faces are supported, along
+ * with the objects, groups, materials and smoothing groups the faces belong to, and the material
+ * libraries. Relative (negative) face indices are resolved to absolute ones. The author is planning
+ * to support lines.
  *
  * Copyright (c) 2025 Jordan Emme
  *
@@ -36,10 +37,40 @@
  * Includes
  *************************************************************************************************/
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <float.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Vector extensions used by the counting and bounds passes, which fall back on plain C without them
+#if defined(__AVX2__)
+    #define SIMD_AVX2
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIMD_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #define SIMD_NEON
+    #include <arm_neon.h>
+#endif
 
 #include "obj-reader.h"
 
@@ -47,7 +78,128 @@
  * Macros
  *************************************************************************************************/
 
-#define MAX_LINE_LEN (65535)
+#define SINGLE_PASS_INITIAL_CAPACITY (4096u)
+
+// Float parsing
+#define MAX_MANTISSA_DIGITS  (19u)
+#define MAX_DECIMAL_EXPONENT (100000)
+#define MAX_EXACT_POW10      (22)
+#define MAX_EXACT_DOUBLE_INT (UINT64_C(1) << 53)
+#define DOUBLE_MANTISSA_BITS (52)
+#define DOUBLE_EXPONENT_BIAS (1023u)
+#define FLOAT_MANTISSA_BITS  (23)
+#define FLOAT_MIN_EXPONENT   (-126)
+#define FLOAT_MAX_EXPONENT   (127)
+#define FLOAT_EXPONENT_BIAS  (127)
+#define FLOAT_INFINITY_BITS  (0x7f800000u)
+#define FLOAT_NAN_BITS       (0x7fc00000u)
+
+// Exact float parsing: digits kept, largest power of 2 applied at once, and decimal points above
+// and below which all numbers overflow or round to 0
+#define MAX_DECIMAL_DIGITS (800u)
+#define MAX_DECIMAL_SHIFT  (60u)
+#define MAX_DECIMAL_POINT  (39)
+#define MIN_DECIMAL_POINT  (-46)
+#define DECIMAL_SHIFT_STEP (27u)
+
+// Float formatting, with the precision of the tables of powers of 5 and their inverses
+#define FLOAT_POW5_INV_BITCOUNT (59)
+#define FLOAT_POW5_BITCOUNT     (61)
+#define MAX_FLOAT_TEXT_LEN      (16u)
+#define MAX_INDEX_TEXT_LEN      (10u)
+
+// Longest vertex line, and longest text of a face vertex with its leading blank
+#define MAX_VERTEX_LINE_LEN (3u + 4u * (MAX_FLOAT_TEXT_LEN + 1u))
+#define MAX_CORNER_TEXT_LEN (3u + 3u * MAX_INDEX_TEXT_LEN)
+
+// Elements formatted by each thread writing a wavefront file, before their text is written out
+#define WRITE_CHUNK_ELEMENTS    (1u << 16)
+#define WRITE_TEXT_INITIAL_SIZE (1u << 16)
+
+// Alignment of the custom allocations of single arrays, and of the arrays carved from a block
+#define ARRAY_ALIGNMENT (16u)
+#define BLOCK_ALIGNMENT (64u)
+
+// Buffers smaller than this are not worth splitting across threads. The chunk sizes may be defined
+// before including this file, so that harnesses split small inputs too.
+#if !defined(MIN_CHUNK_SIZE)
+    #define MIN_CHUNK_SIZE (1u << 20)
+#endif
+
+// Incremental reads start a chunk at one line in INCREMENTAL_CUT_LINES on average, picked by their
+// content, as long as the previous chunk holds at least MIN_INCREMENTAL_CHUNK_SIZE bytes
+#if !defined(INCREMENTAL_CUT_LINES)
+    #define INCREMENTAL_CUT_LINES (1u << 12)
+#endif
+#if !defined(MIN_INCREMENTAL_CHUNK_SIZE)
+    #define MIN_INCREMENTAL_CHUNK_SIZE (1u << 14)
+#endif
+
+// Lines between which the chunks of a read look for an earlier chunk which failed, to stop early
+#define FAILED_CHUNK_CHECK_LINES (256u)
+
+#define DEFAULT_STREAM_BUFFER_SIZE (1u << 20)
+
+// Number of errors recorded for each read when the options set no cap
+#define DEFAULT_MAX_ERRORS (16u)
+
+// Binary cache files
+#define CACHE_MAGIC      ("OBJCACHE")
+#define CACHE_VERSION    (4u)
+#define CACHE_BYTE_ORDER (0x01020304u)
+#define CACHE_SUFFIX     (".cache")
+
+// Load flag bit keying the caches of reads generating normals, which hold the normals generated
+#define CACHE_GENERATED_NORMALS (1u << 31)
+
+// Largest value of 16-bit unsigned normalized components
+#define UNORM16_MAX (65535.0f)
+
+// Minimum number of face vertices per thread building a GPU mesh
+#define MIN_GPU_RANGE_SIZE (1u << 16)
+
+// Minimum number of triangles per thread reordering a GPU mesh
+#define MIN_GPU_GROUP_SIZE (1u << 14)
+
+// Number of vertices of the vertex cache GPU meshes are ordered for by default
+#define DEFAULT_GPU_CACHE_SIZE (16u)
+
+// Largest number of separate vertex arrays of a GPU mesh
+#define MAX_GPU_VERTEX_ARRAYS (8u)
+
+// Default and largest numbers of vertices and triangles of a meshlet, indexing vertices on a byte
+#define DEFAULT_MESHLET_VERTICES (64u)
+#define DEFAULT_MESHLET_TRIANGLES (124u)
+#define MAX_MESHLET_VERTICES (256u)
+#define MAX_MESHLET_TRIANGLES (512u)
+
+// Minimum number of meshlets per thread computing meshlet bounds
+#define MIN_MESHLET_RANGE_SIZE (1u << 10)
+
+// Smallest cosine between the normals and the axis of a meshlet for its normal cone to cull it
+#define MIN_MESHLET_CONE_DOT (0.1f)
+
+// Minimum number of positions or face vertices per thread of a geometry pass
+#define MIN_GEOMETRY_RANGE_SIZE (1u << 16)
+
+// Blocks of a file read ahead of the parser, which large reads hide the latency of
+#define READ_AHEAD_NUM_BUFFERS (3u)
+#define READ_AHEAD_BUFFER_SIZE (4u << 20)
+
+// Number of characters classified at once by the counting pass
+#if defined(SIMD_AVX2)
+    #define SIMD_WIDTH (32)
+#elif defined(SIMD_SSE2) || defined(SIMD_NEON)
+    #define SIMD_WIDTH (16)
+#endif
+
+#if defined(_WIN32)
+    #define MUTEX_INITIALIZER SRWLOCK_INIT
+    #define COND_INITIALIZER  CONDITION_VARIABLE_INIT
+#else
+    #define MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+    #define COND_INITIALIZER  PTHREAD_COND_INITIALIZER
+#endif
 
 #define FREE(A) \
     { \
@@ -57,451 +209,9373 @@
     }
 
 /**************************************************************************************************
- * Enums
+ * Structs
  *************************************************************************************************/
 
-typedef enum Obj_LineType {
-    OBJ_COMMENT  = 0,
-    OBJ_VECPOS   = 1,
-    OBJ_VECTEXT  = 2,
-    OBJ_VECNORM  = 3,
-    OBJ_VECPARAM = 4,
-    OBJ_FACE     = 5,
-    OBJ_LINE     = 6,
-    OBJ_MTLSPEC  = 7,
-    OBJ_MTLUSE   = 8,
-    OBJ_OBJECT   = 9,
-    OBJ_GROUP    = 10,
-    OBJ_SSHADING = 11,
-
-    OBJ_NUM_LINE_TYPES,
-    OBJ_INVALID_LINE,
-} Obj_LineType;
-
-typedef enum Obj_FaceType {
-    OBJ_POS_ONLY         = 0,
-    OBJ_POS_AND_TEX      = 1,
-    OBJ_POS_AND_NORM     = 2,
-    OBJ_POS_TEX_AND_NORM = 3,
-
-    OBJ_NUM_FACE_TYPES,
-    OBJ_INVALID_FACE,
-} Obj_FaceType;
+/*
+ * Obj_RangeMark:
+ *
+ * Statement starting a face range, as found while parsing
+ * @kind: Obj_RangeKind of the statement
+ * @firstFace: number of faces read before the statement
+ * @firstCorner: number of face vertices read before the statement
+ * @value: offset of the name of the statement in the names of its Obj_RangeMarks, or the smoothing
+ *  group number of smoothing statements
+ */
+typedef struct Obj_RangeMark {
+    uint32_t kind;
+    uint32_t firstFace;
+    uint32_t firstCorner;
+    uint32_t value;
+} Obj_RangeMark;
 
-/**************************************************************************************************
- * Structs
- *************************************************************************************************/
+/*
+ * Obj_RangeMarks:
+ *
+ * Range statements of a read in the order of their lines, which only become the face ranges of the
+ * mesh once all its faces are read
+ * @marks: statements found
+ * @numMarks: number of statements found
+ * @marksCapacity: number of statements @marks can hold
+ * @names: names of the statements, null terminated and back to back
+ * @namesSize: number of bytes used in @names
+ * @namesCapacity: size of @names
+ */
+typedef struct Obj_RangeMarks {
+    Obj_RangeMark *marks;
+    uint32_t       numMarks;
+    uint32_t       marksCapacity;
+    char          *names;
+    uint32_t       namesSize;
+    uint32_t       namesCapacity;
+} Obj_RangeMarks;
+
+typedef struct Obj_MtlEntry Obj_MtlEntry;
+
+/*
+ * Obj_MtlLibList:
+ *
+ * Material libraries a read refers to, each of which it holds a reference on
+ * @entries: cache entries of the libraries, in the order of their mtllib statements
+ * @count: number of libraries
+ * @capacity: number of libraries @entries can hold
+ */
+typedef struct Obj_MtlLibList {
+    Obj_MtlEntry **entries;
+    uint32_t       count;
+    uint32_t       capacity;
+} Obj_MtlLibList;
+
+/*
+ * Obj_ChunkRecord:
+ *
+ * What an incremental read keeps of a chunk, so that the next reload can reuse its elements when
+ * its content did not change
+ * @hash, @length: content hash and number of bytes of the chunk
+ * @numLines: number of lines in the chunk
+ * @counted: number of elements counted in the chunk
+ * @read: number of elements actually read from the chunk
+ * @base: elements counted before the chunk, which its relative face indices were resolved against
+ * @offset: elements read before the chunk, hence where they are in the mesh arrays
+ * @posBounds: bounds of the vertex positions of the chunk, found when quantizing them
+ * @marks: range statements of the chunk, whose faces are numbered from the first one of the chunk
+ * @numErrors: number of errors reported about lines of the chunk
+ * @errors: those errors, whose lines and offsets count from the start of the chunk, NULL when the
+ *  read had no room to record them all
+ * @relativeIndices: whether faces of the chunk hold relative indices
+ * @materialLibs: whether the chunk holds mtllib statements whose libraries were loaded
+ */
+typedef struct Obj_ChunkRecord {
+    uint64_t       hash;
+    size_t         length;
+    uint32_t       numLines;
+    Obj_MeshSizes  counted;
+    Obj_MeshSizes  read;
+    Obj_MeshSizes  base;
+    Obj_MeshSizes  offset;
+    Obj_Bounds     posBounds;
+    Obj_RangeMarks marks;
+    uint32_t       numErrors;
+    Obj_Error     *errors;
+    bool           relativeIndices;
+    bool           materialLibs;
+} Obj_ChunkRecord;
+
+/*
+ * Obj_Parser:
+ *
+ * Context of a reader, which owns everything a read needs so that parsers running on different
+ * threads never share state
+ * @options: options applied to every read
+ * @path: path of the file being read, used when reporting errors
+ * @readBuffers: READ_AHEAD_NUM_BUFFERS buffers of READ_AHEAD_BUFFER_SIZE bytes the file blocks are
+ *  read in, allocated on first use
+ * @lineBuff: holds the lines which straddle two blocks, grown on demand
+ * @lineBuffSize: size of @lineBuff
+ * @numErrors: number of errors reported by the last read
+ * @errors: errors recorded by the last read, allocated on first use
+ * @errorsCapacity: number of errors @errors holds, which caps the number recorded
+ * @posBounds: bounds of the vertex positions found by the counting pass of quantized reads
+ * @posScale: factors mapping positions relative to @posBounds to 16-bit unsigned normalized values
+ * @stats: counters and timings of the current read, copied out when the options ask for them
+ * @meshBytes: bytes held by the mesh arrays of the current read
+ * @bufferBytes: bytes held by the read buffers
+ * @marks: range statements of the current read, whose arrays are kept from one read to the next
+ * @libs: material libraries of the current read
+ * @reservedNormals: whether the mesh block of the current read was sized for generated normals
+ * @records, @numRecords: chunks of the last incremental read, which obj_parser_reload compares the
+ *  file against
+ * @generatedNormals: whether the last incremental read generated the normals of its mesh
+ */
+struct Obj_Parser {
+    Obj_ReadOptions  options;
+    const char      *path;
+    char            *readBuffers;
+    char            *lineBuff;
+    size_t           lineBuffSize;
+    uint32_t         numErrors;
+    Obj_Error       *errors;
+    uint32_t         errorsCapacity;
+    Obj_Bounds       posBounds;
+    float            posScale[3];
+    Obj_Stats        stats;
+    size_t           meshBytes;
+    size_t           bufferBytes;
+    Obj_RangeMarks   marks;
+    Obj_MtlLibList   libs;
+    bool             reservedNormals;
+    Obj_ChunkRecord *records;
+    uint32_t         numRecords;
+    bool             generatedNormals;
+};
+
+/*
+ * Obj_FileMapping:
+ *
+ * A read-only or copy-on-write memory mapping of a whole file
+ * @data: first byte of the mapped file, NULL when the file is empty
+ * @size: size of the file in bytes
+ */
+typedef struct Obj_FileMapping {
+    const char *data;
+    size_t      size;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE view;
+#endif
+} Obj_FileMapping;
+
+/*
+ * Obj_LineSpec:
+ *
+ * Keyword starting the lines of a given type, which a blank follows
+ * @keyword: keyword characters, without a null terminator being required
+ * @len: number of characters in the keyword
+ */
+typedef struct Obj_LineSpec {
+    const char *keyword;
+    uint32_t    len;
+} Obj_LineSpec;
+
+/*
+ * Obj_ParseState:
+ *
+ * Holds the mesh data being filled while parsing, along with how much of it is used
+ * @parser: parser the data is read by
+ * @data: mesh arrays being filled
+ * @capacity: number of elements each array can currently hold
+ * @count: number of elements read so far
+ * @base: number of elements read before the first ones of the arrays, which relative face indices
+ *  also account for. Only streamed reads, which reuse the arrays for each batch, have any.
+ * @lineNum: number of the line being parsed
+ * @offset: offset in the file of the lines parse_buffer is handed next, which consecutive calls
+ *  advance
+ * @lineOffset: offset in the file of the line being parsed
+ * @numLineErrors: number of errors reported about the lines parsed
+ * @fixedCapacity: whether the arrays are shared with other parsers and must not be reallocated
+ * @stats: where the lines parsed are counted, NULL when stats are not collected
+ * @marks: where the range statements parsed are recorded, NULL when they are skipped
+ * @libs: where the material libraries parsed are added, NULL when they are not loaded
+ * @relativeIndices: set when a face holds relative indices, NULL when they are not tracked
+ * @chunkIdx, @firstFailed: chunk parsed by a chunked read, and first chunk of the read which
+ *  failed, which stops the parsing of the chunks after it. @firstFailed is NULL in other reads.
+ */
+typedef struct Obj_ParseState {
+    Obj_Parser     *parser;
+    Obj_MeshData    data;
+    Obj_MeshSizes   capacity;
+    Obj_MeshSizes   count;
+    Obj_MeshSizes   base;
+    uint32_t        lineNum;
+    uint64_t        offset;
+    uint64_t        lineOffset;
+    uint32_t        numLineErrors;
+    bool            fixedCapacity;
+    Obj_Stats      *stats;
+    Obj_RangeMarks *marks;
+    Obj_MtlLibList *libs;
+    bool           *relativeIndices;
+    uint32_t        chunkIdx;
+    const uint32_t *firstFailed;
+} Obj_ParseState;
+
+/*
+ * Obj_ComponentArrays:
+ *
+ * Arrays holding the components of a kind of vertex attribute, as floats or quantized values
+ * @arrays: addresses of the array pointers in the mesh data
+ * @numArrays: number of components
+ * @elemSize: bytes per component
+ */
+typedef struct Obj_ComponentArrays {
+    void   **arrays[3];
+    uint32_t numArrays;
+    size_t   elemSize;
+} Obj_ComponentArrays;
+
+#if defined(_WIN32)
+typedef HANDLE             Obj_Thread;
+typedef SRWLOCK            Obj_Mutex;
+typedef CONDITION_VARIABLE Obj_Cond;
+#else
+typedef pthread_t       Obj_Thread;
+typedef pthread_mutex_t Obj_Mutex;
+typedef pthread_cond_t  Obj_Cond;
+#endif
+
+typedef void (*Obj_TaskFn)(void *context, uint32_t taskIdx);
+
+/*
+ * Obj_TaskLaunch:
+ *
+ * Arguments of a task run on a worker thread
+ */
+typedef struct Obj_TaskLaunch {
+    Obj_TaskFn task;
+    void      *context;
+    uint32_t   taskIdx;
+} Obj_TaskLaunch;
+
+/*
+ * Obj_FileStamp:
+ *
+ * Size and modification time of a file, either of which changes when the file is written to
+ * @size: size of the file in bytes
+ * @time: modification time of the file, in nanoseconds on POSIX systems and in 100 nanosecond
+ *  intervals on Windows
+ */
+typedef struct Obj_FileStamp {
+    uint64_t size;
+    uint64_t time;
+} Obj_FileStamp;
+
+/*
+ * Obj_MtlEntry:
+ *
+ * Material library held by the process-wide material cache
+ * @lib: library handed out to meshes, which point at the entry through it
+ * @refCount: number of meshes and reads holding the library
+ * @loaded: whether the loader thread is done with the library
+ * @stale: whether the library is out of date, either because its file changed or could not be
+ *  read, so that the next reads parse it again. It is freed once no longer referred to.
+ * @fileStamp: size and modification time of the file when it was parsed
+ * @launch: task of the loader thread
+ * @strings: names and texture maps of the materials
+ * @next: next entry of the cache
+ */
+struct Obj_MtlEntry {
+    Obj_MaterialLib lib;
+    uint32_t        refCount;
+    bool            loaded;
+    bool            stale;
+    Obj_FileStamp   fileStamp;
+    Obj_TaskLaunch  launch;
+    char           *strings;
+    Obj_MtlEntry   *next;
+};
+
+/*
+ * Obj_MtlCache:
+ *
+ * Material libraries of the process, shared by all the parsers
+ * @mutex: guards the entries, and the loading state of their libraries
+ * @loadedCond: signalled whenever a library is loaded
+ * @entries: list of the cached libraries
+ */
+typedef struct Obj_MtlCache {
+    Obj_Mutex     mutex;
+    Obj_Cond      loadedCond;
+    Obj_MtlEntry *entries;
+} Obj_MtlCache;
+
+/*
+ * Obj_ReadAhead:
+ *
+ * Ring of buffers a producer thread reads the blocks of a file in, while the parser consumes the
+ * blocks read before. Without a producer thread, blocks are read when the parser asks for them.
+ * @file: file being read
+ * @buffers: READ_AHEAD_NUM_BUFFERS buffers of READ_AHEAD_BUFFER_SIZE bytes
+ * @lens: number of bytes read in each buffer
+ * @numFilled: number of blocks read so far, block i going to buffer i % READ_AHEAD_NUM_BUFFERS
+ * @numConsumed: number of blocks the parser is done with, whose buffers may be read in again
+ * @endOfFile: whether the last block of the file was read
+ * @failed: whether reading the file failed
+ * @stop: whether the parser gave up on the file, and the producer should stop reading it
+ * @threaded: whether a producer thread reads the file
+ */
+typedef struct Obj_ReadAhead {
+    FILE      *file;
+    char      *buffers;
+    size_t     lens[READ_AHEAD_NUM_BUFFERS];
+    uint32_t   numFilled;
+    uint32_t   numConsumed;
+    bool       endOfFile;
+    bool       failed;
+    bool       stop;
+    bool       threaded;
+    Obj_Mutex  mutex;
+    Obj_Cond   cond;
+    Obj_Thread thread;
+} Obj_ReadAhead;
+
+/*
+ * Obj_CacheHeader:
+ *
+ * Header of a binary cache file, padded to BLOCK_ALIGNMENT bytes. The mesh arrays follow it with
+ * the layout of a single block mesh, and then the face range arrays, so they are mapped in place.
+ * @magic: CACHE_MAGIC, only written once the rest of the file is, so that an interrupted write
+ *  leaves an invalid cache
+ * @version: CACHE_VERSION the file was written with
+ * @byteOrder: CACHE_BYTE_ORDER as stored by the machine which wrote the file
+ * @source: size and modification time of the wavefront file the mesh was read from, all zero for
+ *  the caches written by obj_write_cache
+ * @loadFlags: load flags the mesh was read with
+ * @sizes: number of elements of the mesh
+ * @numRanges, @numNames, @namesSize: sizes of the face range arrays of the mesh
+ * @numMaterialLibs, @materialLibsSize: number of material library paths following the face ranges,
+ *  and their size including their null terminators
+ */
+typedef struct Obj_CacheHeader {
+    char          magic[8];
+    uint32_t      version;
+    uint32_t      byteOrder;
+    Obj_FileStamp source;
+    uint32_t      loadFlags;
+    Obj_MeshSizes sizes;
+    uint32_t      numRanges[OBJ_NUM_RANGE_KINDS];
+    uint32_t      numNames;
+    uint32_t      namesSize;
+    uint32_t      numMaterialLibs;
+    uint32_t      materialLibsSize;
+} Obj_CacheHeader;
+
+typedef Obj_Return (*Obj_ReadFn)(Obj_Parser *parser, const char *path);
+
+/*
+ * Obj_PendingFile:
+ *
+ * File of a multi-file read
+ * @size: size of the file, which it is scheduled by
+ * @idx: index of the file in the paths given to the read
+ */
+typedef struct Obj_PendingFile {
+    uint64_t size;
+    uint32_t idx;
+} Obj_PendingFile;
+
+/*
+ * Obj_ManyRead:
+ *
+ * State shared by the worker threads of a multi-file read, which take the next pending file from a
+ * shared counter until none is left
+ * @paths: paths of all the files read
+ * @results: result of the read of each file
+ * @files: files read by the workers, largest first
+ * @numFiles: number of files in @files
+ * @nextFile: number of files taken by the workers so far, incremented atomically
+ * @options: options of the reads, each of which runs on a single thread
+ */
+typedef struct Obj_ManyRead {
+    const char *const     *paths;
+    Obj_Return            *results;
+    const Obj_PendingFile *files;
+    uint32_t               numFiles;
+    uint32_t               nextFile;
+    Obj_ReadOptions        options;
+} Obj_ManyRead;
+
+/*
+ * Obj_Chunk:
+ *
+ * A range of lines of a buffer parsed by a worker thread
+ * @begin: first character of the chunk
+ * @end: character right after the last line of the chunk
+ * @sizes: number of elements counted in the chunk
+ * @numLines: number of lines in the chunk
+ * @offset: elements counted in all previous chunks, hence where the chunk data goes in the arrays
+ * @firstLine: lines in all previous chunks
+ * @read: offsets right after the last elements actually read from the chunk
+ * @successfulRead: whether the chunk was parsed without errors
+ * @posBounds: bounds of the vertex positions of the chunk, found when quantizing them
+ * @stats: lines of the chunk parsed, when stats are collected
+ * @marks: range statements of the chunk, whose faces are numbered as in the counted mesh
+ * @numErrors: number of errors reported about the lines of the chunk
+ * @libs: material libraries of the chunk
+ * @hash: content hash of the chunk, in incremental reads
+ * @record: record of the previous read with the same content, NULL when there is none
+ * @reused: whether the elements of the chunk are copied from the previous mesh instead of parsed
+ * @relativeIndices: whether faces of the chunk hold relative indices, in incremental reads
+ */
+typedef struct Obj_Chunk {
+    const char            *begin;
+    const char            *end;
+    Obj_MeshSizes          sizes;
+    uint32_t               numLines;
+    Obj_MeshSizes          offset;
+    uint32_t               firstLine;
+    Obj_MeshSizes          read;
+    bool                   successfulRead;
+    Obj_Bounds             posBounds;
+    Obj_Stats              stats;
+    Obj_RangeMarks         marks;
+    uint32_t               numErrors;
+    Obj_MtlLibList         libs;
+    uint64_t               hash;
+    const Obj_ChunkRecord *record;
+    bool                   reused;
+    bool                   relativeIndices;
+} Obj_Chunk;
+
+/*
+ * Obj_ChunkedRead:
+ *
+ * State shared by the worker threads of a chunked read
+ * @begin: first byte of the buffer read, which the offsets of the lines of the chunks count from
+ * @previous: mesh arrays of the previous read, which reused chunks copy their elements from
+ * @chunkTask, @numChunks, @nextChunk: task run on each of the chunks of incremental reads, which
+ *  outnumber the threads, and number of chunks it was run on so far, incremented atomically
+ * @firstFailed: first chunk whose parsing failed, UINT32_MAX while none did, lowered atomically.
+ *  A single-threaded read stops there, so the chunks after it stop parsing as well.
+ */
+typedef struct Obj_ChunkedRead {
+    Obj_Parser         *parser;
+    const char         *begin;
+    Obj_Chunk          *chunks;
+    Obj_MeshData        data;
+    const Obj_MeshData *previous;
+    Obj_TaskFn          chunkTask;
+    uint32_t            numChunks;
+    uint32_t            nextChunk;
+    uint32_t            firstFailed;
+} Obj_ChunkedRead;
+
+/*
+ * Obj_CutSearch:
+ *
+ * Range of lines of a buffer a worker thread looks for the lines starting incremental read chunks
+ * in, which it collects in order
+ */
+typedef struct Obj_CutSearch {
+    const char  *begin;
+    const char  *end;
+    const char **cuts;
+    uint32_t     numCuts;
+    uint32_t     capacity;
+    bool         allocated;
+} Obj_CutSearch;
+
+/*
+ * Obj_GpuRange:
+ *
+ * Range of consecutive faces a worker thread builds the GPU mesh of
+ * @firstFace, @endFace: faces of the range
+ * @firstCorner: face vertices in all previous ranges
+ * @firstTriangle: triangles in all previous ranges
+ * @firstVert: vertices first appearing in all previous ranges
+ * @numVerts: vertices first appearing in the range
+ * @valid: whether all the face vertices of the range refer to existing elements
+ */
+typedef struct Obj_GpuRange {
+    uint32_t firstFace;
+    uint32_t endFace;
+    uint32_t firstCorner;
+    uint32_t firstTriangle;
+    uint32_t firstVert;
+    uint32_t numVerts;
+    bool     valid;
+} Obj_GpuRange;
+
+/*
+ * Obj_GpuBuild:
+ *
+ * State shared by the worker threads building a GPU mesh
+ * @table: open-addressing hash set of face vertices, each slot holding the index of a face vertex
+ *  plus one, or 0 when empty. Among face vertices sharing the same indices, it keeps the first one.
+ * @tableMask: number of slots in @table minus one, which is a power of two
+ * @representatives: for each face vertex, the first face vertex sharing its indices
+ * @vertIndices: for each face vertex, the GPU vertex it was merged into
+ * @maxFaceSize: number of vertices of the largest face
+ */
+typedef struct Obj_GpuBuild {
+    const Obj_Mesh       *mesh;
+    const Obj_GpuOptions *options;
+    Obj_GpuMesh          *gpuMesh;
+    Obj_GpuRange         *ranges;
+    uint32_t             *table;
+    size_t                tableMask;
+    uint32_t             *representatives;
+    uint32_t             *vertIndices;
+    uint32_t              maxFaceSize;
+} Obj_GpuBuild;
+
+/*
+ * Obj_GeometryRange:
+ *
+ * Range of consecutive positions or faces a worker thread runs a geometry pass over
+ * @first, @end: positions or faces of the range
+ * @firstCorner: face vertices in all previous ranges of faces
+ * @bounds: bounds of the positions of the range
+ * @missingNormals: whether some face vertex of the range has no normal
+ * @valid: whether all the face vertices of the range refer to existing elements
+ */
+typedef struct Obj_GeometryRange {
+    uint32_t   first;
+    uint32_t   end;
+    uint32_t   firstCorner;
+    Obj_Bounds bounds;
+    bool       missingNormals;
+    bool       valid;
+} Obj_GeometryRange;
+
+/*
+ * Obj_GeometryPass:
+ *
+ * State shared by the worker threads computing the bounds, normals or tangents of a mesh
+ * @faceNormals: normal of each face, scaled by twice its area
+ * @faceTangents, @faceBitangents: tangent and bitangent of each face, summed over its triangles
+ *  weighted by their area
+ * @faceFlipped: whether the texture coordinates of each face are mirrored
+ * @texTangents, @texBitangents: tangents and bitangents summed over the faces using each texture
+ *  coordinates, in two slots per texture coordinates, the second one for mirrored faces
+ * @normals: normals written by the pass, or read by the tangents pass for the face vertices
+ *  without their own, one per position
+ * @tangents: tangents written by the pass, one per face vertex
+ */
+typedef struct Obj_GeometryPass {
+    const Obj_Mesh    *mesh;
+    Obj_GeometryRange *ranges;
+    float            (*faceNormals)[3];
+    float            (*faceTangents)[3];
+    float            (*faceBitangents)[3];
+    bool              *faceFlipped;
+    float            (*texTangents)[3];
+    float            (*texBitangents)[3];
+    float             *normals[3];
+    float             *tangents[4];
+} Obj_GeometryPass;
+
+/*
+ * Obj_GpuGroup:
+ *
+ * Range of consecutive triangles of a GPU mesh, which a worker thread reorders on its own
+ * @firstTriangle, @endTriangle: triangles of the group
+ * @optimized: whether the group got the memory to reorder its triangles
+ */
+typedef struct Obj_GpuGroup {
+    uint32_t firstTriangle;
+    uint32_t endTriangle;
+    bool     optimized;
+} Obj_GpuGroup;
+
+/*
+ * Obj_GpuCluster:
+ *
+ * Triangles which the vertex cache order of a group emits in a row, until it has to restart from a
+ * vertex out of the cache, and which are moved as a whole when ordering for overdraw
+ * @first, @end: positions of the triangles of the cluster in the vertex cache order
+ * @outwardness: how far out of the mesh centroid the cluster lies along its normal
+ */
+typedef struct Obj_GpuCluster {
+    uint32_t first;
+    uint32_t end;
+    float    outwardness;
+} Obj_GpuCluster;
+
+/*
+ * Obj_CacheOrder:
+ *
+ * Scratch of the Tipsify ordering of the triangles of a group, over the span of vertices they use
+ * @indices: vertex indices of the triangles, relative to the first vertex of the span
+ * @numVerts: number of vertices in the span
+ * @liveTriangles: number of triangles of each vertex which are not emitted yet
+ * @firstTriangles, @vertTriangles: triangles of each vertex, those of vertex v being
+ *  @vertTriangles[@firstTriangles[v]] to @vertTriangles[@firstTriangles[v + 1] - 1]
+ * @cacheTimes: time each vertex last entered the cache, which it leaves once cacheSize other
+ *  vertices entered
+ * @time: number of vertices which entered the cache, offset so that no vertex starts in it
+ * @emitted: whether each triangle was emitted
+ * @deadEnds, @numDeadEnds: stack of the vertices of the emitted triangles, which the order restarts
+ *  from when it runs out of candidates in the cache
+ * @nextVert: next vertex scanned for triangles left, once the stack is empty
+ * @order, @numOrdered: triangles in the order they were emitted
+ * @clusters, @numClusters: runs of @order between restarts
+ */
+typedef struct Obj_CacheOrder {
+    uint32_t       *indices;
+    uint32_t        numVerts;
+    uint32_t       *liveTriangles;
+    uint32_t       *firstTriangles;
+    uint32_t       *vertTriangles;
+    uint32_t       *cacheTimes;
+    uint32_t        time;
+    bool           *emitted;
+    uint32_t       *deadEnds;
+    uint32_t        numDeadEnds;
+    uint32_t        nextVert;
+    uint32_t       *order;
+    uint32_t        numOrdered;
+    Obj_GpuCluster *clusters;
+    uint32_t        numClusters;
+} Obj_CacheOrder;
+
+/*
+ * Obj_GpuOptimize:
+ *
+ * State shared by the worker threads optimizing the triangle and vertex orders of a GPU mesh
+ * @groups: groups of triangles reordered on their own
+ * @cacheSize: number of vertices of the vertex cache the triangles are ordered for
+ * @centroid: centroid of the vertex positions, which clusters are ordered around for overdraw
+ * @ranges: ranges of vertices moved to their fetch order
+ * @remap: index of each vertex in fetch order
+ * @arrays, @widths, @numArrays: vertex arrays of the mesh, with their number of floats per vertex
+ * @moved: arrays the vertices are moved to
+ */
+typedef struct Obj_GpuOptimize {
+    Obj_GpuMesh          *gpuMesh;
+    const Obj_GpuOptions *options;
+    Obj_GpuGroup         *groups;
+    uint32_t              cacheSize;
+    float                 centroid[3];
+    Obj_GeometryRange    *ranges;
+    uint32_t             *remap;
+    float               **arrays[MAX_GPU_VERTEX_ARRAYS];
+    uint32_t              widths[MAX_GPU_VERTEX_ARRAYS];
+    uint32_t              numArrays;
+    float                *moved[MAX_GPU_VERTEX_ARRAYS];
+} Obj_GpuOptimize;
+
+/*
+ * Obj_MeshletBuild:
+ *
+ * State of the split of a GPU mesh in meshlets, and of the worker threads computing their bounds
+ * @maxVertices, @maxTriangles: limits of each meshlet
+ * @stamps: meshlet each vertex was last added to
+ * @slots: index of each vertex in the meshlet it was last added to
+ * @numRanges: number of ranges of meshlets whose bounds are computed in parallel
+ */
+typedef struct Obj_MeshletBuild {
+    Obj_Meshlets *meshlets;
+    uint32_t      maxVertices;
+    uint32_t      maxTriangles;
+    uint32_t     *stamps;
+    uint8_t      *slots;
+    uint32_t      numRanges;
+} Obj_MeshletBuild;
+
+/*
+ * Obj_Stream:
+ *
+ * Streamed read of a file, parsed in batches of the lines held in a bounded buffer
+ * @parser: parser the batches are read by
+ * @file: file being streamed
+ * @buffer: lines of the current batch, followed by the start of the next one
+ * @bufferSize: size of @buffer, which only grows to fit lines longer than it
+ * @filledLen: number of characters read in @buffer
+ * @carryLen: length of the line left incomplete at the end of the previous batch, which was moved
+ *  to the start of @buffer
+ * @state: parse state of the current batch, whose arrays are reused by all batches
+ * @endOfFile: whether the whole file was read in @buffer
+ * @failed: whether an error aborted the read
+ */
+struct Obj_Stream {
+    Obj_Parser     parser;
+    FILE          *file;
+    char          *buffer;
+    size_t         bufferSize;
+    size_t         filledLen;
+    size_t         carryLen;
+    Obj_ParseState state;
+    bool           endOfFile;
+    bool           failed;
+};
+
+/*
+ * Obj_ElementRun:
+ *
+ * Consecutive lines of a lazily opened file holding elements of a single kind, along with the lines
+ * holding none which lie between them
+ * @type: kind of the elements, OBJ_VECPOS, OBJ_VECTEXT, OBJ_VECNORM or OBJ_FACE
+ * @begin, @end: offsets in the file of the first byte of the run and of the byte following it
+ * @firstLine: number of the line preceding the run
+ * @base: elements counted before the run, hence where its elements go in the mesh arrays, and what
+ *  its relative face indices resolve against
+ */
+typedef struct Obj_ElementRun {
+    Obj_LineType  type;
+    uint64_t      begin;
+    uint64_t      end;
+    uint32_t      firstLine;
+    Obj_MeshSizes base;
+} Obj_ElementRun;
+
+/*
+ * Obj_LazyMesh:
+ *
+ * Lazily opened file, whose element streams are only parsed once asked for
+ * @parser: parser the file is counted and its streams parsed by
+ * @mesh: counts of the file, and arrays of the streams loaded so far
+ * @capacity: number of elements the arrays of @mesh are allocated for
+ * @loaded: Obj_LazyStreams bitmask of the streams loaded
+ * @mapping: mapping of the file when it is @mapped
+ * @mapped: whether the file stays mapped while open, instead of being read again by each load
+ * @fileStamp: size and modification time of the file when it was counted, which the loads of a file
+ *  which is not @mapped check it still has
+ * @runs, @numRuns: element runs of the file, in order
+ * @runsCapacity: number of runs @runs can hold
+ * @offset: offset in the file of the lines being counted
+ * @lineNum: number of lines counted so far
+ */
+struct Obj_LazyMesh {
+    Obj_Parser      parser;
+    Obj_Mesh        mesh;
+    Obj_MeshSizes   capacity;
+    uint32_t        loaded;
+    Obj_FileMapping mapping;
+    bool            mapped;
+    Obj_FileStamp   fileStamp;
+    Obj_ElementRun *runs;
+    uint32_t        numRuns;
+    uint32_t        runsCapacity;
+    uint64_t        offset;
+    uint32_t        lineNum;
+};
+
+/*
+ * Obj_FloatDecimal:
+ *
+ * Decimal number worth @mantissa * 10^@exponent
+ */
+typedef struct Obj_FloatDecimal {
+    uint32_t mantissa;
+    int32_t  exponent;
+} Obj_FloatDecimal;
+
+/*
+ * Obj_BigDecimal:
+ *
+ * Decimal number being rounded to a float, worth 0.d1d2d3... * 10^@point
+ * @digits: significant digits, without leading nor trailing zeros
+ * @numDigits: digits held in @digits
+ * @truncated: whether nonzero digits did not fit in @digits
+ */
+typedef struct Obj_BigDecimal {
+    uint8_t  digits[MAX_DECIMAL_DIGITS];
+    uint32_t numDigits;
+    int32_t  point;
+    bool     truncated;
+} Obj_BigDecimal;
+
+/*
+ * Obj_WriteChunk:
+ *
+ * Consecutive lines of a wavefront file being written, which a worker thread formats into a buffer
+ * of its own
+ * @first, @end: elements of the chunk, numbering the positions, then the texture coordinates, the
+ *  normals and the faces
+ * @firstCorner: face vertices of the faces before the chunk
+ * @nextRanges: first range of each kind which does not start before the chunk
+ * @text: text of the chunk, which the following chunks of the thread reuse
+ * @size, @capacity: bytes of @text used and allocated
+ * @failed: whether @text could not grow
+ */
+typedef struct Obj_WriteChunk {
+    uint64_t first;
+    uint64_t end;
+    uint32_t firstCorner;
+    uint32_t nextRanges[OBJ_NUM_RANGE_KINDS];
+    char    *text;
+    size_t   size;
+    size_t   capacity;
+    bool     failed;
+} Obj_WriteChunk;
+
+/*
+ * Obj_WavefrontWrite:
+ *
+ * Mesh being written as a wavefront file, in rounds of one chunk per thread
+ */
+typedef struct Obj_WavefrontWrite {
+    const Obj_Mesh *mesh;
+    Obj_WriteChunk *chunks;
+} Obj_WavefrontWrite;
 
 /**************************************************************************************************
  * Constants
  *************************************************************************************************/
 
-static const char *const LINE_SPEC[OBJ_NUM_LINE_TYPES] = {
-    [OBJ_COMMENT]  = "# ",
-    [OBJ_VECPOS]   = "v ",
-    [OBJ_VECTEXT]  = "vt ",
-    [OBJ_VECNORM]  = "vn ",
-    [OBJ_VECPARAM] = "vp ",
-    [OBJ_FACE]     = "f ",
-    [OBJ_LINE]     = "l ",
-    [OBJ_MTLSPEC]  = "mtllib ",
-    [OBJ_MTLUSE]   = "usemtl ",
-    [OBJ_OBJECT]   = "o ",
-    [OBJ_GROUP]    = "g ",
-    [OBJ_SSHADING] = "s ",
+static const Obj_LineSpec LINE_SPEC[OBJ_NUM_LINE_TYPES] = {
+    [OBJ_COMMENT]  = {"#", 1u},
+    [OBJ_VECPOS]   = {"v", 1u},
+    [OBJ_VECTEXT]  = {"vt", 2u},
+    [OBJ_VECNORM]  = {"vn", 2u},
+    [OBJ_VECPARAM] = {"vp", 2u},
+    [OBJ_FACE]     = {"f", 1u},
+    [OBJ_LINE]     = {"l", 1u},
+    [OBJ_MTLSPEC]  = {"mtllib", 6u},
+    [OBJ_MTLUSE]   = {"usemtl", 6u},
+    [OBJ_OBJECT]   = {"o", 1u},
+    [OBJ_GROUP]    = {"g", 1u},
+    [OBJ_SSHADING] = {"s", 1u},
+};
+
+// Powers of ten that are exactly representable as doubles
+static const double EXACT_POW10[MAX_EXACT_POW10 + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
 };
 
-static const char *const FACE_INDEX_FORMAT[OBJ_NUM_FACE_TYPES] = {
-    [OBJ_POS_ONLY]         = "%d",
-    [OBJ_POS_AND_TEX]      = "%d/%d",
-    [OBJ_POS_AND_NORM]     = "%d//%d",
-    [OBJ_POS_TEX_AND_NORM] = "%d/%d/%d",
+// Powers of 2 scaling decimals with the given number of integer digits, or of leading zero
+// fractional digits, towards [0.5, 1) without overshooting, DECIMAL_SHIFT_STEP past the table
+static const uint32_t DECIMAL_SHIFTS[] = {1u, 3u, 6u, 9u, 13u, 16u, 19u, 23u, 26u};
+
+// Powers of 5 and their inverses, scaled to FLOAT_POW5_BITCOUNT and FLOAT_POW5_INV_BITCOUNT bits
+static const uint64_t FLOAT_POW5_INV_SPLIT[32] = {
+    UINT64_C(576460752303423489), UINT64_C(461168601842738791), UINT64_C(368934881474191033),
+    UINT64_C(295147905179352826), UINT64_C(472236648286964522), UINT64_C(377789318629571618),
+    UINT64_C(302231454903657294), UINT64_C(483570327845851670), UINT64_C(386856262276681336),
+    UINT64_C(309485009821345069), UINT64_C(495176015714152110), UINT64_C(396140812571321688),
+    UINT64_C(316912650057057351), UINT64_C(507060240091291761), UINT64_C(405648192073033409),
+    UINT64_C(324518553658426727), UINT64_C(519229685853482763), UINT64_C(415383748682786211),
+    UINT64_C(332306998946228969), UINT64_C(531691198313966350), UINT64_C(425352958651173080),
+    UINT64_C(340282366920938464), UINT64_C(544451787073501542), UINT64_C(435561429658801234),
+    UINT64_C(348449143727040987), UINT64_C(557518629963265579), UINT64_C(446014903970612463),
+    UINT64_C(356811923176489971), UINT64_C(570899077082383953), UINT64_C(456719261665907162),
+    UINT64_C(365375409332725730), UINT64_C(292300327466180584),
+};
+
+static const uint64_t FLOAT_POW5_SPLIT[48] = {
+    UINT64_C(1152921504606846976), UINT64_C(1441151880758558720), UINT64_C(1801439850948198400),
+    UINT64_C(2251799813685248000), UINT64_C(1407374883553280000), UINT64_C(1759218604441600000),
+    UINT64_C(2199023255552000000), UINT64_C(1374389534720000000), UINT64_C(1717986918400000000),
+    UINT64_C(2147483648000000000), UINT64_C(1342177280000000000), UINT64_C(1677721600000000000),
+    UINT64_C(2097152000000000000), UINT64_C(1310720000000000000), UINT64_C(1638400000000000000),
+    UINT64_C(2048000000000000000), UINT64_C(1280000000000000000), UINT64_C(1600000000000000000),
+    UINT64_C(2000000000000000000), UINT64_C(1250000000000000000), UINT64_C(1562500000000000000),
+    UINT64_C(1953125000000000000), UINT64_C(1220703125000000000), UINT64_C(1525878906250000000),
+    UINT64_C(1907348632812500000), UINT64_C(1192092895507812500), UINT64_C(1490116119384765625),
+    UINT64_C(1862645149230957031), UINT64_C(1164153218269348144), UINT64_C(1455191522836685180),
+    UINT64_C(1818989403545856475), UINT64_C(2273736754432320594), UINT64_C(1421085471520200371),
+    UINT64_C(1776356839400250464), UINT64_C(2220446049250313080), UINT64_C(1387778780781445675),
+    UINT64_C(1734723475976807094), UINT64_C(2168404344971008868), UINT64_C(1355252715606880542),
+    UINT64_C(1694065894508600678), UINT64_C(2117582368135750847), UINT64_C(1323488980084844279),
+    UINT64_C(1654361225106055349), UINT64_C(2067951531382569187), UINT64_C(1292469707114105741),
+    UINT64_C(1615587133892632177), UINT64_C(2019483917365790221), UINT64_C(1262177448353618888),
+};
+
+// Statements starting the face ranges of each kind
+static const Obj_LineType RANGE_LINE_TYPES[OBJ_NUM_RANGE_KINDS] = {
+    [OBJ_RANGE_OBJECT]    = OBJ_OBJECT,
+    [OBJ_RANGE_GROUP]     = OBJ_GROUP,
+    [OBJ_RANGE_MATERIAL]  = OBJ_MTLUSE,
+    [OBJ_RANGE_SMOOTHING] = OBJ_SSHADING,
+};
+
+static const char *const MEMORY_BUFFER_NAME = "<memory buffer>";
+
+static const char *const ERROR_STRINGS[OBJ_NUM_ERROR_CODES] = {
+    [OBJ_ERROR_NONE]                    = "No error",
+    [OBJ_ERROR_NOT_OBJ_FILE]            = "Not an obj file",
+    [OBJ_ERROR_OPEN_FAILED]             = "Failed to open the file",
+    [OBJ_ERROR_READ_FAILED]             = "Failed to read the file",
+    [OBJ_ERROR_WRITE_FAILED]            = "Failed to write the file",
+    [OBJ_ERROR_OUT_OF_MEMORY]           = "Out of memory",
+    [OBJ_ERROR_UNKNOWN_LINE]            = "Unknown line type",
+    [OBJ_ERROR_INVALID_POSITION]        = "Invalid vertex position",
+    [OBJ_ERROR_INVALID_TEXCOORD]        = "Invalid texture coordinate",
+    [OBJ_ERROR_INVALID_NORMAL]          = "Invalid vertex normal",
+    [OBJ_ERROR_INVALID_FACE]            = "Invalid face",
+    [OBJ_ERROR_DEGENERATE_FACE]         = "Face with fewer than 3 vertices",
+    [OBJ_ERROR_INVALID_SMOOTHING_GROUP] = "Invalid smoothing group",
+    [OBJ_ERROR_UNCOUNTED_ELEMENTS]      = "More elements than counted",
+    [OBJ_ERROR_MATERIAL_LIB]            = "Failed to read a material library",
+    [OBJ_ERROR_FILE_CHANGED]            = "The file changed since it was opened",
+    [OBJ_ERROR_INVALID_CACHE]           = "Invalid cache",
+    [OBJ_ERROR_UNSUPPORTED_MESH]        = "Mesh not supported by the operation",
+    [OBJ_ERROR_MISSING_ELEMENTS]        = "Faces refer to missing elements",
+    [OBJ_ERROR_MESH_TOO_LARGE]          = "Mesh too large",
+    [OBJ_ERROR_INVALID_OPTIONS]         = "Options out of range",
 };
 
+static const Obj_Material DEFAULT_MATERIAL = {.opticalDensity = 1.0f, .dissolve = 1.0f};
+
 /**************************************************************************************************
- * Variables
+ * Globals
  *************************************************************************************************/
 
-static const char *currentPath;
-
-static char lineBuff[MAX_LINE_LEN];
+static Obj_MtlCache materialCache = {MUTEX_INITIALIZER, COND_INITIALIZER, NULL};
 
 /**************************************************************************************************
  * Helper methods
  *************************************************************************************************/
 
-static uint32_t strlen_s(const char *s) {
-    static const uint32_t MAX_LEN = (uint32_t)0xffffffff;
-    for (uint32_t i = 0; i < MAX_LEN; ++i) {
-        if (!s) {
-            return i;
-        }
-        ++s;
-    }
-    return MAX_LEN;
+/*
+ * Increments @value, which other threads may access at the same time, and returns its new value
+ */
+static uint32_t atomic_increment(uint32_t *value) {
+#if defined(_WIN32)
+    return (uint32_t)InterlockedIncrement((volatile LONG *)value);
+#else
+    return __atomic_add_fetch(value, 1u, __ATOMIC_RELAXED);
+#endif
 }
 
-static bool str_endswith(const char *s, const char *suff) {
-    uint32_t sLen    = strlen_s(s);
-    uint32_t suffLen = strlen_s(suff);
-
-    return (sLen >= suffLen && strncmp(s + sLen - suffLen, suff, suffLen) == 0);
+/*
+ * Loads @value, which other threads may write at the same time
+ */
+static uint32_t atomic_load(const uint32_t *value) {
+#if defined(_WIN32)
+    return (uint32_t)InterlockedOr((volatile LONG *)value, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
 }
 
-static const bool try_open_obj(FILE **fptr_p) {
-    if (!str_endswith(currentPath, ".obj") && !str_endswith(currentPath, ".OBJ")) {
-        fprintf(stderr, "Error, trying to read file %s:\n Not an .obj file\n", currentPath);
-        return false;
-    }
+/*
+ * Sets @value to @desired if it still holds @expected, which other threads may change at the same
+ * time, and returns whether it did
+ */
+static bool atomic_compare_exchange(uint32_t *value, uint32_t expected, uint32_t desired) {
+#if defined(_WIN32)
+    volatile LONG *target = (volatile LONG *)value;
+    return (uint32_t)InterlockedCompareExchange(target, (LONG)desired, (LONG)expected) == expected;
+#else
+    return __atomic_compare_exchange_n(
+        value,
+        &expected,
+        desired,
+        false,
+        __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE
+    );
+#endif
+}
 
-    // Check from path whether the file is indeed Wavefront format
+#if defined(_WIN32)
+static DWORD WINAPI run_task_launch(LPVOID arg) {
+    Obj_TaskLaunch *launch = arg;
+    launch->task(launch->context, launch->taskIdx);
+    return 0;
+}
+#else
+static void *run_task_launch(void *arg) {
+    Obj_TaskLaunch *launch = arg;
+    launch->task(launch->context, launch->taskIdx);
+    return NULL;
+}
+#endif
 
-    *fptr_p = fopen(currentPath, "r");
+/*
+ * Starts a thread running the task of @launch, which must outlive it
+ */
+static bool start_thread(Obj_Thread *thread, Obj_TaskLaunch *launch) {
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, run_task_launch, launch, 0, NULL);
+    return *thread != NULL;
+#else
+    return pthread_create(thread, NULL, run_task_launch, launch) == 0;
+#endif
+}
 
-    if (!*fptr_p) {
-        fprintf(stderr, "Error, trying to read file %s:\n Could not open the file.", currentPath);
-        return false;
-    }
+static void join_thread(Obj_Thread thread) {
+#if defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
 
-    return true;
+/*
+ * Lets @thread run on its own, releasing its resources once it returns
+ */
+static void detach_thread(Obj_Thread thread) {
+#if defined(_WIN32)
+    CloseHandle(thread);
+#else
+    pthread_detach(thread);
+#endif
 }
 
-static Obj_LineType get_line_type() {
-    for (int i = 0; i < OBJ_NUM_LINE_TYPES; ++i) {
-        if (strncmp(lineBuff, LINE_SPEC[i], strlen(LINE_SPEC[i])) == 0) {
-            return (Obj_LineType)i;
+/*
+ * Runs @task for every index in [0, numTasks), each on its own thread. Tasks which cannot get a
+ * thread are run on the calling one instead.
+ */
+static void run_tasks(Obj_TaskFn task, void *context, uint32_t numTasks) {
+    Obj_TaskLaunch *launches = malloc(numTasks * sizeof(*launches));
+    Obj_Thread     *threads  = malloc(numTasks * sizeof(*threads));
+    bool           *started  = calloc(numTasks, sizeof(*started));
+
+    if (!launches || !threads || !started) {
+        FREE(launches);
+        FREE(threads);
+        FREE(started);
+        for (uint32_t i = 0u; i < numTasks; ++i) {
+            task(context, i);
         }
+        return;
     }
-    return OBJ_INVALID_LINE;
-}
-
-static Obj_MeshSizes get_sizes(FILE *fptr) {
-    Obj_MeshSizes sizes = {0u, 0u, 0u, 0u, 0u};
 
-    uint32_t lineNum = 0u;
+    // The calling thread takes the first task, once all the others are launched
+    for (uint32_t i = 1u; i < numTasks; ++i) {
+        launches[i] = (Obj_TaskLaunch) {task, context, i};
+        started[i]  = start_thread(threads + i, launches + i);
+    }
 
-    while (fgets(lineBuff, MAX_LINE_LEN, fptr)) {
-        ++lineNum;
-        Obj_LineType lineType = get_line_type();
-        switch (lineType) {
-            case OBJ_COMMENT:
-                break;
-            case OBJ_VECPOS:
-                ++sizes.nPos;
-                break;
-            case OBJ_VECTEXT:
-                ++sizes.nTex;
-                break;
-            case OBJ_VECNORM:
-                ++sizes.nNorms;
-                break;
-            case OBJ_FACE:
-                ++sizes.nFaces;
+    task(context, 0u);
 
-                // TODO: Assumes there is no double space or trailing spaces before the newline, should make it
-                // more robust
-                for (int i = 0; i < strlen(lineBuff); ++i) {
-                    sizes.flatFacesSize += lineBuff[i] == ' ';
-                }
-                break;
-            case OBJ_INVALID_LINE:
-                fprintf(stderr, "Error: line %d is not recognized:\n > %s", lineNum, lineBuff);
-            // currently unsupported
-            // TODO: extend support to objects and groups first, then materials
-            case OBJ_VECPARAM:
-            case OBJ_LINE:
-            case OBJ_MTLSPEC:
-            case OBJ_MTLUSE:
-            case OBJ_OBJECT:
-            case OBJ_GROUP:
-            case OBJ_SSHADING:
-            default:
-                break;
+    for (uint32_t i = 1u; i < numTasks; ++i) {
+        if (!started[i]) {
+            task(context, i);
+            continue;
         }
+        join_thread(threads[i]);
     }
 
-    return sizes;
+    free(launches);
+    free(threads);
+    free(started);
 }
 
-static bool alloc_mesh_data(Obj_MeshData *data, Obj_MeshSizes sizes) {
-    // Vertex position data
-    data->posX = malloc(sizes.nPos * sizeof(*data->posX));
-    data->posY = malloc(sizes.nPos * sizeof(*data->posY));
-    data->posZ = malloc(sizes.nPos * sizeof(*data->posZ));
-    data->posW = malloc(sizes.nPos * sizeof(*data->posW));
-
-    if (!data->posX || !data->posY || !data->posZ || !data->posW) {
-        fprintf(
-            stderr,
-            "Error reading the wavefront file %s:\n\
-                Failed to allocate memory for the vertex positions",
-            currentPath
-        );
+static bool init_sync(Obj_Mutex *mutex, Obj_Cond *cond) {
+#if defined(_WIN32)
+    InitializeSRWLock(mutex);
+    InitializeConditionVariable(cond);
+    return true;
+#else
+    if (pthread_mutex_init(mutex, NULL) != 0) {
         return false;
     }
-
-    // Vertex normals data
-    data->normX = malloc(sizes.nNorms * sizeof(*data->normX));
-    data->normY = malloc(sizes.nNorms * sizeof(*data->normY));
-    data->normZ = malloc(sizes.nNorms * sizeof(*data->normZ));
-
-    if (!data->normX || !data->normY || !data->normZ) {
-        fprintf(
-            stderr,
-            "Error reading the wavefront file %s:\n\
-                Failed to allocate memory for the vertex normals.",
-            currentPath
-        );
+    if (pthread_cond_init(cond, NULL) != 0) {
+        pthread_mutex_destroy(mutex);
         return false;
     }
+    return true;
+#endif
+}
 
-    // Vertex texture coordinates data
-    data->texU = malloc(sizes.nTex * sizeof(*data->texU));
-    data->texV = malloc(sizes.nTex * sizeof(*data->texV));
-
-    if (!data->texU || !data->texV) {
-        fprintf(
-            stderr,
-            "Error reading the wavefront file %s:\n\
-                Failed to allocate memory for the vertex texture coordinates.",
-            currentPath
-        );
-        return false;
-    }
+static void destroy_sync(Obj_Mutex *mutex, Obj_Cond *cond) {
+#if defined(_WIN32)
+    (void)mutex;
+    (void)cond;
+#else
+    pthread_cond_destroy(cond);
+    pthread_mutex_destroy(mutex);
+#endif
+}
 
-    // Polygon vertices
-    data->faces = malloc(sizes.flatFacesSize * sizeof(*data->faces));
+static void lock_mutex(Obj_Mutex *mutex) {
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
 
-    // Faces offsets in previous 3 datasets
-    data->faceSizes = malloc(sizes.nFaces * sizeof(*data->faceSizes));
-
-    if (!data->faces || !data->faceSizes) {
-        fprintf(
-            stderr,
-            "Error reading the wavefront file %s:\n\
-                Failed to allocate memory for the faces data.",
-            currentPath
-        );
-        return false;
-    }
+static void unlock_mutex(Obj_Mutex *mutex) {
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
 
-    return data;
+static void wait_cond(Obj_Cond *cond, Obj_Mutex *mutex) {
+#if defined(_WIN32)
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
 }
 
-static Obj_FaceType determine_face_type() {
-    //TODO: make this robust to contiguous whitespaces, and make it detect invalid formats
-    int  i = 2;  // ignore 'f' and first space start from first digit
-    char c;
-    bool justParsedSlash = false;
-    bool parsedSlash     = false;
+static void signal_cond(Obj_Cond *cond) {
+#if defined(_WIN32)
+    WakeConditionVariable(cond);
+#else
+    pthread_cond_signal(cond);
+#endif
+}
 
-    while (lineBuff[i] != ' ') {
-        c = lineBuff[i];
-        if (c - '0' < 10) {
-            justParsedSlash = false;
-            continue;
-        } else if (c == '/') {
-            if (justParsedSlash) {
-                return OBJ_POS_AND_NORM;
-            } else if (parsedSlash) {
-                return OBJ_POS_TEX_AND_NORM;
-            }
-            parsedSlash     = true;
-            justParsedSlash = true;
-        }
-        ++i;
+static void broadcast_cond(Obj_Cond *cond) {
+#if defined(_WIN32)
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+/*
+ * Records @error in the errors of the read done by @parser, as long as they have room left. Each
+ * error claims its slot atomically, so this may be called from the worker threads of a chunked
+ * read.
+ */
+static void record_error(Obj_Parser *parser, Obj_Error error) {
+    uint32_t idx = atomic_increment(&parser->numErrors) - 1u;
+    if (idx < parser->errorsCapacity) {
+        parser->errors[idx] = error;
     }
-    return parsedSlash ? OBJ_POS_AND_TEX : OBJ_POS_ONLY;
 }
 
-static uint32_t parse_face(Obj_MeshData *data, uint32_t faceVtxIdx) {
-    // Determine if only pos, pos and norm, pos and text, or all three
-    Obj_FaceType faceType   = determine_face_type();
-    const char  *faceFormat = FACE_INDEX_FORMAT[faceType];
+/*
+ * Reports an error of @code, about no line in particular, of the read done by @parser
+ */
+static void report_error(Obj_Parser *parser, Obj_ErrorCode code) {
+    record_error(parser, (Obj_Error) {code, 0u, 0u});
+}
+
+/*
+ * Reports an error of @code about the line @state is parsing
+ */
+static void report_line_error(Obj_ParseState *state, Obj_ErrorCode code) {
+    ++state->numLineErrors;
+    record_error(state->parser, (Obj_Error) {code, state->lineNum, state->lineOffset});
+}
 
-    uint32_t numVertices = 0u;
-    int32_t  posIdx      = -1;
-    int32_t  normIdx     = -1;
-    int32_t  texIdx      = -1;
+/*
+ * Reports an error of @code about the line @state is parsing, which is skipped. Returns whether
+ * the read goes on past it, as the error policy of the parser decides.
+ */
+static bool skip_line_error(Obj_ParseState *state, Obj_ErrorCode code) {
+    report_line_error(state, code);
 
-    char *intBuff = strtok(lineBuff + 2, " ");
-    while (intBuff) {
-        switch (faceType) {
-            case OBJ_POS_ONLY:
-                sscanf(intBuff, faceFormat, &posIdx);
-                break;
-            case OBJ_POS_AND_TEX:
-                sscanf(intBuff, faceFormat, &posIdx, &texIdx);
-                break;
-            case OBJ_POS_AND_NORM:
-                sscanf(intBuff, faceFormat, &posIdx, &normIdx);
-                break;
-            case OBJ_POS_TEX_AND_NORM:
-                sscanf(intBuff, faceFormat, &posIdx, &texIdx, &normIdx);
-                break;
-            case OBJ_INVALID_FACE:
-            default:
-                fprintf(stderr, "Error parsing face n%d", faceVtxIdx);
-                return 0;
-        }
-        data->faces[faceVtxIdx + numVertices].posIdx  = posIdx;
-        data->faces[faceVtxIdx + numVertices].texIdx  = texIdx;
-        data->faces[faceVtxIdx + numVertices].normIdx = normIdx;
-        ++numVertices;
+    const Obj_ReadOptions *options = &state->parser->options;
+    switch (options->errorPolicy) {
+        case OBJ_ERRORS_FAIL_FAST:
+            return false;
+        case OBJ_ERRORS_FAIL_AT_CAP:
+            return atomic_load(&state->parser->numErrors) < options->maxErrors;
+        case OBJ_ERRORS_SKIP:
+        default:
+            return true;
     }
-    return numVertices;
 }
 
-static Obj_MeshData try_get_data(FILE *fptr, Obj_MeshSizes sizes, bool *successfulRead) {
-    Obj_MeshData data;
-    alloc_mesh_data(&data, sizes);
+/*
+ * Clears the errors of @parser before a read, allocating the room for them on its first read. A
+ * parser which cannot allocate it still counts its errors, without recording any.
+ */
+static void reset_errors(Obj_Parser *parser) {
+    parser->numErrors = 0u;
+    if (!parser->errors) {
+        parser->errors         = malloc(parser->options.maxErrors * sizeof(*parser->errors));
+        parser->errorsCapacity = parser->errors ? parser->options.maxErrors : 0u;
+    }
+}
 
-    uint32_t posIdx  = 0u;
-    uint32_t normIdx = 0u;
-    uint32_t textIdx = 0u;
+/*
+ * Returns the number of errors @parser recorded, which is less than the number it counted past
+ * its capacity
+ */
+static uint32_t num_recorded_errors(const Obj_Parser *parser) {
+    return parser->numErrors < parser->errorsCapacity ? parser->numErrors : parser->errorsCapacity;
+}
 
-    uint32_t faceVtxIdx  = 0u;
-    uint32_t faceIdx     = 0u;
-    uint32_t numVertices = 0u;
+/*
+ * Sorts errors in file order, leaving the errors about no line in particular last
+ */
+static int compare_errors(const void *a, const void *b) {
+    const Obj_Error *aError  = a;
+    const Obj_Error *bError  = b;
+    uint64_t         aOffset = aError->line ? aError->offset : UINT64_MAX;
+    uint64_t         bOffset = bError->line ? bError->offset : UINT64_MAX;
+    if (aOffset != bOffset) {
+        return (aOffset > bOffset) - (aOffset < bOffset);
+    }
+    return (aError->code > bError->code) - (aError->code < bError->code);
+}
 
-    uint32_t lineNum = 0u;
+/*
+ * Sorts the errors recorded by the read of @parser, which the worker threads of a chunked read
+ * record in no particular order, and returns the first one. Errors a parser had no room to record
+ * are reported as running out of memory.
+ */
+static Obj_Error finish_errors(Obj_Parser *parser) {
+    uint32_t count = num_recorded_errors(parser);
+    if (count == 0u) {
+        return (Obj_Error) {parser->numErrors ? OBJ_ERROR_OUT_OF_MEMORY : OBJ_ERROR_NONE, 0u, 0u};
+    }
+    qsort(parser->errors, count, sizeof(*parser->errors), compare_errors);
+    return parser->errors[0];
+}
 
-    while (fgets(lineBuff, MAX_LINE_LEN, fptr)) {
-        ++lineNum;
-        switch (get_line_type()) {
-            case OBJ_VECPOS:
-                if (sscanf(
-                        lineBuff,
-                        "v %f %f %f",
-                        data.posX + posIdx,
-                        data.posY + posIdx,
-                        data.posZ + posIdx
-                    )) {
-                    data.posW[posIdx] = 1.0f;
-                    ++posIdx;
-                } else if (sscanf(
-                               lineBuff,
-                               "v %f %f %f %f",
-                               data.posX + posIdx,
-                               data.posY + posIdx,
-                               data.posZ + posIdx,
-                               data.posW + posIdx
-                           )) {
-                    ++posIdx;
-                } else {
-                    fprintf(
-                        stderr,
-                        "Error, line %d, vector position line in invalid format:\n > %s",
-                        lineNum,
-                        lineBuff
-                    );
-                    return data;
-                }
-                break;
-            case OBJ_VECNORM:
-                if (sscanf(
-                        lineBuff,
-                        "vn %f %f %f",
-                        data.normX + normIdx,
-                        data.normY + normIdx,
-                        data.normZ + normIdx
-                    )) {
-                    ++normIdx;
-                } else {
-                    fprintf(
-                        stderr,
-                        "Error, line %d, vector normal line in invalid format:\n > %s",
-                        lineNum,
-                        lineBuff
-                    );
-                    return data;
-                }
-                break;
-            case OBJ_VECTEXT:
-                if (sscanf(lineBuff, "vt %f %f", data.texU + textIdx, data.texV + textIdx)) {
-                    ++textIdx;
-                } else {
-                    fprintf(
-                        stderr,
-                        "Error, line %d, vector texture coordinates line in invalid format:\n > %s",
-                        lineNum,
-                        lineBuff
-                    );
-                    return data;
-                }
-                break;
-            case OBJ_FACE:
-                numVertices = parse_face(&data, faceVtxIdx);
-
-                if (numVertices < 3) {
-                    fprintf(
-                        stderr,
-                        "Error, obj file %s contains a face with fewer than 3 vertices",
-                        currentPath
-                    );
-                }
-                data.faceSizes[faceIdx++] = numVertices;
-                faceVtxIdx += numVertices;
-                break;
+/*
+ * Drops the errors @parser recorded about the lines at @offset and past it, which were reported by
+ * chunks a single-threaded read stops before, and takes the @numDropped errors they counted off its
+ * count. The errors which the dropped ones took the room of are lost, and reported as running out
+ * of memory instead.
+ */
+static void drop_errors_past(Obj_Parser *parser, uint64_t offset, uint32_t numDropped) {
+    uint32_t count = num_recorded_errors(parser);
+    uint32_t kept  = 0u;
+    for (uint32_t i = 0u; i < count; ++i) {
+        if (!parser->errors[i].line || parser->errors[i].offset < offset) {
+            parser->errors[kept++] = parser->errors[i];
+        }
+    }
+    parser->numErrors -= numDropped;
+    for (uint32_t i = kept; i < num_recorded_errors(parser); ++i) {
+        parser->errors[i] = (Obj_Error) {OBJ_ERROR_OUT_OF_MEMORY, 0u, 0u};
+    }
+}
 
-            case OBJ_COMMENT:
-            case OBJ_VECPARAM:
-            case OBJ_LINE:
-            case OBJ_MTLSPEC:
-            case OBJ_MTLUSE:
-            case OBJ_OBJECT:
-            case OBJ_GROUP:
-            case OBJ_SSHADING:
-            case OBJ_INVALID_LINE:
-            default:
-                break;
+static uint32_t strlen_s(const char *s) {
+    static const uint32_t MAX_LEN = (uint32_t)0xffffffff;
+    for (uint32_t i = 0; i < MAX_LEN; ++i) {
+        if (!*s) {
+            return i;
         }
+        ++s;
     }
-    *successfulRead = true;
-    return data;
+    return MAX_LEN;
 }
 
-/**************************************************************************************************
- * Public methods
- *************************************************************************************************/
+static double get_seconds(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+#endif
+}
 
-void obj_free(Obj_Mesh *mesh) {
-    FREE(mesh->data.posX);
-    FREE(mesh->data.posY);
-    FREE(mesh->data.posZ);
-    FREE(mesh->data.posW);
-    FREE(mesh->data.normX);
-    FREE(mesh->data.normY);
-    FREE(mesh->data.normZ);
-    FREE(mesh->data.texU);
-    FREE(mesh->data.texV);
-    FREE(mesh->data.faces);
-    FREE(mesh->data.faceSizes);
+/*
+ * Starts timing a phase of a read, which only reads the clock when stats are collected
+ */
+static double start_timer(const Obj_Parser *parser) {
+    return parser->options.stats ? get_seconds() : 0.0;
 }
 
-Obj_Return obj_read(const char *path) {
-    // TODO: sanitise path (trim if too long and remove %p and other known attacks)
-    currentPath = path;
+/*
+ * Returns the time elapsed since @start, or 0 when stats are not collected
+ */
+static double stop_timer(const Obj_Parser *parser, double start) {
+    return parser->options.stats ? get_seconds() - start : 0.0;
+}
 
-    Obj_Mesh mesh = {};
+/*
+ * Counts a parsed line of @type in @stats
+ */
+static void count_line_stats(Obj_Stats *stats, Obj_LineType type) {
+    if (type == OBJ_INVALID_LINE) {
+        ++stats->numInvalidLines;
+    } else {
+        ++stats->numLines[type];
+    }
+}
 
-    FILE *fptr;
-    if (!try_open_obj(&fptr)) {
-        return (Obj_Return) {false, mesh};
+static void merge_line_stats(Obj_Stats *stats, const Obj_Stats *other) {
+    for (uint32_t i = 0u; i < OBJ_NUM_LINE_TYPES; ++i) {
+        stats->numLines[i] += other->numLines[i];
     }
+    stats->numInvalidLines += other->numInvalidLines;
+}
 
-    fprintf(stdout, "Opened obj file %s for reading\n", currentPath);
+static bool str_endswith(const char *s, const char *suff) {
+    uint32_t sLen    = strlen_s(s);
+    uint32_t suffLen = strlen_s(suff);
 
-    mesh.sizes = get_sizes(fptr);
-    rewind(fptr);
+    return (sLen >= suffLen && strncmp(s + sLen - suffLen, suff, suffLen) == 0);
+}
 
-    bool successfulRead = false;
+static bool is_obj_path(Obj_Parser *parser) {
+    if (!str_endswith(parser->path, ".obj") && !str_endswith(parser->path, ".OBJ")) {
+        report_error(parser, OBJ_ERROR_NOT_OBJ_FILE);
+        return false;
+    }
+    return true;
+}
 
-    mesh.data = try_get_data(fptr, mesh.sizes, &successfulRead);
-    fclose(fptr);
-    if (!successfulRead) {
-        fprintf(stderr, "Error while reading the obj file, aborting the operation.");
+static bool try_open_obj(Obj_Parser *parser, FILE **fptr_p) {
+    if (!is_obj_path(parser)) {
+        return false;
     }
 
-    return (Obj_Return) {successfulRead, mesh};
+    // Check from path whether the file is indeed Wavefront format
+
+    *fptr_p = fopen(parser->path, "r");
+
+    if (!*fptr_p) {
+        report_error(parser, OBJ_ERROR_OPEN_FAILED);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Maps the whole file of @parser in memory. Writing to a @copyOnWrite mapping modifies private
+ * copies of the pages written, and never the file. An empty file yields an empty, NULL mapping.
+ */
+static bool map_file(Obj_Parser *parser, Obj_FileMapping *mapping, bool copyOnWrite) {
+    *mapping = (Obj_FileMapping) {};
+
+#if defined(_WIN32)
+    mapping->file = CreateFileA(
+        parser->path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL
+    );
+    if (mapping->file == INVALID_HANDLE_VALUE) {
+        report_error(parser, OBJ_ERROR_OPEN_FAILED);
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(mapping->file, &fileSize)) {
+        report_error(parser, OBJ_ERROR_OPEN_FAILED);
+        CloseHandle(mapping->file);
+        return false;
+    }
+    mapping->size = (size_t)fileSize.QuadPart;
+
+    if (mapping->size > 0u) {
+        DWORD protection = copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY;
+        DWORD access     = copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ;
+        mapping->view    = CreateFileMappingA(mapping->file, NULL, protection, 0, 0, NULL);
+        mapping->data    = mapping->view ? MapViewOfFile(mapping->view, access, 0, 0, 0) : NULL;
+        if (!mapping->data) {
+            report_error(parser, OBJ_ERROR_OPEN_FAILED);
+            if (mapping->view) {
+                CloseHandle(mapping->view);
+            }
+            CloseHandle(mapping->file);
+            return false;
+        }
+    }
+#else
+    int fd = open(parser->path, O_RDONLY);
+    if (fd < 0) {
+        report_error(parser, OBJ_ERROR_OPEN_FAILED);
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        report_error(parser, OBJ_ERROR_OPEN_FAILED);
+        close(fd);
+        return false;
+    }
+    mapping->size = (size_t)fileStat.st_size;
+
+    if (mapping->size > 0u) {
+        int   protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *data       = mmap(NULL, mapping->size, protection, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            report_error(parser, OBJ_ERROR_OPEN_FAILED);
+            close(fd);
+            return false;
+        }
+        posix_madvise(data, mapping->size, POSIX_MADV_SEQUENTIAL);
+        mapping->data = data;
+    }
+    // The mapping stays valid once the descriptor is closed
+    close(fd);
+#endif
+
+    return true;
+}
+
+static bool try_map_obj(Obj_Parser *parser, Obj_FileMapping *mapping) {
+    *mapping = (Obj_FileMapping) {};
+    return is_obj_path(parser) && map_file(parser, mapping, false);
+}
+
+/*
+ * Returns the size of the file at @path, or 0 when it cannot be queried
+ */
+static uint64_t get_file_size(const char *path) {
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes)) {
+        return 0u;
+    }
+    return ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+#else
+    struct stat fileStat;
+    return stat(path, &fileStat) == 0 ? (uint64_t)fileStat.st_size : 0u;
+#endif
+}
+
+/*
+ * Gets the size of the file at @path and the time it was last modified, at the full resolution of
+ * the platform, so that writes within the same second still tell apart
+ */
+static bool get_file_stamp(const char *path, Obj_FileStamp *stamp) {
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes)) {
+        return false;
+    }
+    FILETIME writeTime = attributes.ftLastWriteTime;
+    stamp->size        = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+    stamp->time        = ((uint64_t)writeTime.dwHighDateTime << 32) | writeTime.dwLowDateTime;
+    return true;
+#else
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0) {
+        return false;
+    }
+    #if defined(__APPLE__)
+    uint64_t nanoseconds = (uint64_t)fileStat.st_mtimensec;
+    #else
+    uint64_t nanoseconds = (uint64_t)fileStat.st_mtim.tv_nsec;
+    #endif
+    stamp->size = (uint64_t)fileStat.st_size;
+    stamp->time = (uint64_t)fileStat.st_mtime * UINT64_C(1000000000) + nanoseconds;
+    return true;
+#endif
+}
+
+/*
+ * Whether the stamps @a and @b were taken of a file in the same state
+ */
+static bool same_file_stamp(const Obj_FileStamp *a, const Obj_FileStamp *b) {
+    return a->size == b->size && a->time == b->time;
+}
+
+/*
+ * Moves the position of @file to @offset bytes from its start
+ */
+static bool seek_file(FILE *file, uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+/*
+ * Releases the handles of @mapping while keeping its view, which stays valid until unmap_view is
+ * called on it. Returns the mapped data.
+ */
+static void *detach_mapping(Obj_FileMapping *mapping) {
+    void *data = (void *)mapping->data;
+#if defined(_WIN32)
+    if (mapping->data) {
+        CloseHandle(mapping->view);
+    }
+    CloseHandle(mapping->file);
+#endif
+    *mapping = (Obj_FileMapping) {};
+    return data;
+}
+
+static void unmap_view(void *data, size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+static void unmap_obj(Obj_FileMapping *mapping) {
+#if defined(_WIN32)
+    if (mapping->data) {
+        UnmapViewOfFile(mapping->data);
+        CloseHandle(mapping->view);
+    }
+    CloseHandle(mapping->file);
+#else
+    if (mapping->data) {
+        munmap((void *)mapping->data, mapping->size);
+    }
+#endif
+    *mapping = (Obj_FileMapping) {};
+}
+
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *skip_blanks(const char *c, const char *end) {
+    while (c < end && is_blank(*c)) {
+        ++c;
+    }
+    return c;
+}
+
+/*
+ * Classifies the line [line, end). Here and in all the line parsing helpers below, @end points to
+ * the character right after the line, which is either its newline or a null terminator.
+ * Keywords may be followed by any blank, and blank lines are classified as comments.
+ */
+static Obj_LineType get_line_type(const char *line, const char *end) {
+    if (line == end) {
+        return OBJ_COMMENT;  // empty lines carry no data, just like comments
+    }
+
+    // The first one or two characters single out the only keyword the line may start with
+    Obj_LineType type;
+    switch (line[0]) {
+        case '#':
+            return OBJ_COMMENT;
+        case ' ':
+        case '\t':
+        case '\r':
+            return skip_blanks(line, end) == end ? OBJ_COMMENT : OBJ_INVALID_LINE;
+        case 'v':
+            switch (end - line > 1 ? line[1] : '\0') {
+                case 't':
+                    type = OBJ_VECTEXT;
+                    break;
+                case 'n':
+                    type = OBJ_VECNORM;
+                    break;
+                case 'p':
+                    type = OBJ_VECPARAM;
+                    break;
+                default:
+                    type = OBJ_VECPOS;
+                    break;
+            }
+            break;
+        case 'f':
+            type = OBJ_FACE;
+            break;
+        case 'l':
+            type = OBJ_LINE;
+            break;
+        case 'm':
+            type = OBJ_MTLSPEC;
+            break;
+        case 'u':
+            type = OBJ_MTLUSE;
+            break;
+        case 'o':
+            type = OBJ_OBJECT;
+            break;
+        case 'g':
+            type = OBJ_GROUP;
+            break;
+        case 's':
+            type = OBJ_SSHADING;
+            break;
+        default:
+            return OBJ_INVALID_LINE;
+    }
+
+    const Obj_LineSpec *spec = LINE_SPEC + type;
+    if ((size_t)(end - line) <= spec->len || !is_blank(line[spec->len])
+        || memcmp(line, spec->keyword, spec->len) != 0) {
+        return OBJ_INVALID_LINE;
+    }
+    return type;
+}
+
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+static uint32_t popcount(uint32_t bits) {
+    #if defined(__GNUC__)
+    return (uint32_t)__builtin_popcount(bits);
+    #else
+    bits = bits - ((bits >> 1) & 0x55555555u);
+    bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0fu;
+    return (bits * 0x01010101u) >> 24;
+    #endif
+}
+
+/*
+ * Returns the mask of the blank characters among the SIMD_WIDTH ones starting at @c, with the
+ * first character in the lowest bit
+ */
+static uint32_t blank_mask(const char *c) {
+    #if defined(SIMD_AVX2)
+    __m256i chars  = _mm256_loadu_si256((const __m256i *)c);
+    __m256i blanks = _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),
+            _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t'))
+        ),
+        _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r'))
+    );
+    return (uint32_t)_mm256_movemask_epi8(blanks);
+    #else
+    __m128i chars  = _mm_loadu_si128((const __m128i *)c);
+    __m128i blanks = _mm_or_si128(
+        _mm_or_si128(
+            _mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+            _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))
+        ),
+        _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r'))
+    );
+    return (uint32_t)_mm_movemask_epi8(blanks);
+    #endif
+}
+#endif
+
+/*
+ * Counts the blank separated vertices of the face line [line, end), as the number of characters
+ * which start a token. The leading 'f' is followed by a blank, so it is not counted. Long lines
+ * are classified SIMD_WIDTH characters at a time, where vector extensions are available.
+ */
+static uint32_t count_face_vertices(const char *line, const char *end) {
+    uint32_t    numVertices = 0u;
+    bool        afterBlank  = false;
+    const char *c           = line;
+
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2)
+    const uint32_t laneMask  = UINT32_MAX >> (32 - SIMD_WIDTH);
+    uint32_t       prevBlank = 0u;
+    for (; end - c >= SIMD_WIDTH; c += SIMD_WIDTH) {
+        uint32_t blanks = blank_mask(c);
+        numVertices += popcount(~blanks & ((blanks << 1) | prevBlank) & laneMask);
+        prevBlank = (blanks >> (SIMD_WIDTH - 1)) & 1u;
+    }
+    afterBlank = prevBlank;
+#elif defined(SIMD_NEON)
+    uint8x16_t prevBlanks = vdupq_n_u8(0u);
+    for (; end - c >= SIMD_WIDTH; c += SIMD_WIDTH) {
+        uint8x16_t chars  = vld1q_u8((const uint8_t *)c);
+        uint8x16_t blanks = vorrq_u8(
+            vorrq_u8(vceqq_u8(chars, vdupq_n_u8(' ')), vceqq_u8(chars, vdupq_n_u8('\t'))),
+            vceqq_u8(chars, vdupq_n_u8('\r'))
+        );
+        // Lane i of afterBlanks tells whether character i - 1 is blank
+        uint8x16_t afterBlanks = vextq_u8(prevBlanks, blanks, SIMD_WIDTH - 1);
+        numVertices += vaddvq_u8(vshrq_n_u8(vbicq_u8(afterBlanks, blanks), 7));
+        prevBlanks = blanks;
+    }
+    afterBlank = vgetq_lane_u8(prevBlanks, SIMD_WIDTH - 1) != 0u;
+#endif
+
+    for (; c < end; ++c) {
+        bool blank = is_blank(*c);
+        numVertices += afterBlank && !blank;
+        afterBlank = blank;
+    }
+    return numVertices;
+}
+
+/*
+ * Counts the elements of a line of @type into @sizes, leaving out the streams skipped by @loadFlags
+ */
+static void count_line(
+    Obj_MeshSizes *sizes,
+    Obj_LineType   type,
+    const char    *line,
+    const char    *end,
+    uint32_t       loadFlags
+) {
+    switch (type) {
+        case OBJ_COMMENT:
+            break;
+        case OBJ_VECPOS:
+            ++sizes->nPos;
+            break;
+        case OBJ_VECTEXT:
+            sizes->nTex += !(loadFlags & OBJ_LOAD_SKIP_TEXCOORDS);
+            break;
+        case OBJ_VECNORM:
+            sizes->nNorms += !(loadFlags & OBJ_LOAD_SKIP_NORMALS);
+            break;
+        case OBJ_FACE:
+            if (loadFlags & OBJ_LOAD_SKIP_FACES) {
+                break;
+            }
+            ++sizes->nFaces;
+            sizes->flatFacesSize += count_face_vertices(line, end);
+            break;
+        // Lines holding no elements, statements only being counted as ranges once parsed
+        case OBJ_INVALID_LINE:
+        case OBJ_VECPARAM:
+        case OBJ_LINE:
+        case OBJ_MTLSPEC:
+        case OBJ_MTLUSE:
+        case OBJ_OBJECT:
+        case OBJ_GROUP:
+        case OBJ_SSHADING:
+        default:
+            break;
+    }
+}
+
+/*
+ * Counts the mesh elements in the [begin, end) buffer, along with its number of lines if @numLines
+ * is not NULL.
+ */
+static Obj_MeshSizes get_sizes_from_buffer(
+    const char *begin,
+    const char *end,
+    uint32_t    loadFlags,
+    uint32_t   *numLines
+) {
+    Obj_MeshSizes sizes = {0u, 0u, 0u, 0u, 0u};
+
+    uint32_t lineNum = 0u;
+
+    for (const char *line = begin; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        ++lineNum;
+        count_line(&sizes, get_line_type(line, lineEnd), line, lineEnd, loadFlags);
+        line = lineEnd + 1;
+    }
+
+    if (numLines) {
+        *numLines = lineNum;
+    }
+    return sizes;
+}
+
+static Obj_MeshSizes add_sizes(Obj_MeshSizes a, Obj_MeshSizes b) {
+    return (Obj_MeshSizes) {
+        .nPos          = a.nPos + b.nPos,
+        .nNorms        = a.nNorms + b.nNorms,
+        .nTex          = a.nTex + b.nTex,
+        .nFaces        = a.nFaces + b.nFaces,
+        .flatFacesSize = a.flatFacesSize + b.flatFacesSize,
+    };
+}
+
+static Obj_MeshSizes sub_sizes(Obj_MeshSizes a, Obj_MeshSizes b) {
+    return (Obj_MeshSizes) {
+        .nPos          = a.nPos - b.nPos,
+        .nNorms        = a.nNorms - b.nNorms,
+        .nTex          = a.nTex - b.nTex,
+        .nFaces        = a.nFaces - b.nFaces,
+        .flatFacesSize = a.flatFacesSize - b.flatFacesSize,
+    };
+}
+
+/*
+ * Gets the arrays of @data holding the attribute of @type, which are quantized ones when
+ * @quantizeFlags asks for it
+ */
+static Obj_ComponentArrays get_component_arrays(
+    Obj_MeshData *data,
+    Obj_LineType  type,
+    uint32_t      quantizeFlags
+) {
+    Obj_QuantizedData *q = &data->quantized;
+    switch (type) {
+        case OBJ_VECPOS:
+            if (quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+                return (Obj_ComponentArrays) {
+                    {(void **)&q->posX, (void **)&q->posY, (void **)&q->posZ},
+                    3u,
+                    sizeof(uint16_t),
+                };
+            }
+            return (Obj_ComponentArrays) {
+                {(void **)&data->posX, (void **)&data->posY, (void **)&data->posZ},
+                3u,
+                sizeof(float),
+            };
+        case OBJ_VECNORM:
+            if (quantizeFlags & OBJ_QUANTIZE_NORMALS) {
+                return (Obj_ComponentArrays) {
+                    {(void **)&q->normX, (void **)&q->normY, (void **)&q->normZ},
+                    3u,
+                    sizeof(uint16_t),
+                };
+            }
+            return (Obj_ComponentArrays) {
+                {(void **)&data->normX, (void **)&data->normY, (void **)&data->normZ},
+                3u,
+                sizeof(float),
+            };
+        default:
+            if (quantizeFlags & OBJ_QUANTIZE_TEXCOORDS) {
+                return (Obj_ComponentArrays) {
+                    {(void **)&q->texU, (void **)&q->texV, NULL},
+                    2u,
+                    sizeof(uint16_t),
+                };
+            }
+            return (Obj_ComponentArrays) {
+                {(void **)&data->texU, (void **)&data->texV, NULL},
+                2u,
+                sizeof(float),
+            };
+    }
+}
+
+static void *mem_allocate(const Obj_Allocator *allocator, size_t size, size_t alignment) {
+    if (allocator->allocate) {
+        return allocator->allocate(size, alignment, allocator->userData);
+    }
+    return malloc(size);
+}
+
+static void mem_deallocate(const Obj_Allocator *allocator, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    if (allocator->allocate) {
+        if (allocator->deallocate) {
+            allocator->deallocate(ptr, allocator->userData);
+        }
+    } else {
+        free(ptr);
+    }
+}
+
+/*
+ * Resizes @array from @oldCount to @count elements, keeping its content. Custom allocators have no
+ * reallocation hook, so the array is then moved to a new allocation.
+ */
+static bool resize_array(
+    const Obj_Allocator *allocator,
+    void               **array,
+    uint32_t             oldCount,
+    uint32_t             count,
+    size_t               elemSize
+) {
+    if (count == 0u) {
+        mem_deallocate(allocator, *array);
+        *array = NULL;
+        return true;
+    }
+
+    if (!allocator->allocate) {
+        void *resized = realloc(*array, (size_t)count * elemSize);
+        if (!resized) {
+            return false;
+        }
+        *array = resized;
+        return true;
+    }
+
+    void *resized = mem_allocate(allocator, (size_t)count * elemSize, ARRAY_ALIGNMENT);
+    if (!resized) {
+        return false;
+    }
+    if (*array) {
+        memcpy(resized, *array, (size_t)(oldCount < count ? oldCount : count) * elemSize);
+        mem_deallocate(allocator, *array);
+    }
+    *array = resized;
+    return true;
+}
+
+static bool resize_components(
+    const Obj_Allocator *allocator,
+    Obj_ComponentArrays  components,
+    uint32_t             oldCount,
+    uint32_t             count
+) {
+    for (uint32_t i = 0u; i < components.numArrays; ++i) {
+        if (!resize_array(allocator, components.arrays[i], oldCount, count, components.elemSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t align_block_size(size_t size) {
+    return (size + BLOCK_ALIGNMENT - 1u) & ~(size_t)(BLOCK_ALIGNMENT - 1u);
+}
+
+static size_t mesh_block_size(Obj_MeshSizes sizes, bool loadPosW, uint32_t quantizeFlags) {
+    size_t posSize  = quantizeFlags & OBJ_QUANTIZE_POSITIONS ? sizeof(uint16_t) : sizeof(float);
+    size_t normSize = quantizeFlags & OBJ_QUANTIZE_NORMALS ? sizeof(uint16_t) : sizeof(float);
+    size_t texSize  = quantizeFlags & OBJ_QUANTIZE_TEXCOORDS ? sizeof(uint16_t) : sizeof(float);
+    return 3u * align_block_size(sizes.nPos * posSize)
+         + (loadPosW ? align_block_size(sizes.nPos * sizeof(float)) : 0u)
+         + 3u * align_block_size(sizes.nNorms * normSize)
+         + 2u * align_block_size(sizes.nTex * texSize)
+         + align_block_size(sizes.flatFacesSize * sizeof(Obj_VertIdx))
+         + align_block_size(sizes.nFaces * sizeof(uint32_t));
+}
+
+/*
+ * Records that @allocated bytes were allocated and then @freed bytes released, in the count at
+ * @heldBytes, which is either the mesh or the buffer bytes of @parser
+ */
+static void track_bytes(Obj_Parser *parser, size_t *heldBytes, size_t allocated, size_t freed) {
+    *heldBytes += allocated;
+
+    size_t total = parser->meshBytes + parser->bufferBytes;
+    if (total > parser->stats.peakBytes) {
+        parser->stats.peakBytes = total;
+    }
+    *heldBytes -= freed < *heldBytes ? freed : *heldBytes;
+}
+
+/*
+ * Records that the mesh arrays grew from @oldCapacity to @newCapacity elements
+ */
+static void track_mesh_capacity(
+    Obj_Parser   *parser,
+    Obj_MeshSizes oldCapacity,
+    Obj_MeshSizes newCapacity
+) {
+    bool     loadPosW      = !(parser->options.loadFlags & OBJ_LOAD_SKIP_POSW);
+    uint32_t quantizeFlags = parser->options.quantizeFlags;
+    track_bytes(
+        parser,
+        &parser->meshBytes,
+        mesh_block_size(newCapacity, loadPosW, quantizeFlags),
+        mesh_block_size(oldCapacity, loadPosW, quantizeFlags)
+    );
+}
+
+static uint32_t grown_capacity(uint32_t capacity, uint32_t needed) {
+    // Grow geometrically so that single pass reads only reallocate a logarithmic number of times
+    uint32_t doubled = capacity > UINT32_MAX / 2u ? UINT32_MAX : capacity * 2u;
+    return doubled > needed ? doubled : needed;
+}
+
+/*
+ * Ensures the mesh arrays can hold at least the @needed number of elements, updating @capacity
+ * accordingly. When starting from an empty capacity, the arrays are allocated with the exact needed
+ * sizes, so the two pass read path does not over-allocate.
+ */
+static bool reserve_mesh_data(
+    Obj_Parser    *parser,
+    Obj_MeshData  *data,
+    Obj_MeshSizes *capacity,
+    Obj_MeshSizes  needed
+) {
+    const Obj_Allocator *allocator     = &parser->options.allocator;
+    bool                 loadPosW      = !(parser->options.loadFlags & OBJ_LOAD_SKIP_POSW);
+    uint32_t             quantizeFlags = parser->options.quantizeFlags;
+    Obj_MeshSizes        oldCapacity   = *capacity;
+
+    // Vertex position data
+    if (needed.nPos > capacity->nPos) {
+        uint32_t            oldCap = capacity->nPos;
+        uint32_t            newCap = grown_capacity(oldCap, needed.nPos);
+        Obj_ComponentArrays pos    = get_component_arrays(data, OBJ_VECPOS, quantizeFlags);
+        if (!resize_components(allocator, pos, oldCap, newCap)
+            || (loadPosW
+                && !resize_array(allocator, (void **)&data->posW, oldCap, newCap, sizeof(float)))) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        capacity->nPos = newCap;
+    }
+
+    // Vertex normals data
+    if (needed.nNorms > capacity->nNorms) {
+        uint32_t            oldCap = capacity->nNorms;
+        uint32_t            newCap = grown_capacity(oldCap, needed.nNorms);
+        Obj_ComponentArrays norm   = get_component_arrays(data, OBJ_VECNORM, quantizeFlags);
+        if (!resize_components(allocator, norm, oldCap, newCap)) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        capacity->nNorms = newCap;
+    }
+
+    // Vertex texture coordinates data
+    if (needed.nTex > capacity->nTex) {
+        uint32_t            oldCap = capacity->nTex;
+        uint32_t            newCap = grown_capacity(oldCap, needed.nTex);
+        Obj_ComponentArrays tex    = get_component_arrays(data, OBJ_VECTEXT, quantizeFlags);
+        if (!resize_components(allocator, tex, oldCap, newCap)) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        capacity->nTex = newCap;
+    }
+
+    // Polygon vertices
+    if (needed.flatFacesSize > capacity->flatFacesSize) {
+        uint32_t oldCap = capacity->flatFacesSize;
+        uint32_t newCap = grown_capacity(oldCap, needed.flatFacesSize);
+        if (!resize_array(allocator, (void **)&data->faces, oldCap, newCap, sizeof(Obj_VertIdx))) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        capacity->flatFacesSize = newCap;
+    }
+
+    // Faces offsets in previous 3 datasets
+    if (needed.nFaces > capacity->nFaces) {
+        uint32_t oldCap = capacity->nFaces;
+        uint32_t newCap = grown_capacity(oldCap, needed.nFaces);
+        if (!resize_array(
+                allocator,
+                (void **)&data->faceSizes,
+                oldCap,
+                newCap,
+                sizeof(*data->faceSizes)
+            )) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        capacity->nFaces = newCap;
+    }
+
+    track_mesh_capacity(parser, oldCapacity, *capacity);
+    return true;
+}
+
+/*
+ * Trims the mesh arrays down to the number of elements actually read
+ */
+static void shrink_mesh_data(Obj_Parser *parser, Obj_MeshData *data, Obj_MeshSizes sizes) {
+    const Obj_Allocator *allocator = &parser->options.allocator;
+
+    // Shrinking never fails in practice, and leaving an array untouched when it does is harmless
+    resize_array(allocator, (void **)&data->posX, sizes.nPos, sizes.nPos, sizeof(*data->posX));
+    resize_array(allocator, (void **)&data->posY, sizes.nPos, sizes.nPos, sizeof(*data->posY));
+    resize_array(allocator, (void **)&data->posZ, sizes.nPos, sizes.nPos, sizeof(*data->posZ));
+    if (data->posW) {
+        resize_array(allocator, (void **)&data->posW, sizes.nPos, sizes.nPos, sizeof(*data->posW));
+    }
+    resize_array(
+        allocator,
+        (void **)&data->normX,
+        sizes.nNorms,
+        sizes.nNorms,
+        sizeof(*data->normX)
+    );
+    resize_array(
+        allocator,
+        (void **)&data->normY,
+        sizes.nNorms,
+        sizes.nNorms,
+        sizeof(*data->normY)
+    );
+    resize_array(
+        allocator,
+        (void **)&data->normZ,
+        sizes.nNorms,
+        sizes.nNorms,
+        sizeof(*data->normZ)
+    );
+    resize_array(allocator, (void **)&data->texU, sizes.nTex, sizes.nTex, sizeof(*data->texU));
+    resize_array(allocator, (void **)&data->texV, sizes.nTex, sizes.nTex, sizeof(*data->texV));
+    resize_array(
+        allocator,
+        (void **)&data->faces,
+        sizes.flatFacesSize,
+        sizes.flatFacesSize,
+        sizeof(*data->faces)
+    );
+    resize_array(
+        allocator,
+        (void **)&data->faceSizes,
+        sizes.nFaces,
+        sizes.nFaces,
+        sizeof(*data->faceSizes)
+    );
+
+    bool   loadPosW = !(parser->options.loadFlags & OBJ_LOAD_SKIP_POSW);
+    size_t trimmed  = mesh_block_size(sizes, loadPosW, parser->options.quantizeFlags);
+    track_bytes(parser, &parser->meshBytes, 0u, parser->meshBytes - trimmed);
+}
+
+/*
+ * Takes the next @size bytes of a block at @cursor, keeping the following array aligned
+ */
+static void *take_block_bytes(char **cursor, size_t size) {
+    if (size == 0u) {
+        return NULL;
+    }
+    void *bytes = *cursor;
+    *cursor += align_block_size(size);
+    return bytes;
+}
+
+/*
+ * Points the mesh arrays at consecutive, aligned ranges of the block starting at @cursor, which
+ * must be mesh_block_size bytes long
+ */
+static void carve_components(char **cursor, Obj_ComponentArrays components, uint32_t count) {
+    for (uint32_t i = 0u; i < components.numArrays; ++i) {
+        *components.arrays[i] = take_block_bytes(cursor, count * components.elemSize);
+    }
+}
+
+static void carve_mesh_block(
+    char          *cursor,
+    Obj_MeshSizes  sizes,
+    bool           loadPosW,
+    uint32_t       quantizeFlags,
+    Obj_MeshData  *data
+) {
+    carve_components(&cursor, get_component_arrays(data, OBJ_VECPOS, quantizeFlags), sizes.nPos);
+    data->posW = take_block_bytes(&cursor, loadPosW ? sizes.nPos * sizeof(*data->posW) : 0u);
+    carve_components(&cursor, get_component_arrays(data, OBJ_VECNORM, quantizeFlags), sizes.nNorms);
+    carve_components(&cursor, get_component_arrays(data, OBJ_VECTEXT, quantizeFlags), sizes.nTex);
+    data->faces     = take_block_bytes(&cursor, sizes.flatFacesSize * sizeof(*data->faces));
+    data->faceSizes = take_block_bytes(&cursor, sizes.nFaces * sizeof(*data->faceSizes));
+}
+
+/*
+ * Size of the block holding the face range arrays, for the counts held by @ranges
+ */
+static size_t face_ranges_size(const Obj_FaceRanges *ranges) {
+    size_t size = 0u;
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        size += align_block_size(ranges->numRanges[kind] * sizeof(**ranges->ranges));
+    }
+    return size + align_block_size(ranges->numNames * sizeof(*ranges->nameOffsets))
+         + align_block_size(ranges->namesSize);
+}
+
+/*
+ * Points the face range arrays at consecutive ranges of the block starting at @cursor, which must
+ * be face_ranges_size bytes long
+ */
+static void carve_face_ranges(char *cursor, Obj_FaceRanges *ranges) {
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        size_t size          = ranges->numRanges[kind] * sizeof(**ranges->ranges);
+        ranges->ranges[kind] = take_block_bytes(&cursor, size);
+    }
+    size_t offsetsSize  = ranges->numNames * sizeof(*ranges->nameOffsets);
+    ranges->nameOffsets = take_block_bytes(&cursor, offsetsSize);
+    ranges->names       = take_block_bytes(&cursor, ranges->namesSize);
+}
+
+/*
+ * Allocates a single block holding all the mesh arrays, with their exact @sizes, and carves them
+ * out of it. @block is left NULL for an empty mesh.
+ */
+static bool alloc_mesh_block(
+    Obj_Parser    *parser,
+    Obj_MeshSizes  sizes,
+    Obj_MeshData  *data,
+    void         **block
+) {
+    const Obj_Allocator *allocator     = &parser->options.allocator;
+    bool                 loadPosW      = !(parser->options.loadFlags & OBJ_LOAD_SKIP_POSW);
+    uint32_t             quantizeFlags = parser->options.quantizeFlags;
+
+    *data  = (Obj_MeshData) {};
+    *block = NULL;
+
+    size_t size = mesh_block_size(sizes, loadPosW, quantizeFlags);
+    if (size == 0u) {
+        return true;
+    }
+
+    // Custom allocators align the block themselves, malloc is over-allocated to align it here
+    char *cursor;
+    if (allocator->allocate) {
+        *block = mem_allocate(allocator, size, BLOCK_ALIGNMENT);
+        cursor = *block;
+    } else {
+        *block = malloc(size + BLOCK_ALIGNMENT - 1u);
+        uintptr_t address = (uintptr_t)*block + BLOCK_ALIGNMENT - 1u;
+        cursor            = (char *)(address & ~(uintptr_t)(BLOCK_ALIGNMENT - 1u));
+    }
+    if (!*block) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    track_bytes(parser, &parser->meshBytes, size, 0u);
+    carve_mesh_block(cursor, sizes, loadPosW, quantizeFlags, data);
+    return true;
+}
+
+/*
+ * Frees mesh arrays either carved from @block, or allocated separately when it is NULL
+ */
+static void free_mesh_data(const Obj_Allocator *allocator, Obj_MeshData *data, void *block) {
+    if (block) {
+        mem_deallocate(allocator, block);
+    } else {
+        mem_deallocate(allocator, data->posX);
+        mem_deallocate(allocator, data->posY);
+        mem_deallocate(allocator, data->posZ);
+        mem_deallocate(allocator, data->posW);
+        mem_deallocate(allocator, data->normX);
+        mem_deallocate(allocator, data->normY);
+        mem_deallocate(allocator, data->normZ);
+        mem_deallocate(allocator, data->texU);
+        mem_deallocate(allocator, data->texV);
+        mem_deallocate(allocator, data->faces);
+        mem_deallocate(allocator, data->compactFaces);
+        mem_deallocate(allocator, data->faceSizes);
+        mem_deallocate(allocator, data->quantized.posX);
+        mem_deallocate(allocator, data->quantized.posY);
+        mem_deallocate(allocator, data->quantized.posZ);
+        mem_deallocate(allocator, data->quantized.normX);
+        mem_deallocate(allocator, data->quantized.normY);
+        mem_deallocate(allocator, data->quantized.normZ);
+        mem_deallocate(allocator, data->quantized.texU);
+        mem_deallocate(allocator, data->quantized.texV);
+    }
+    *data = (Obj_MeshData) {};
+}
+
+static void copy_bytes(void *dst, const void *src, size_t size) {
+    if (size > 0u) {
+        memcpy(dst, src, size);
+    }
+}
+
+/*
+ * Moves separately allocated mesh arrays into a single block
+ */
+static bool pack_mesh_data(
+    Obj_Parser   *parser,
+    Obj_MeshSizes sizes,
+    Obj_MeshData *data,
+    void        **block
+) {
+    size_t       arraysBytes = parser->meshBytes;
+    Obj_MeshData packed;
+    if (!alloc_mesh_block(parser, sizes, &packed, block)) {
+        return false;
+    }
+
+    if (*block) {
+        copy_bytes(packed.posX, data->posX, sizes.nPos * sizeof(*data->posX));
+        copy_bytes(packed.posY, data->posY, sizes.nPos * sizeof(*data->posY));
+        copy_bytes(packed.posZ, data->posZ, sizes.nPos * sizeof(*data->posZ));
+        if (data->posW) {
+            copy_bytes(packed.posW, data->posW, sizes.nPos * sizeof(*data->posW));
+        }
+        copy_bytes(packed.normX, data->normX, sizes.nNorms * sizeof(*data->normX));
+        copy_bytes(packed.normY, data->normY, sizes.nNorms * sizeof(*data->normY));
+        copy_bytes(packed.normZ, data->normZ, sizes.nNorms * sizeof(*data->normZ));
+        copy_bytes(packed.texU, data->texU, sizes.nTex * sizeof(*data->texU));
+        copy_bytes(packed.texV, data->texV, sizes.nTex * sizeof(*data->texV));
+        copy_bytes(packed.faces, data->faces, sizes.flatFacesSize * sizeof(*data->faces));
+        copy_bytes(packed.faceSizes, data->faceSizes, sizes.nFaces * sizeof(*data->faceSizes));
+    }
+
+    free_mesh_data(&parser->options.allocator, data, NULL);
+    track_bytes(parser, &parser->meshBytes, 0u, arraysBytes);
+    *data = packed;
+    return true;
+}
+
+static void put_compact_index(char *out, uint32_t indexSize, uint32_t index) {
+    if (indexSize == sizeof(uint16_t)) {
+        uint16_t shortIndex = (uint16_t)index;
+        memcpy(out, &shortIndex, sizeof(shortIndex));
+    } else {
+        memcpy(out, &index, sizeof(index));
+    }
+}
+
+static uint32_t get_compact_index(const char *in, uint32_t indexSize) {
+    if (indexSize == sizeof(uint16_t)) {
+        uint16_t shortIndex;
+        memcpy(&shortIndex, in, sizeof(shortIndex));
+        return shortIndex;
+    }
+    uint32_t index;
+    memcpy(&index, in, sizeof(index));
+    return index;
+}
+
+/*
+ * Finds the smallest layout holding the face vertices of @mesh, from the streams they use and their
+ * largest index
+ */
+static Obj_FaceFormat get_compact_format(const Obj_Mesh *mesh) {
+    const Obj_VertIdx *faces    = mesh->data.faces;
+    uint32_t           streams  = OBJ_FACE_POSITIONS;
+    int32_t            maxIndex = 0;
+
+    for (uint32_t i = 0u; i < mesh->sizes.flatFacesSize; ++i) {
+        Obj_VertIdx vertIdx = faces[i];
+        streams |= vertIdx.texIdx != -1 ? OBJ_FACE_TEXCOORDS : 0u;
+        streams |= vertIdx.normIdx != -1 ? OBJ_FACE_NORMALS : 0u;
+        maxIndex = vertIdx.posIdx > maxIndex ? vertIdx.posIdx : maxIndex;
+        maxIndex = vertIdx.texIdx > maxIndex ? vertIdx.texIdx : maxIndex;
+        maxIndex = vertIdx.normIdx > maxIndex ? vertIdx.normIdx : maxIndex;
+    }
+
+    uint32_t indexSize  = maxIndex <= UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t);
+    uint32_t numStreams = 1u + (streams & OBJ_FACE_TEXCOORDS ? 1u : 0u)
+                        + (streams & OBJ_FACE_NORMALS ? 1u : 0u);
+    return (Obj_FaceFormat) {streams, indexSize, numStreams * indexSize};
+}
+
+/*
+ * Replaces the faces of @mesh by compact face vertices. These take at most as many bytes as the
+ * Obj_VertIdx they are made from, so each face vertex is written over the faces array once it was
+ * read, and the array is then shrunk. Meshes mapped from a cache get a new array instead, so that
+ * the mapping is not copied.
+ */
+static bool compact_faces(Obj_Mesh *mesh) {
+    Obj_MeshData      *data       = &mesh->data;
+    const Obj_VertIdx *faces      = data->faces;
+    uint32_t           numCorners = mesh->sizes.flatFacesSize;
+
+    if (!faces) {
+        return true;
+    }
+
+    Obj_FaceFormat format  = get_compact_format(mesh);
+    char          *compact = (char *)data->faces;
+    if (mesh->mapping) {
+        size_t size = (size_t)numCorners * format.stride;
+        compact     = mem_allocate(&mesh->allocator, size, ARRAY_ALIGNMENT);
+        if (!compact && numCorners > 0u) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0u; i < numCorners; ++i) {
+        Obj_VertIdx vertIdx = faces[i];
+        char       *out     = compact + (size_t)i * format.stride;
+        uint32_t    texIdx  = vertIdx.texIdx == -1 ? 0u : (uint32_t)vertIdx.texIdx;
+        uint32_t    normIdx = vertIdx.normIdx == -1 ? 0u : (uint32_t)vertIdx.normIdx;
+
+        put_compact_index(out, format.indexSize, (uint32_t)vertIdx.posIdx);
+        out += format.indexSize;
+        if (format.streams & OBJ_FACE_TEXCOORDS) {
+            put_compact_index(out, format.indexSize, texIdx);
+            out += format.indexSize;
+        }
+        if (format.streams & OBJ_FACE_NORMALS) {
+            put_compact_index(out, format.indexSize, normIdx);
+        }
+    }
+
+    // Failing to shrink the array leaves it larger than needed, but still valid
+    void *compactFaces = compact;
+    if (!mesh->mapping && !mesh->block) {
+        resize_array(&mesh->allocator, &compactFaces, numCorners, numCorners, format.stride);
+    }
+
+    data->faces        = NULL;
+    data->compactFaces = compactFaces;
+    mesh->faceFormat   = format;
+    return true;
+}
+
+/*
+ * Returns face vertex @idx of @mesh, whether its faces are compact or not
+ */
+static Obj_VertIdx get_face_vertex(const Obj_Mesh *mesh, uint32_t idx) {
+    if (mesh->data.faces) {
+        return mesh->data.faces[idx];
+    }
+
+    const Obj_FaceFormat *format = &mesh->faceFormat;
+    const char           *in     = mesh->data.compactFaces;
+    in += (size_t)idx * format->stride;
+
+    Obj_VertIdx vertIdx = {(int32_t)get_compact_index(in, format->indexSize), -1, -1};
+    in += format->indexSize;
+    if (format->streams & OBJ_FACE_TEXCOORDS) {
+        uint32_t texIdx = get_compact_index(in, format->indexSize);
+        vertIdx.texIdx  = texIdx ? (int32_t)texIdx : -1;
+        in += format->indexSize;
+    }
+    if (format->streams & OBJ_FACE_NORMALS) {
+        uint32_t normIdx = get_compact_index(in, format->indexSize);
+        vertIdx.normIdx  = normIdx ? (int32_t)normIdx : -1;
+    }
+    return vertIdx;
+}
+
+static bool is_digit(char c) {
+    return (unsigned)(c - '0') < 10u;
+}
+
+/*
+ * Whether rounding @d to a float may differ from rounding the exact decimal value it approximates,
+ * which can only happen when @d lies exactly halfway between two floats. Values in the float
+ * subnormal range are reported as well, and left to the slow path.
+ */
+static bool is_float_rounding_ambiguous(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+
+    uint32_t biasedExponent = (uint32_t)(bits >> DOUBLE_MANTISSA_BITS) & 0x7ffu;
+    if (biasedExponent < DOUBLE_EXPONENT_BIAS + FLOAT_MIN_EXPONENT) {
+        return true;
+    }
+
+    // The 29 low bits of the double mantissa are the ones dropped when rounding to a float
+    uint32_t droppedBits = DOUBLE_MANTISSA_BITS - FLOAT_MANTISSA_BITS;
+    uint64_t droppedMask = (UINT64_C(1) << droppedBits) - 1u;
+    return (bits & droppedMask) == UINT64_C(1) << (droppedBits - 1u);
+}
+
+/*
+ * Drops the trailing zeros of @decimal
+ */
+static void trim_decimal(Obj_BigDecimal *decimal) {
+    while (decimal->numDigits > 0u && decimal->digits[decimal->numDigits - 1u] == 0u) {
+        --decimal->numDigits;
+    }
+    if (decimal->numDigits == 0u) {
+        decimal->point = 0;
+    }
+}
+
+/*
+ * Stores @digit at @idx of @decimal, or flags it as truncated when that is past its capacity
+ */
+static void put_decimal_digit(Obj_BigDecimal *decimal, uint32_t idx, uint64_t digit) {
+    if (idx < MAX_DECIMAL_DIGITS) {
+        decimal->digits[idx] = (uint8_t)digit;
+    } else if (digit != 0u) {
+        decimal->truncated = true;
+    }
+}
+
+/*
+ * Multiplies @decimal by 2^@shift, with @shift at most MAX_DECIMAL_SHIFT. The digits are multiplied
+ * from the least significant one, after a first pass which counts the digits the carry adds.
+ */
+static void shift_decimal_left(Obj_BigDecimal *decimal, uint32_t shift) {
+    uint64_t carry = 0u;
+    for (uint32_t r = decimal->numDigits; r-- > 0u;) {
+        carry = (carry + ((uint64_t)decimal->digits[r] << shift)) / 10u;
+    }
+    uint32_t numNewDigits = 0u;
+    for (; carry > 0u; carry /= 10u) {
+        ++numNewDigits;
+    }
+
+    uint32_t w = decimal->numDigits + numNewDigits;
+    uint64_t n = 0u;
+    for (uint32_t r = decimal->numDigits; r-- > 0u;) {
+        n += (uint64_t)decimal->digits[r] << shift;
+        put_decimal_digit(decimal, --w, n % 10u);
+        n /= 10u;
+    }
+    for (; n > 0u; n /= 10u) {
+        put_decimal_digit(decimal, --w, n % 10u);
+    }
+
+    decimal->numDigits += numNewDigits;
+    decimal->numDigits = decimal->numDigits < MAX_DECIMAL_DIGITS ? decimal->numDigits
+                                                                 : MAX_DECIMAL_DIGITS;
+    decimal->point += (int32_t)numNewDigits;
+    trim_decimal(decimal);
+}
+
+/*
+ * Divides @decimal by 2^@shift, with @shift at most MAX_DECIMAL_SHIFT, from its most significant
+ * digit down
+ */
+static void shift_decimal_right(Obj_BigDecimal *decimal, uint32_t shift) {
+    uint32_t r = 0u;
+    uint32_t w = 0u;
+    uint64_t n = 0u;
+
+    // Leading digits worth at least 2^shift, so that the first digit written is not 0
+    for (; (n >> shift) == 0u; ++r) {
+        if (r >= decimal->numDigits) {
+            if (n == 0u) {
+                trim_decimal(decimal);
+                return;
+            }
+            while ((n >> shift) == 0u) {
+                n *= 10u;
+                ++r;
+            }
+            break;
+        }
+        n = n * 10u + decimal->digits[r];
+    }
+    decimal->point -= (int32_t)r - 1;
+
+    uint64_t mask = (UINT64_C(1) << shift) - 1u;
+    for (; r < decimal->numDigits; ++r) {
+        decimal->digits[w++] = (uint8_t)(n >> shift);
+        n                    = (n & mask) * 10u + decimal->digits[r];
+    }
+    for (; n > 0u; n = (n & mask) * 10u) {
+        put_decimal_digit(decimal, w, n >> shift);
+        w += w < MAX_DECIMAL_DIGITS;
+    }
+
+    decimal->numDigits = w;
+    trim_decimal(decimal);
+}
+
+/*
+ * Multiplies @decimal by 2^@shift, dividing it when @shift is negative
+ */
+static void shift_decimal(Obj_BigDecimal *decimal, int32_t shift) {
+    for (; shift > (int32_t)MAX_DECIMAL_SHIFT; shift -= (int32_t)MAX_DECIMAL_SHIFT) {
+        shift_decimal_left(decimal, MAX_DECIMAL_SHIFT);
+    }
+    for (; shift < -(int32_t)MAX_DECIMAL_SHIFT; shift += (int32_t)MAX_DECIMAL_SHIFT) {
+        shift_decimal_right(decimal, MAX_DECIMAL_SHIFT);
+    }
+    if (shift > 0) {
+        shift_decimal_left(decimal, (uint32_t)shift);
+    } else if (shift < 0) {
+        shift_decimal_right(decimal, (uint32_t)-shift);
+    }
+}
+
+/*
+ * Returns the integer part of @decimal, rounded to nearest, ties to even. @decimal is below 2^64.
+ */
+static uint64_t round_decimal(const Obj_BigDecimal *decimal) {
+    uint64_t n = 0u;
+    int32_t  i = 0;
+    for (; i < decimal->point && (uint32_t)i < decimal->numDigits; ++i) {
+        n = n * 10u + decimal->digits[i];
+    }
+    for (; i < decimal->point; ++i) {
+        n *= 10u;
+    }
+
+    // Below 0.1, or without fractional digits, the integer part is already the nearest
+    if (decimal->point < 0 || (uint32_t)decimal->point >= decimal->numDigits) {
+        return n;
+    }
+    uint32_t next     = (uint32_t)decimal->point;
+    bool     roundsUp = decimal->digits[next] >= 5u;
+    if (decimal->digits[next] == 5u && next + 1u == decimal->numDigits && !decimal->truncated) {
+        roundsUp = n % 2u == 1u;
+    }
+    return n + roundsUp;
+}
+
+/*
+ * Returns the bits of the float nearest to @decimal, ties to even, overwriting @decimal: it is
+ * scaled by powers of 2 into [0.5, 1), then by 2^24 so that its integer part is the float mantissa.
+ */
+static uint32_t decimal_to_float_bits(Obj_BigDecimal *decimal) {
+    if (decimal->numDigits == 0u || decimal->point < MIN_DECIMAL_POINT) {
+        return 0u;
+    }
+    if (decimal->point > MAX_DECIMAL_POINT) {
+        return FLOAT_INFINITY_BITS;
+    }
+
+    const uint32_t numShifts = sizeof(DECIMAL_SHIFTS) / sizeof(*DECIMAL_SHIFTS);
+    int32_t        exponent  = 0;
+    while (decimal->point > 0) {
+        uint32_t point = (uint32_t)decimal->point;
+        uint32_t shift = point < numShifts ? DECIMAL_SHIFTS[point] : DECIMAL_SHIFT_STEP;
+        shift_decimal_right(decimal, shift);
+        exponent += (int32_t)shift;
+    }
+    while (decimal->point < 0 || (decimal->point == 0 && decimal->digits[0] < 5u)) {
+        uint32_t zeros = (uint32_t)-decimal->point;
+        uint32_t shift = zeros < numShifts ? DECIMAL_SHIFTS[zeros] : DECIMAL_SHIFT_STEP;
+        shift_decimal_left(decimal, shift);
+        exponent -= (int32_t)shift;
+    }
+
+    // With a mantissa in [1, 2), subnormals keeping the smallest exponent
+    --exponent;
+    if (exponent < FLOAT_MIN_EXPONENT) {
+        shift_decimal(decimal, exponent - FLOAT_MIN_EXPONENT);
+        exponent = FLOAT_MIN_EXPONENT;
+    }
+
+    shift_decimal(decimal, FLOAT_MANTISSA_BITS + 1);
+    uint64_t mantissa = round_decimal(decimal);
+    if (mantissa == UINT64_C(2) << FLOAT_MANTISSA_BITS) {
+        mantissa >>= 1u;
+        ++exponent;
+    }
+
+    if (exponent > FLOAT_MAX_EXPONENT) {
+        return FLOAT_INFINITY_BITS;
+    }
+    if (!(mantissa >> FLOAT_MANTISSA_BITS)) {
+        return (uint32_t)mantissa;
+    }
+    return (uint32_t)(exponent + FLOAT_EXPONENT_BIAS) << FLOAT_MANTISSA_BITS
+         | ((uint32_t)mantissa & ((1u << FLOAT_MANTISSA_BITS) - 1u));
+}
+
+/*
+ * Returns the bits of the float nearest to @mantissa * 2^@exponent, ties to even, @sticky telling
+ * whether nonzero bits below @mantissa were dropped
+ */
+static uint32_t binary_to_float_bits(uint64_t mantissa, int32_t exponent, bool sticky) {
+    if (mantissa == 0u) {
+        return 0u;
+    }
+    for (; !(mantissa >> 63u); mantissa <<= 1u) {
+        --exponent;
+    }
+
+    // Exponent of the leading bit, and bits dropped below the float mantissa
+    int32_t  leading = exponent + 63;
+    uint32_t drop    = 63u - FLOAT_MANTISSA_BITS;
+    if (leading > FLOAT_MAX_EXPONENT) {
+        return FLOAT_INFINITY_BITS;
+    }
+    if (leading < FLOAT_MIN_EXPONENT) {
+        int64_t subnormalDrop = (int64_t)drop + FLOAT_MIN_EXPONENT - leading;
+        if (subnormalDrop > 64) {
+            return 0u;
+        }
+        drop = (uint32_t)subnormalDrop;
+    }
+
+    uint64_t kept = drop < 64u ? mantissa >> drop : 0u;
+    uint64_t rest = drop < 64u ? mantissa & ((UINT64_C(1) << drop) - 1u) : mantissa;
+    uint64_t half = UINT64_C(1) << (drop - 1u);
+    if (rest > half || (rest == half && (sticky || kept % 2u == 1u))) {
+        ++kept;
+    }
+
+    // Subnormals rounding up to the smallest normal float get its bits as they are
+    if (leading < FLOAT_MIN_EXPONENT) {
+        return (uint32_t)kept;
+    }
+    if (kept >> (FLOAT_MANTISSA_BITS + 1)) {
+        kept >>= 1u;
+        if (++leading > FLOAT_MAX_EXPONENT) {
+            return FLOAT_INFINITY_BITS;
+        }
+    }
+    return (uint32_t)(leading + FLOAT_EXPONENT_BIAS) << FLOAT_MANTISSA_BITS
+         | ((uint32_t)kept & ((1u << FLOAT_MANTISSA_BITS) - 1u));
+}
+
+static bool is_hex_digit(char c) {
+    return is_digit(c) || (unsigned)((c | 0x20) - 'a') < 6u;
+}
+
+static uint32_t hex_digit_value(char c) {
+    return is_digit(c) ? (uint32_t)(c - '0') : (uint32_t)((c | 0x20) - 'a') + 10u;
+}
+
+/*
+ * Reads the exponent of a float at @c, if any: @marker, case insensitive, then an optional sign and
+ * digits, clamped to MAX_DECIMAL_EXPONENT. Returns the end of the exponent, or @c without one.
+ */
+static const char *read_float_exponent(const char *c, const char *end, char marker, int32_t *exp) {
+    *exp = 0;
+    if (c == end || (*c | 0x20) != marker) {
+        return c;
+    }
+
+    const char *e        = c + 1;
+    bool        negative = false;
+    if (e < end && (*e == '-' || *e == '+')) {
+        negative = *e == '-';
+        ++e;
+    }
+    if (e == end || !is_digit(*e)) {
+        return c;
+    }
+
+    int32_t value = 0;
+    for (; e < end && is_digit(*e); ++e) {
+        if (value < MAX_DECIMAL_EXPONENT) {
+            value = value * 10 + (*e - '0');
+        }
+    }
+    *exp = negative ? -value : value;
+    return e;
+}
+
+/*
+ * Reads the decimal number at @c into @decimal, and returns the end of it, or NULL without digits
+ */
+static const char *read_big_decimal(const char *c, const char *end, Obj_BigDecimal *decimal) {
+    bool anyDigit     = false;
+    bool pastPoint    = false;
+    decimal->numDigits = 0u;
+    decimal->point     = 0;
+    decimal->truncated = false;
+
+    for (; c < end && (is_digit(*c) || (*c == '.' && !pastPoint)); ++c) {
+        if (*c == '.') {
+            pastPoint = true;
+            continue;
+        }
+
+        anyDigit = true;
+        if (*c == '0' && decimal->numDigits == 0u) {
+            decimal->point -= pastPoint && decimal->point > -MAX_DECIMAL_EXPONENT;
+            continue;
+        }
+        put_decimal_digit(decimal, decimal->numDigits, (uint64_t)(*c - '0'));
+        decimal->numDigits += decimal->numDigits < MAX_DECIMAL_DIGITS;
+        decimal->point += !pastPoint && decimal->point < MAX_DECIMAL_EXPONENT;
+    }
+    if (!anyDigit) {
+        return NULL;
+    }
+
+    int32_t exponent;
+    c = read_float_exponent(c, end, 'e', &exponent);
+    decimal->point += exponent;
+    trim_decimal(decimal);
+    return c;
+}
+
+/*
+ * Reads the hexadecimal float at @c, after its 0x prefix, into @bits, and returns the end of it, or
+ * NULL without digits. Its binary exponent is optional, as for strtof.
+ */
+static const char *read_hex_float(const char *c, const char *end, uint32_t *bits) {
+    uint64_t mantissa  = 0u;
+    int32_t  exponent  = 0;
+    bool     sticky    = false;
+    bool     anyDigit  = false;
+    bool     pastPoint = false;
+
+    for (; c < end && (is_hex_digit(*c) || (*c == '.' && !pastPoint)); ++c) {
+        if (*c == '.') {
+            pastPoint = true;
+            continue;
+        }
+
+        anyDigit = true;
+        if (!(mantissa >> 60u)) {
+            mantissa = mantissa << 4u | hex_digit_value(*c);
+            exponent -= pastPoint && exponent > -MAX_DECIMAL_EXPONENT ? 4 : 0;
+        } else {
+            sticky = sticky || hex_digit_value(*c) != 0u;
+            exponent += !pastPoint && exponent < MAX_DECIMAL_EXPONENT ? 4 : 0;
+        }
+    }
+    if (!anyDigit) {
+        return NULL;
+    }
+
+    int32_t binaryExponent;
+    c     = read_float_exponent(c, end, 'p', &binaryExponent);
+    *bits = binary_to_float_bits(mantissa, exponent + binaryExponent, sticky);
+    return c;
+}
+
+/*
+ * Whether [c, end) spells @word, lower case, in any case
+ */
+static bool is_word(const char *c, const char *end, const char *word) {
+    for (; c < end && *word; ++c, ++word) {
+        if ((*c | 0x20) != *word) {
+            return false;
+        }
+    }
+    return c == end && !*word;
+}
+
+/*
+ * Whether [c, end) is a NaN, with an optional sequence of letters, digits and underscores in
+ * parentheses
+ */
+static bool is_nan_token(const char *c, const char *end) {
+    if (end - c < 3 || !is_word(c, c + 3, "nan")) {
+        return false;
+    }
+    if (end - c == 3) {
+        return true;
+    }
+    if (c[3] != '(' || end[-1] != ')') {
+        return false;
+    }
+    for (c += 4; c < end - 1; ++c) {
+        if (!is_digit(*c) && (unsigned)((*c | 0x20) - 'a') >= 26u && *c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Slow path of parse_float, for the tokens it cannot round exactly, or which are not plain decimal
+ * numbers: decimal numbers of any length, exactly rounded with big decimals, hexadecimal floats,
+ * infinities and NaNs. These are the numbers strtof accepts in the "C" locale, but read without
+ * depending on the locale. NaNs all get the default quiet NaN, with their sign.
+ */
+static bool parse_float_slow(const char **cursor, const char *end, float *value) {
+    const char *c        = *cursor;
+    const char *tokenEnd = c;
+    while (tokenEnd < end && !is_blank(*tokenEnd)) {
+        ++tokenEnd;
+    }
+
+    bool negative = false;
+    if (c < tokenEnd && (*c == '-' || *c == '+')) {
+        negative = *c == '-';
+        ++c;
+    }
+
+    uint32_t bits = 0u;
+    if (is_word(c, tokenEnd, "inf") || is_word(c, tokenEnd, "infinity")) {
+        bits = FLOAT_INFINITY_BITS;
+    } else if (is_nan_token(c, tokenEnd)) {
+        bits = FLOAT_NAN_BITS;
+    } else if (tokenEnd - c > 2 && c[0] == '0' && (c[1] | 0x20) == 'x') {
+        if (read_hex_float(c + 2, tokenEnd, &bits) != tokenEnd) {
+            return false;
+        }
+    } else {
+        Obj_BigDecimal decimal;
+        if (read_big_decimal(c, tokenEnd, &decimal) != tokenEnd) {
+            return false;
+        }
+        bits = decimal_to_float_bits(&decimal);
+    }
+
+    bits |= negative ? UINT32_C(1) << 31u : 0u;
+    memcpy(value, &bits, sizeof(*value));
+    *cursor = tokenEnd;
+    return true;
+}
+
+/*
+ * Parses the float starting at @cursor, which must be followed by a blank or @end, and advances
+ * @cursor past it. This does not depend on the locale, and is correctly rounded: decimal numbers
+ * with at most 19 significant digits and small exponents are computed exactly with a single double
+ * operation (Clinger's fast path), which then only rounds to the right float when not halfway
+ * between two floats. The few numbers outside of that are left to parse_float_slow.
+ */
+static bool parse_float(const char **cursor, const char *end, float *value) {
+    const char *c = *cursor;
+
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+')) {
+        negative = *c == '-';
+        ++c;
+    }
+
+    uint64_t mantissa  = 0u;
+    int32_t  exponent  = 0;
+    uint32_t numDigits = 0u;  // significant digits held in the mantissa
+    bool     truncated = false;
+    bool     anyDigit  = false;
+
+    for (; c < end && is_digit(*c); ++c) {
+        anyDigit = true;
+        if (numDigits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10u + (uint64_t)(*c - '0');
+            numDigits += mantissa != 0u;
+        } else {
+            ++exponent;
+            truncated = truncated || *c != '0';
+        }
+    }
+    if (c < end && *c == '.') {
+        for (++c; c < end && is_digit(*c); ++c) {
+            anyDigit = true;
+            if (numDigits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10u + (uint64_t)(*c - '0');
+                numDigits += mantissa != 0u;
+                --exponent;
+            } else {
+                truncated = truncated || *c != '0';
+            }
+        }
+    }
+    if (anyDigit && c < end && (*c == 'e' || *c == 'E')) {
+        const char *e           = c + 1;
+        bool        negativeExp = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negativeExp = *e == '-';
+            ++e;
+        }
+        if (e < end && is_digit(*e)) {
+            int32_t expValue = 0;
+            for (; e < end && is_digit(*e); ++e) {
+                if (expValue < MAX_DECIMAL_EXPONENT) {
+                    expValue = expValue * 10 + (*e - '0');
+                }
+            }
+            exponent += negativeExp ? -expValue : expValue;
+            c = e;
+        }
+    }
+
+    // Anything else, like inf, nan or hexadecimal floats, is for the slow path to accept or reject
+    if (!anyDigit || (c < end && !is_blank(*c))) {
+        return parse_float_slow(cursor, end, value);
+    }
+
+    if (mantissa == 0u) {
+        *value  = negative ? -0.0f : 0.0f;
+        *cursor = c;
+        return true;
+    }
+
+    if (!truncated && mantissa <= MAX_EXACT_DOUBLE_INT && exponent >= -MAX_EXACT_POW10
+        && exponent <= MAX_EXACT_POW10) {
+        double d = (double)mantissa;
+        d        = exponent < 0 ? d / EXACT_POW10[-exponent] : d * EXACT_POW10[exponent];
+        if (!is_float_rounding_ambiguous(d)) {
+            *value  = (float)(negative ? -d : d);
+            *cursor = c;
+            return true;
+        }
+    }
+
+    return parse_float_slow(cursor, end, value);
+}
+
+/*
+ * Parses up to @maxCount whitespace separated floats out of [cursor, end), and returns how many
+ * were read.
+ */
+static uint32_t parse_floats(
+    const char *cursor,
+    const char *end,
+    float      *values,
+    uint32_t    maxCount
+) {
+    uint32_t numValues = 0u;
+    while (numValues < maxCount) {
+        cursor = skip_blanks(cursor, end);
+        if (cursor == end || !parse_float(&cursor, end, values + numValues)) {
+            break;
+        }
+        ++numValues;
+    }
+    return numValues;
+}
+
+static Obj_Bounds empty_bounds(void) {
+    return (Obj_Bounds) {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+}
+
+static void extend_bounds(Obj_Bounds *bounds, const float point[3]) {
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        bounds->min[i] = point[i] < bounds->min[i] ? point[i] : bounds->min[i];
+        bounds->max[i] = point[i] > bounds->max[i] ? point[i] : bounds->max[i];
+    }
+}
+
+static void merge_bounds(Obj_Bounds *bounds, const Obj_Bounds *other) {
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        bounds->min[i] = other->min[i] < bounds->min[i] ? other->min[i] : bounds->min[i];
+        bounds->max[i] = other->max[i] > bounds->max[i] ? other->max[i] : bounds->max[i];
+    }
+}
+
+/*
+ * Extends @bounds with the vertex positions of the [begin, end) buffer. Malformed position lines
+ * are left for the parsing pass to report.
+ */
+static void get_bounds_from_buffer(const char *begin, const char *end, Obj_Bounds *bounds) {
+    for (const char *line = begin; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        float position[3];
+        if (get_line_type(line, lineEnd) == OBJ_VECPOS
+            && parse_floats(line + 2, lineEnd, position, 3u) == 3u) {
+            extend_bounds(bounds, position);
+        }
+        line = lineEnd + 1;
+    }
+}
+
+/*
+ * Sets the position bounds the parser quantizes positions relative to
+ */
+static void set_position_bounds(Obj_Parser *parser, Obj_Bounds bounds) {
+    parser->posBounds = bounds;
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        float extent        = bounds.max[i] - bounds.min[i];
+        parser->posScale[i] = extent > 0.f ? UNORM16_MAX / extent : 0.f;
+    }
+}
+
+/*
+ * Converts @value to the nearest half precision float, ties to even
+ */
+static uint16_t float_to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign     = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    if (exponent == 0xFFu) {
+        return (uint16_t)(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int32_t halfExponent = (int32_t)exponent - 127 + 15;
+    if (halfExponent >= 31) {
+        return (uint16_t)(sign | 0x7C00u);
+    }
+    if (halfExponent < -10) {
+        return (uint16_t)sign;
+    }
+
+    // Subnormal halves shift the implicit bit into the mantissa
+    uint32_t shift = 13u;
+    if (halfExponent <= 0) {
+        mantissa |= 0x800000u;
+        shift        = (uint32_t)(14 - halfExponent);
+        halfExponent = 0;
+    }
+    uint32_t half     = ((uint32_t)halfExponent << 10) | (mantissa >> shift);
+    uint32_t rest     = mantissa & ((1u << shift) - 1u);
+    uint32_t halfway  = 1u << (shift - 1u);
+    half += rest > halfway || (rest == halfway && (half & 1u));
+    return (uint16_t)(sign | half);
+}
+
+static float half_to_float(uint16_t half) {
+    uint32_t sign     = (uint32_t)(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent != 0u) {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    } else if (mantissa == 0u) {
+        bits = sign;
+    } else {
+        // Subnormal halves are normal floats
+        exponent = 113u;
+        while (!(mantissa & 0x400u)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*
+ * Converts @value, clamped to [0, UNORM16_MAX], to the nearest 16-bit unsigned normalized value
+ */
+static uint16_t to_unorm16(float value) {
+    value = value > 0.f ? (value < UNORM16_MAX ? value : UNORM16_MAX) : 0.f;
+    return (uint16_t)(value + 0.5f);
+}
+
+static void get_position(const Obj_Mesh *mesh, uint32_t idx, float position[3]) {
+    const Obj_MeshData *data = &mesh->data;
+    if (!(mesh->quantizeFlags & OBJ_QUANTIZE_POSITIONS)) {
+        position[0] = data->posX[idx];
+        position[1] = data->posY[idx];
+        position[2] = data->posZ[idx];
+        return;
+    }
+
+    const Obj_QuantizedData *in           = &data->quantized;
+    const uint16_t          *quantized[3] = {in->posX, in->posY, in->posZ};
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        float extent = mesh->posBounds.max[i] - mesh->posBounds.min[i];
+        position[i]  = mesh->posBounds.min[i] + (float)quantized[i][idx] * extent / UNORM16_MAX;
+    }
+}
+
+static void get_normal(const Obj_Mesh *mesh, uint32_t idx, float normal[3]) {
+    const Obj_MeshData *data = &mesh->data;
+    if (!(mesh->quantizeFlags & OBJ_QUANTIZE_NORMALS)) {
+        normal[0] = data->normX[idx];
+        normal[1] = data->normY[idx];
+        normal[2] = data->normZ[idx];
+        return;
+    }
+    normal[0] = half_to_float(data->quantized.normX[idx]);
+    normal[1] = half_to_float(data->quantized.normY[idx]);
+    normal[2] = half_to_float(data->quantized.normZ[idx]);
+}
+
+static void get_texcoord(const Obj_Mesh *mesh, uint32_t idx, float texcoord[2]) {
+    const Obj_MeshData *data = &mesh->data;
+    if (!(mesh->quantizeFlags & OBJ_QUANTIZE_TEXCOORDS)) {
+        texcoord[0] = data->texU[idx];
+        texcoord[1] = data->texV[idx];
+        return;
+    }
+    texcoord[0] = (float)data->quantized.texU[idx] / UNORM16_MAX;
+    texcoord[1] = (float)data->quantized.texV[idx] / UNORM16_MAX;
+}
+
+/*
+ * Parses the index starting at @cursor and advances @cursor past it. Negative indices are relative
+ * to the @numElements read so far, and are resolved to the absolute index they refer to.
+ */
+static bool parse_index(
+    const char **cursor,
+    const char  *end,
+    uint32_t     numElements,
+    int32_t     *index
+) {
+    const char *c = *cursor;
+
+    bool negative = c < end && *c == '-';
+    if (c < end && (*c == '-' || *c == '+')) {
+        ++c;
+    }
+    if (c == end || !is_digit(*c)) {
+        return false;
+    }
+
+    int64_t value = 0;
+    for (; c < end && is_digit(*c); ++c) {
+        value = value * 10 + (*c - '0');
+        if (value > INT32_MAX) {
+            return false;
+        }
+    }
+
+    // Index 0 refers to no element, whether absolute or relative
+    if (value == 0) {
+        return false;
+    }
+    if (negative) {
+        value = (int64_t)numElements + 1 - value;
+    }
+    if (value < 1) {
+        return false;
+    }
+
+    *index  = (int32_t)value;
+    *cursor = c;
+    return true;
+}
+
+/*
+ * Advances @cursor past the index starting at it, without resolving it
+ */
+static bool skip_index(const char **cursor, const char *end) {
+    const char *c = *cursor;
+    if (c < end && (*c == '-' || *c == '+')) {
+        ++c;
+    }
+    if (c == end || !is_digit(*c)) {
+        return false;
+    }
+    while (c < end && is_digit(*c)) {
+        ++c;
+    }
+    *cursor = c;
+    return true;
+}
+
+/*
+ * Parses the face vertex starting at @cursor, in any of the p, p/t, p//n and p/t/n forms, and
+ * advances @cursor past it. The indices of the streams skipped by @loadFlags are left at -1.
+ */
+static bool parse_face_vertex(
+    const char  **cursor,
+    const char   *end,
+    Obj_MeshSizes count,
+    uint32_t      loadFlags,
+    Obj_VertIdx  *vertIdx
+) {
+    *vertIdx = (Obj_VertIdx) {-1, -1, -1};
+
+    if (!parse_index(cursor, end, count.nPos, &vertIdx->posIdx)) {
+        return false;
+    }
+    if (*cursor < end && **cursor == '/') {
+        ++*cursor;
+        // A slash is always followed by a texture coordinate index or by the normal one
+        if (*cursor == end || **cursor != '/') {
+            bool parsed = loadFlags & OBJ_LOAD_SKIP_TEXCOORDS
+                            ? skip_index(cursor, end)
+                            : parse_index(cursor, end, count.nTex, &vertIdx->texIdx);
+            if (!parsed) {
+                return false;
+            }
+        }
+        if (*cursor < end && **cursor == '/') {
+            ++*cursor;
+            bool parsed = loadFlags & OBJ_LOAD_SKIP_NORMALS
+                            ? skip_index(cursor, end)
+                            : parse_index(cursor, end, count.nNorms, &vertIdx->normIdx);
+            if (!parsed) {
+                return false;
+            }
+        }
+    }
+    return *cursor == end || is_blank(**cursor);
+}
+
+/*
+ * Parses the vertices of a face line in a single pass over it, and stores their number in
+ * @numVertices. Returns false when the line is malformed, @numVertices being 0 then.
+ */
+static bool parse_face(
+    Obj_ParseState *state,
+    const char     *line,
+    const char     *end,
+    uint32_t       *numVertices
+) {
+    Obj_MeshSizes numRead   = add_sizes(state->base, state->count);
+    uint32_t      loadFlags = state->parser->options.loadFlags;
+    Obj_VertIdx  *faceVerts = state->data.faces + state->count.flatFacesSize;
+
+    // Face lines hold no minus sign but those of relative indices. Malformed lines count too, as
+    // whether their indices resolve in range depends on the elements before them.
+    if (state->relativeIndices && memchr(line, '-', (size_t)(end - line))) {
+        *state->relativeIndices = true;
+    }
+
+    *numVertices       = 0u;
+    const char *cursor = skip_blanks(line + 2, end);  // ignore 'f' and first space
+    while (cursor < end) {
+        if (!parse_face_vertex(&cursor, end, numRead, loadFlags, faceVerts + *numVertices)) {
+            *numVertices = 0u;
+            return false;
+        }
+        ++*numVertices;
+        cursor = skip_blanks(cursor, end);
+    }
+    return true;
+}
+
+/*
+ * Returns the first token of [cursor, end), blanks being separators, and points @tokenEnd right
+ * after it. The token is empty once the line is exhausted.
+ */
+static const char *next_token(const char *cursor, const char *end, const char **tokenEnd) {
+    const char *token = skip_blanks(cursor, end);
+    const char *c     = token;
+    while (c < end && !is_blank(*c)) {
+        ++c;
+    }
+    *tokenEnd = c;
+    return token;
+}
+
+static bool token_is(const char *token, const char *tokenEnd, const char *keyword) {
+    size_t len = strlen(keyword);
+    return (size_t)(tokenEnd - token) == len && memcmp(token, keyword, len) == 0;
+}
+
+static const char *trim_blanks_end(const char *begin, const char *end) {
+    while (end > begin && is_blank(end[-1])) {
+        --end;
+    }
+    return end;
+}
+
+/*
+ * Copies the [begin, end) string to the string pool at @cursor, null terminated, and returns it
+ */
+static const char *copy_pool_string(char **cursor, const char *begin, const char *end) {
+    char  *string = *cursor;
+    size_t len    = (size_t)(end - begin);
+    memcpy(string, begin, len);
+    string[len] = '\0';
+    *cursor += len + 1u;
+    return string;
+}
+
+/*
+ * Parses the [cursor, end) colour of a material statement, a single value standing for all three
+ * components. Spectral and CIE XYZ colours are not supported, and leave @colour as is.
+ */
+static void parse_material_colour(const char *cursor, const char *end, float colour[3]) {
+    float    values[3];
+    uint32_t numValues = parse_floats(cursor, end, values, 3u);
+    for (uint32_t i = 0u; numValues > 0u && i < 3u; ++i) {
+        colour[i] = values[numValues == 3u ? i : 0u];
+    }
+}
+
+/*
+ * Parses the statement of the [line, end) line of a material library into @material, the strings of
+ * which are copied to the pool at @strings
+ */
+static void parse_material_line(
+    Obj_Material *material,
+    char        **strings,
+    const char   *line,
+    const char   *end
+) {
+    const char *keywordEnd;
+    const char *keyword = next_token(line, end, &keywordEnd);
+    const char *last    = trim_blanks_end(keywordEnd, end);
+
+    // Texture maps end with their file name, after the map options
+    const char *mapName = last;
+    while (mapName > keywordEnd && !is_blank(mapName[-1])) {
+        --mapName;
+    }
+    const char **map = NULL;
+
+    float value;
+    if (token_is(keyword, keywordEnd, "Ka")) {
+        parse_material_colour(keywordEnd, end, material->ambient);
+    } else if (token_is(keyword, keywordEnd, "Kd")) {
+        parse_material_colour(keywordEnd, end, material->diffuse);
+    } else if (token_is(keyword, keywordEnd, "Ks")) {
+        parse_material_colour(keywordEnd, end, material->specular);
+    } else if (token_is(keyword, keywordEnd, "Ke")) {
+        parse_material_colour(keywordEnd, end, material->emissive);
+    } else if (token_is(keyword, keywordEnd, "Ns")) {
+        parse_floats(keywordEnd, end, &material->shininess, 1u);
+    } else if (token_is(keyword, keywordEnd, "Ni")) {
+        parse_floats(keywordEnd, end, &material->opticalDensity, 1u);
+    } else if (token_is(keyword, keywordEnd, "d")) {
+        parse_floats(keywordEnd, end, &material->dissolve, 1u);
+    } else if (token_is(keyword, keywordEnd, "Tr")) {
+        if (parse_floats(keywordEnd, end, &value, 1u) == 1u) {
+            material->dissolve = 1.0f - value;
+        }
+    } else if (token_is(keyword, keywordEnd, "illum")) {
+        if (parse_floats(keywordEnd, end, &value, 1u) == 1u && value >= 0.0f) {
+            material->illum = (uint32_t)value;
+        }
+    } else if (token_is(keyword, keywordEnd, "map_Ka")) {
+        map = &material->ambientMap;
+    } else if (token_is(keyword, keywordEnd, "map_Kd")) {
+        map = &material->diffuseMap;
+    } else if (token_is(keyword, keywordEnd, "map_Ks")) {
+        map = &material->specularMap;
+    } else if (token_is(keyword, keywordEnd, "map_Ns")) {
+        map = &material->shininessMap;
+    } else if (token_is(keyword, keywordEnd, "map_d")) {
+        map = &material->dissolveMap;
+    } else if (token_is(keyword, keywordEnd, "map_Bump")
+               || token_is(keyword, keywordEnd, "map_bump")
+               || token_is(keyword, keywordEnd, "bump")) {
+        map = &material->bumpMap;
+    }
+
+    if (map && mapName < last) {
+        *map = copy_pool_string(strings, mapName, last);
+    }
+}
+
+/*
+ * Parses the materials of the null terminated [begin, end) buffer into @lib. Each string of the
+ * materials is shorter than the line it comes from, so the pool at @strings needs not be larger
+ * than the buffer.
+ */
+static bool parse_material_lib(
+    Obj_MaterialLib *lib,
+    char            *strings,
+    const char      *begin,
+    const char      *end
+) {
+    uint32_t numMaterials = 0u;
+    for (const char *line = begin; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        lineEnd             = lineEnd ? lineEnd : end;
+
+        const char *keywordEnd;
+        const char *keyword = next_token(line, lineEnd, &keywordEnd);
+        numMaterials += token_is(keyword, keywordEnd, "newmtl");
+        line = lineEnd + 1;
+    }
+
+    lib->materials = malloc((numMaterials ? numMaterials : 1u) * sizeof(*lib->materials));
+    if (!lib->materials) {
+        return false;
+    }
+
+    // Statements before the first newmtl one belong to no material, and are skipped
+    Obj_Material *material = NULL;
+    for (const char *line = begin; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        lineEnd             = lineEnd ? lineEnd : end;
+
+        const char *keywordEnd;
+        const char *keyword = next_token(line, lineEnd, &keywordEnd);
+        if (token_is(keyword, keywordEnd, "newmtl")) {
+            const char *name = skip_blanks(keywordEnd, lineEnd);
+            material         = lib->materials + lib->numMaterials++;
+            *material        = DEFAULT_MATERIAL;
+            material->name   = copy_pool_string(&strings, name, trim_blanks_end(name, lineEnd));
+        } else if (material) {
+            parse_material_line(material, &strings, line, lineEnd);
+        }
+        line = lineEnd + 1;
+    }
+    return true;
+}
+
+/*
+ * Reads and parses the material library of @entry
+ */
+static bool read_material_lib(Obj_MtlEntry *entry) {
+    const char *path = entry->lib.path;
+    size_t      size = (size_t)get_file_size(path);
+    FILE       *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    char *buffer   = malloc(size + 1u);
+    entry->strings = malloc(size + 1u);
+    if (!buffer || !entry->strings) {
+        FREE(buffer);
+        fclose(file);
+        return false;
+    }
+    size_t len  = fread(buffer, 1u, size, file);
+    buffer[len] = '\0';
+    bool read   = !ferror(file);
+    fclose(file);
+
+    read = read && parse_material_lib(&entry->lib, entry->strings, buffer, buffer + len);
+    free(buffer);
+    return read;
+}
+
+/*
+ * Loads the material library of @entry, the cache entry given as @context, on its loader thread
+ */
+static void load_material_lib_task(void *context, uint32_t taskIdx) {
+    (void)taskIdx;
+    Obj_MtlEntry *entry  = context;
+    bool          loaded = read_material_lib(entry);
+
+    Obj_MtlCache *cache = &materialCache;
+    lock_mutex(&cache->mutex);
+    entry->lib.successfulRead = loaded;
+    entry->loaded             = true;
+    entry->stale              = !loaded;
+    broadcast_cond(&cache->loadedCond);
+    unlock_mutex(&cache->mutex);
+}
+
+/*
+ * Unlinks @entry from the material cache and frees it. The cache mutex must be held.
+ */
+static void remove_material_lib(Obj_MtlCache *cache, Obj_MtlEntry *entry) {
+    Obj_MtlEntry **link = &cache->entries;
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+
+    FREE(entry->lib.materials);
+    FREE(entry->strings);
+    free(entry);
+}
+
+/*
+ * Returns the cache entry of the material library at @path, holding a reference on it, or NULL when
+ * it could not be allocated. Libraries missing from the cache, or whose file changed since they
+ * were parsed, start being parsed on a loader thread of their own.
+ */
+static Obj_MtlEntry *acquire_material_lib(const char *path) {
+    Obj_FileStamp fileStamp = {0};
+    get_file_stamp(path, &fileStamp);
+
+    Obj_MtlCache *cache = &materialCache;
+    lock_mutex(&cache->mutex);
+
+    Obj_MtlEntry *entry = cache->entries;
+    while (entry && (entry->stale || strcmp(entry->lib.path, path) != 0)) {
+        entry = entry->next;
+    }
+    if (entry && entry->loaded && !same_file_stamp(&entry->fileStamp, &fileStamp)) {
+        entry->stale = true;
+        if (entry->refCount == 0u) {
+            remove_material_lib(cache, entry);
+        }
+        entry = NULL;
+    }
+
+    bool created = !entry;
+    if (created) {
+        size_t pathSize = strlen(path) + 1u;
+        entry           = malloc(sizeof(*entry) + pathSize);
+        if (!entry) {
+            unlock_mutex(&cache->mutex);
+            return NULL;
+        }
+        char *pathCopy = (char *)(entry + 1);
+        memcpy(pathCopy, path, pathSize);
+        *entry = (Obj_MtlEntry) {
+            .lib       = {.path = pathCopy},
+            .fileStamp = fileStamp,
+            .launch    = {load_material_lib_task, entry, 0u},
+            .next      = cache->entries,
+        };
+        cache->entries = entry;
+    }
+    ++entry->refCount;
+    unlock_mutex(&cache->mutex);
+
+    // Libraries which cannot get a thread are loaded on the calling one
+    Obj_Thread thread;
+    if (created && start_thread(&thread, &entry->launch)) {
+        detach_thread(thread);
+    } else if (created) {
+        load_material_lib_task(entry, 0u);
+    }
+    return entry;
+}
+
+static void release_material_lib(Obj_MtlEntry *entry) {
+    Obj_MtlCache *cache = &materialCache;
+    lock_mutex(&cache->mutex);
+    if (--entry->refCount == 0u && entry->stale) {
+        remove_material_lib(cache, entry);
+    }
+    unlock_mutex(&cache->mutex);
+}
+
+/*
+ * Waits for the loader threads of all the material libraries of @libs to be done
+ */
+static void wait_material_libs(const Obj_MtlLibList *libs) {
+    Obj_MtlCache *cache = &materialCache;
+    lock_mutex(&cache->mutex);
+    for (uint32_t i = 0u; i < libs->count; ++i) {
+        while (!libs->entries[i]->loaded) {
+            wait_cond(&cache->loadedCond, &cache->mutex);
+        }
+    }
+    unlock_mutex(&cache->mutex);
+}
+
+/*
+ * Adds @entry to @libs, which takes over its reference, unless @libs already holds it
+ */
+static bool add_material_lib(Obj_MtlLibList *libs, Obj_MtlEntry *entry) {
+    for (uint32_t i = 0u; i < libs->count; ++i) {
+        if (libs->entries[i] == entry) {
+            release_material_lib(entry);
+            return true;
+        }
+    }
+
+    if (libs->count == libs->capacity) {
+        uint32_t       capacity = grown_capacity(libs->capacity, libs->count + 1u);
+        Obj_MtlEntry **grown    = realloc(libs->entries, capacity * sizeof(*grown));
+        if (!grown) {
+            release_material_lib(entry);
+            return false;
+        }
+        libs->entries  = grown;
+        libs->capacity = capacity;
+    }
+    libs->entries[libs->count++] = entry;
+    return true;
+}
+
+static void release_material_libs(Obj_MtlLibList *libs) {
+    for (uint32_t i = 0u; i < libs->count; ++i) {
+        release_material_lib(libs->entries[i]);
+    }
+    libs->count = 0u;
+}
+
+static void free_material_libs(Obj_MtlLibList *libs) {
+    release_material_libs(libs);
+    FREE(libs->entries);
+    *libs = (Obj_MtlLibList) {};
+}
+
+/*
+ * Returns the path of the material library named [name, nameEnd) by a mtllib statement, relative to
+ * the directory of the wavefront file at @objPath, to be freed by the caller
+ */
+static char *get_material_lib_path(const char *objPath, const char *name, const char *nameEnd) {
+    size_t nameLen  = (size_t)(nameEnd - name);
+    bool   absolute = name[0] == '/' || name[0] == '\\' || (nameLen > 1u && name[1] == ':');
+
+    size_t dirLen = 0u;
+    if (!absolute && objPath != MEMORY_BUFFER_NAME) {
+        for (size_t i = 0u; objPath[i]; ++i) {
+            dirLen = objPath[i] == '/' || objPath[i] == '\\' ? i + 1u : dirLen;
+        }
+    }
+
+    char *path = malloc(dirLen + nameLen + 1u);
+    if (path) {
+        memcpy(path, objPath, dirLen);
+        memcpy(path + dirLen, name, nameLen);
+        path[dirLen + nameLen] = '\0';
+    }
+    return path;
+}
+
+/*
+ * Starts loading the material libraries named by the mtllib statement on the line [line, end), and
+ * adds them to the libraries of @state. Only allocation failures abort the read.
+ */
+static bool record_material_libs(Obj_ParseState *state, const char *line, const char *end) {
+    const char *nameEnd;
+    const char *name = next_token(line + LINE_SPEC[OBJ_MTLSPEC].len, end, &nameEnd);
+    for (; name < nameEnd; name = next_token(nameEnd, end, &nameEnd)) {
+        char         *path  = get_material_lib_path(state->parser->path, name, nameEnd);
+        Obj_MtlEntry *entry = path ? acquire_material_lib(path) : NULL;
+        free(path);
+
+        if (!entry || !add_material_lib(state->libs, entry)) {
+            report_line_error(state, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Hands the material libraries of the read over to @mesh, once they are all loaded. Libraries which
+ * could not be read are reported, but stay in the mesh.
+ */
+static bool attach_material_libs(Obj_Parser *parser, Obj_Mesh *mesh) {
+    Obj_MtlLibList *libs = &parser->libs;
+
+    mesh->materialLibs    = NULL;
+    mesh->numMaterialLibs = 0u;
+    if (libs->count == 0u) {
+        return true;
+    }
+    wait_material_libs(libs);
+
+    const Obj_MaterialLib **materialLibs =
+        mem_allocate(&mesh->allocator, libs->count * sizeof(*materialLibs), ARRAY_ALIGNMENT);
+    if (!materialLibs) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    for (uint32_t i = 0u; i < libs->count; ++i) {
+        materialLibs[i] = &libs->entries[i]->lib;
+        if (!materialLibs[i]->successfulRead) {
+            report_error(parser, OBJ_ERROR_MATERIAL_LIB);
+        }
+    }
+    mesh->materialLibs    = materialLibs;
+    mesh->numMaterialLibs = libs->count;
+    libs->count           = 0u;
+    return true;
+}
+
+/*
+ * Releases the material libraries of @mesh, the entries of which its libraries are the first member
+ */
+static void detach_material_libs(Obj_Mesh *mesh) {
+    for (uint32_t i = 0u; i < mesh->numMaterialLibs; ++i) {
+        release_material_lib((Obj_MtlEntry *)(void *)mesh->materialLibs[i]);
+    }
+    mem_deallocate(&mesh->allocator, (void *)mesh->materialLibs);
+    mesh->materialLibs    = NULL;
+    mesh->numMaterialLibs = 0u;
+}
+
+static const Obj_Material *find_material(const Obj_Mesh *mesh, const char *name) {
+    for (uint32_t i = 0u; i < mesh->numMaterialLibs; ++i) {
+        const Obj_MaterialLib *lib = mesh->materialLibs[i];
+        for (uint32_t j = 0u; j < lib->numMaterials; ++j) {
+            if (strcmp(lib->materials[j].name, name) == 0) {
+                return lib->materials + j;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Frees the cached material libraries no mesh refers to anymore
+ */
+static void clear_material_cache(void) {
+    Obj_MtlCache *cache = &materialCache;
+    lock_mutex(&cache->mutex);
+    Obj_MtlEntry *entry = cache->entries;
+    while (entry) {
+        Obj_MtlEntry *next = entry->next;
+        if (entry->refCount == 0u && entry->loaded) {
+            remove_material_lib(cache, entry);
+        }
+        entry = next;
+    }
+    unlock_mutex(&cache->mutex);
+}
+
+/*
+ * Grows the arrays of @state so they can hold the @needed number of elements. Chunks parsed by
+ * worker threads write into ranges of shared arrays that were sized by a counting pass, and cannot
+ * grow them.
+ */
+static bool reserve_parse_state(Obj_ParseState *state, Obj_MeshSizes needed) {
+    if (state->fixedCapacity) {
+        report_line_error(state, OBJ_ERROR_UNCOUNTED_ELEMENTS);
+        return false;
+    }
+    return reserve_mesh_data(state->parser, &state->data, &state->capacity, needed);
+}
+
+/*
+ * Stores the next vertex position of @state, quantized when the read asks for it
+ */
+static void store_position(Obj_ParseState *state, const float values[3]) {
+    const Obj_Parser *parser = state->parser;
+    Obj_MeshData     *data   = &state->data;
+    uint32_t          idx    = state->count.nPos;
+
+    if (!(parser->options.quantizeFlags & OBJ_QUANTIZE_POSITIONS)) {
+        data->posX[idx] = values[0];
+        data->posY[idx] = values[1];
+        data->posZ[idx] = values[2];
+        return;
+    }
+    const float *min   = parser->posBounds.min;
+    const float *scale = parser->posScale;
+    data->quantized.posX[idx] = to_unorm16((values[0] - min[0]) * scale[0]);
+    data->quantized.posY[idx] = to_unorm16((values[1] - min[1]) * scale[1]);
+    data->quantized.posZ[idx] = to_unorm16((values[2] - min[2]) * scale[2]);
+}
+
+static void store_normal(Obj_ParseState *state, const float values[3]) {
+    Obj_MeshData *data = &state->data;
+    uint32_t      idx  = state->count.nNorms;
+
+    if (!(state->parser->options.quantizeFlags & OBJ_QUANTIZE_NORMALS)) {
+        data->normX[idx] = values[0];
+        data->normY[idx] = values[1];
+        data->normZ[idx] = values[2];
+        return;
+    }
+    data->quantized.normX[idx] = float_to_half(values[0]);
+    data->quantized.normY[idx] = float_to_half(values[1]);
+    data->quantized.normZ[idx] = float_to_half(values[2]);
+}
+
+static void store_texcoord(Obj_ParseState *state, const float values[2]) {
+    Obj_MeshData *data = &state->data;
+    uint32_t      idx  = state->count.nTex;
+
+    if (!(state->parser->options.quantizeFlags & OBJ_QUANTIZE_TEXCOORDS)) {
+        data->texU[idx] = values[0];
+        data->texV[idx] = values[1];
+        return;
+    }
+    data->quantized.texU[idx] = to_unorm16(values[0] * UNORM16_MAX);
+    data->quantized.texV[idx] = to_unorm16(values[1] * UNORM16_MAX);
+}
+
+/*
+ * Grows @marks so that it holds at least @numMarks statements and @namesSize bytes of names
+ */
+static bool reserve_range_marks(Obj_RangeMarks *marks, size_t numMarks, size_t namesSize) {
+    if (numMarks > UINT32_MAX || namesSize > UINT32_MAX) {
+        return false;
+    }
+
+    if (numMarks > marks->marksCapacity) {
+        uint32_t       capacity = grown_capacity(marks->marksCapacity, (uint32_t)numMarks);
+        Obj_RangeMark *grown    = realloc(marks->marks, capacity * sizeof(*grown));
+        if (!grown) {
+            return false;
+        }
+        marks->marks         = grown;
+        marks->marksCapacity = capacity;
+    }
+    if (namesSize > marks->namesCapacity) {
+        uint32_t capacity = grown_capacity(marks->namesCapacity, (uint32_t)namesSize);
+        char    *grown    = realloc(marks->names, capacity);
+        if (!grown) {
+            return false;
+        }
+        marks->names         = grown;
+        marks->namesCapacity = capacity;
+    }
+    return true;
+}
+
+static void free_range_marks(Obj_RangeMarks *marks) {
+    FREE(marks->marks);
+    FREE(marks->names);
+    *marks = (Obj_RangeMarks) {};
+}
+
+/*
+ * Parses the smoothing group of a s statement, either a number or "off" for group 0, out of the
+ * [cursor, end) line remainder stripped of its blanks
+ */
+static bool parse_smoothing_group(const char *cursor, const char *end, uint32_t *group) {
+    if (end - cursor == 3 && memcmp(cursor, "off", 3u) == 0) {
+        *group = 0u;
+        return true;
+    }
+
+    uint32_t value = 0u;
+    for (const char *c = cursor; c < end; ++c) {
+        if (!is_digit(*c) || value > (UINT32_MAX - (uint32_t)(*c - '0')) / 10u) {
+            return false;
+        }
+        value = 10u * value + (uint32_t)(*c - '0');
+    }
+    *group = value;
+    return cursor < end;
+}
+
+/*
+ * Records the o, g, usemtl or s statement of @type on the line [line, end) as the start of a range
+ * of the faces read after it. Only allocation failures abort the read.
+ */
+static bool record_range_mark(
+    Obj_ParseState *state,
+    Obj_LineType    type,
+    const char     *line,
+    const char     *end
+) {
+    Obj_RangeMarks *marks = state->marks;
+    const char     *name  = skip_blanks(line + LINE_SPEC[type].len, end);
+    const char     *last  = end;
+    while (last > name && is_blank(last[-1])) {
+        --last;
+    }
+
+    Obj_RangeMark mark = {
+        .firstFace   = state->count.nFaces,
+        .firstCorner = state->count.flatFacesSize,
+        .value       = marks->namesSize,
+    };
+    size_t nameSize = (size_t)(last - name) + 1u;
+    switch (type) {
+        case OBJ_OBJECT:
+            mark.kind = OBJ_RANGE_OBJECT;
+            break;
+        case OBJ_GROUP:
+            mark.kind = OBJ_RANGE_GROUP;
+            break;
+        case OBJ_MTLUSE:
+            mark.kind = OBJ_RANGE_MATERIAL;
+            break;
+        default:
+            mark.kind = OBJ_RANGE_SMOOTHING;
+            nameSize  = 0u;
+            if (!parse_smoothing_group(name, last, &mark.value)) {
+                return skip_line_error(state, OBJ_ERROR_INVALID_SMOOTHING_GROUP);
+            }
+            break;
+    }
+
+    if (!reserve_range_marks(marks, marks->numMarks + 1u, marks->namesSize + nameSize)) {
+        report_line_error(state, OBJ_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+    if (nameSize > 0u) {
+        memcpy(marks->names + marks->namesSize, name, nameSize - 1u);
+        marks->names[marks->namesSize + nameSize - 1u] = '\0';
+        marks->namesSize += (uint32_t)nameSize;
+    }
+    marks->marks[marks->numMarks++] = mark;
+    return true;
+}
+
+/*
+ * Parses a single line into @state, growing the mesh arrays when their capacity is exhausted.
+ * Returns false on errors that should abort the read.
+ */
+static bool parse_line(Obj_ParseState *state, const char *line, const char *end) {
+    Obj_MeshData  *data      = &state->data;
+    Obj_MeshSizes *count     = &state->count;
+    uint32_t       loadFlags = state->parser->options.loadFlags;
+    float          values[4];
+    uint32_t       numValues;
+    uint32_t       numVertices;
+    bool           validFace;
+
+    Obj_LineType type = get_line_type(line, end);
+    if (state->stats) {
+        count_line_stats(state->stats, type);
+    }
+
+    switch (type) {
+        case OBJ_VECPOS:
+            if (count->nPos == state->capacity.nPos
+                && !reserve_parse_state(state, (Obj_MeshSizes) {.nPos = count->nPos + 1u})) {
+                return false;
+            }
+            numValues = parse_floats(line + 2, end, values, data->posW ? 4u : 3u);
+            if (numValues < 3u) {
+                report_line_error(state, OBJ_ERROR_INVALID_POSITION);
+                return false;
+            }
+            store_position(state, values);
+            if (data->posW) {
+                data->posW[count->nPos] = numValues == 4u ? values[3] : 1.0f;
+            }
+            ++count->nPos;
+            break;
+        case OBJ_VECNORM:
+            if (loadFlags & OBJ_LOAD_SKIP_NORMALS) {
+                break;
+            }
+            if (count->nNorms == state->capacity.nNorms
+                && !reserve_parse_state(state, (Obj_MeshSizes) {.nNorms = count->nNorms + 1u})) {
+                return false;
+            }
+            if (parse_floats(line + 3, end, values, 3u) < 3u) {
+                report_line_error(state, OBJ_ERROR_INVALID_NORMAL);
+                return false;
+            }
+            store_normal(state, values);
+            ++count->nNorms;
+            break;
+        case OBJ_VECTEXT:
+            if (loadFlags & OBJ_LOAD_SKIP_TEXCOORDS) {
+                break;
+            }
+            if (count->nTex == state->capacity.nTex
+                && !reserve_parse_state(state, (Obj_MeshSizes) {.nTex = count->nTex + 1u})) {
+                return false;
+            }
+            numValues = parse_floats(line + 3, end, values, 2u);
+            if (numValues < 1u) {
+                report_line_error(state, OBJ_ERROR_INVALID_TEXCOORD);
+                return false;
+            }
+            values[1] = numValues == 2u ? values[1] : 0.0f;
+            store_texcoord(state, values);
+            ++count->nTex;
+            break;
+        case OBJ_FACE:
+            if (loadFlags & OBJ_LOAD_SKIP_FACES) {
+                break;
+            }
+            numVertices = count_face_vertices(line, end);
+            if ((count->nFaces == state->capacity.nFaces
+                 || count->flatFacesSize + numVertices > state->capacity.flatFacesSize)
+                && !reserve_parse_state(
+                    state,
+                    (Obj_MeshSizes) {
+                        .nFaces        = count->nFaces + 1u,
+                        .flatFacesSize = count->flatFacesSize + numVertices,
+                    }
+                )) {
+                return false;
+            }
+            validFace = parse_face(state, line, end, &numVertices);
+            if (!validFace && !skip_line_error(state, OBJ_ERROR_INVALID_FACE)) {
+                return false;
+            }
+            if (validFace && numVertices < 3u
+                && !skip_line_error(state, OBJ_ERROR_DEGENERATE_FACE)) {
+                return false;
+            }
+            // Invalid faces stay, without vertices, so that faces are numbered as in the file
+            data->faceSizes[count->nFaces++] = numVertices;
+            count->flatFacesSize += numVertices;
+            break;
+
+        case OBJ_INVALID_LINE:
+            return skip_line_error(state, OBJ_ERROR_UNKNOWN_LINE);
+
+        case OBJ_MTLUSE:
+        case OBJ_OBJECT:
+        case OBJ_GROUP:
+        case OBJ_SSHADING:
+            // Statements only mark where ranges start, so faces cost nothing more to parse
+            if (state->marks && !(loadFlags & OBJ_LOAD_SKIP_FACES)) {
+                return record_range_mark(state, type, line, end);
+            }
+            break;
+
+        case OBJ_MTLSPEC:
+            if (state->libs) {
+                return record_material_libs(state, line, end);
+            }
+            break;
+
+        case OBJ_COMMENT:
+        case OBJ_VECPARAM:
+        case OBJ_LINE:
+        default:
+            break;
+    }
+    return true;
+}
+
+/*
+ * Whether a read of a mesh of @sizes generates its normals, as the options of @parser ask for the
+ * meshes read without normals
+ */
+static bool generates_normals(const Obj_Parser *parser, Obj_MeshSizes sizes) {
+    const Obj_ReadOptions *options   = &parser->options;
+    uint32_t               skipFlags = OBJ_LOAD_SKIP_NORMALS | OBJ_LOAD_SKIP_FACES;
+    return options->generateNormals && !(options->loadFlags & skipFlags) && sizes.nNorms == 0u
+        && sizes.nPos > 0u;
+}
+
+/*
+ * Returns the counted @sizes of a read allocating its mesh block up front, with room for the
+ * normals it generates, one per position
+ */
+static Obj_MeshSizes reserve_generated_normals(Obj_Parser *parser, Obj_MeshSizes sizes) {
+    parser->reservedNormals = generates_normals(parser, sizes);
+    if (parser->reservedNormals) {
+        sizes.nNorms = sizes.nPos;
+    }
+    return sizes;
+}
+
+/*
+ * Allocates the mesh arrays of @state, either in a single block when their sizes are known, or as
+ * separate arrays that can grow
+ */
+static bool init_parse_state(
+    Obj_ParseState *state,
+    Obj_Parser     *parser,
+    Obj_MeshSizes   initialCapacity,
+    void          **block
+) {
+    *state = (Obj_ParseState) {.parser = parser, .marks = &parser->marks};
+    if (parser->options.stats) {
+        state->stats = &parser->stats;
+    }
+    parser->marks.numMarks  = 0u;
+    parser->marks.namesSize = 0u;
+
+    release_material_libs(&parser->libs);
+    if (parser->options.loadMaterials) {
+        state->libs = &parser->libs;
+    }
+
+    if (parser->options.singleBlock && !parser->options.singlePass) {
+        state->capacity      = reserve_generated_normals(parser, initialCapacity);
+        state->fixedCapacity = true;
+        return alloc_mesh_block(parser, state->capacity, &state->data, block);
+    }
+    return reserve_mesh_data(parser, &state->data, &state->capacity, initialCapacity);
+}
+
+/*
+ * Parses the lines of the [begin, end) buffer in place into @state, without copying them
+ */
+static bool parse_buffer(Obj_ParseState *state, const char *begin, const char *end) {
+    uint64_t offset = state->offset;
+    state->offset += (uint64_t)(end - begin);
+
+    for (const char *line = begin; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        ++state->lineNum;
+        // A single-threaded read never reaches the lines past a chunk which failed
+        if (state->firstFailed && state->lineNum % FAILED_CHUNK_CHECK_LINES == 0u
+            && atomic_load(state->firstFailed) < state->chunkIdx) {
+            return false;
+        }
+        state->lineOffset = offset + (uint64_t)(line - begin);
+
+        if (!lineEnd) {
+            // The last line is not newline terminated, and reading past the end of the buffer is
+            // not allowed, so it is the only one which gets copied to be null terminated
+            size_t lineLen  = (size_t)(end - line);
+            char  *lastLine = malloc(lineLen + 1u);
+            if (!lastLine) {
+                report_line_error(state, OBJ_ERROR_OUT_OF_MEMORY);
+                return false;
+            }
+            memcpy(lastLine, line, lineLen);
+            lastLine[lineLen] = '\0';
+
+            bool parsedLine = parse_line(state, lastLine, lastLine + lineLen);
+            free(lastLine);
+            return parsedLine;
+        }
+
+        if (!parse_line(state, line, lineEnd)) {
+            return false;
+        }
+        line = lineEnd + 1;
+    }
+    return true;
+}
+
+/*
+ * Parses the lines of the [begin, end) buffer into the Obj_ParseState at @context, as read_lines
+ * hands them out
+ */
+static bool parse_lines(void *context, const char *begin, const char *end) {
+    return parse_buffer(context, begin, end);
+}
+
+/*
+ * Same as try_get_data, but parses the lines in place in the [begin, end) buffer without copying
+ * them.
+ */
+static Obj_MeshData try_get_data_from_buffer(
+    Obj_Parser    *parser,
+    const char    *begin,
+    const char    *end,
+    Obj_MeshSizes *sizes,
+    void         **block,
+    bool          *successfulRead
+) {
+    double         start     = start_timer(parser);
+    Obj_ParseState state;
+    bool           allocated = init_parse_state(&state, parser, *sizes, block);
+    parser->stats.allocSeconds += stop_timer(parser, start);
+
+    start       = start_timer(parser);
+    bool parsed = allocated && parse_buffer(&state, begin, end);
+    parser->stats.parseSeconds += stop_timer(parser, start);
+    if (!parsed) {
+        return state.data;
+    }
+
+    *sizes          = state.count;
+    *successfulRead = true;
+    return state.data;
+}
+
+/*
+ * Reads the next block of the file in buffer @idx. Returns false once the end of the file or a read
+ * error is reached.
+ */
+static bool read_block(Obj_ReadAhead *readAhead, uint32_t idx) {
+    char  *buffer = readAhead->buffers + (size_t)idx * READ_AHEAD_BUFFER_SIZE;
+    size_t len    = fread(buffer, 1u, READ_AHEAD_BUFFER_SIZE, readAhead->file);
+
+    readAhead->lens[idx] = len;
+    return len == READ_AHEAD_BUFFER_SIZE;
+}
+
+/*
+ * Producer thread, reading blocks as long as some buffer is free
+ */
+static void read_ahead_task(void *context, uint32_t taskIdx) {
+    Obj_ReadAhead *readAhead = context;
+    (void)taskIdx;
+
+    lock_mutex(&readAhead->mutex);
+    while (!readAhead->endOfFile) {
+        while (!readAhead->stop
+               && readAhead->numFilled - readAhead->numConsumed == READ_AHEAD_NUM_BUFFERS) {
+            wait_cond(&readAhead->cond, &readAhead->mutex);
+        }
+        if (readAhead->stop) {
+            break;
+        }
+        uint32_t idx = readAhead->numFilled % READ_AHEAD_NUM_BUFFERS;
+        unlock_mutex(&readAhead->mutex);
+
+        bool moreBlocks = read_block(readAhead, idx);
+        bool failed     = ferror(readAhead->file) != 0;
+
+        lock_mutex(&readAhead->mutex);
+        ++readAhead->numFilled;
+        readAhead->endOfFile = !moreBlocks;
+        readAhead->failed    = failed;
+        signal_cond(&readAhead->cond);
+    }
+    unlock_mutex(&readAhead->mutex);
+}
+
+/*
+ * Starts reading @file ahead into the read buffers of @parser, on a producer thread when one can be
+ * started
+ */
+static bool start_read_ahead(
+    Obj_Parser     *parser,
+    Obj_ReadAhead  *readAhead,
+    Obj_TaskLaunch *launch,
+    FILE           *file
+) {
+    if (!parser->readBuffers) {
+        parser->readBuffers = malloc((size_t)READ_AHEAD_NUM_BUFFERS * READ_AHEAD_BUFFER_SIZE);
+        if (!parser->readBuffers) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        size_t size = (size_t)READ_AHEAD_NUM_BUFFERS * READ_AHEAD_BUFFER_SIZE;
+        track_bytes(parser, &parser->bufferBytes, size, 0u);
+    }
+
+    *readAhead = (Obj_ReadAhead) {.file = file, .buffers = parser->readBuffers};
+    *launch    = (Obj_TaskLaunch) {read_ahead_task, readAhead, 0u};
+
+    if (init_sync(&readAhead->mutex, &readAhead->cond)) {
+        readAhead->threaded = start_thread(&readAhead->thread, launch);
+        if (!readAhead->threaded) {
+            destroy_sync(&readAhead->mutex, &readAhead->cond);
+        }
+    }
+    return true;
+}
+
+/*
+ * Waits for the next block of the file to be read. Returns false once all of them were consumed.
+ */
+static bool next_read_ahead_block(Obj_ReadAhead *readAhead, const char **data, size_t *len) {
+    if (!readAhead->threaded) {
+        if (readAhead->endOfFile) {
+            return false;
+        }
+        readAhead->endOfFile = !read_block(readAhead, 0u);
+        readAhead->failed    = ferror(readAhead->file) != 0;
+        *data                = readAhead->buffers;
+        *len                 = readAhead->lens[0];
+        return true;
+    }
+
+    lock_mutex(&readAhead->mutex);
+    while (readAhead->numFilled == readAhead->numConsumed && !readAhead->endOfFile) {
+        wait_cond(&readAhead->cond, &readAhead->mutex);
+    }
+    bool     available = readAhead->numFilled != readAhead->numConsumed;
+    uint32_t idx       = readAhead->numConsumed % READ_AHEAD_NUM_BUFFERS;
+    unlock_mutex(&readAhead->mutex);
+
+    if (available) {
+        *data = readAhead->buffers + (size_t)idx * READ_AHEAD_BUFFER_SIZE;
+        *len  = readAhead->lens[idx];
+    }
+    return available;
+}
+
+/*
+ * Hands the buffer of the block last returned by next_read_ahead_block back to the producer
+ */
+static void release_read_ahead_block(Obj_ReadAhead *readAhead) {
+    if (readAhead->threaded) {
+        lock_mutex(&readAhead->mutex);
+        ++readAhead->numConsumed;
+        signal_cond(&readAhead->cond);
+        unlock_mutex(&readAhead->mutex);
+    }
+}
+
+/*
+ * Stops the producer thread, if any, whether the file was read entirely or not. Returns whether
+ * reading the file failed.
+ */
+static bool stop_read_ahead(Obj_ReadAhead *readAhead) {
+    if (readAhead->threaded) {
+        lock_mutex(&readAhead->mutex);
+        readAhead->stop = true;
+        signal_cond(&readAhead->cond);
+        unlock_mutex(&readAhead->mutex);
+
+        join_thread(readAhead->thread);
+        destroy_sync(&readAhead->mutex, &readAhead->cond);
+    }
+    return readAhead->failed;
+}
+
+/*
+ * Returns the length of the complete lines at the start of the @len characters of @buffer, or 0
+ * when they hold no newline.
+ */
+static size_t complete_lines_len(const char *buffer, size_t len) {
+    while (len > 0u && buffer[len - 1u] != '\n') {
+        --len;
+    }
+    return len;
+}
+
+/*
+ * Appends the [begin, end) characters to the @len ones of the line buffer of @parser
+ */
+static bool append_line_buff(Obj_Parser *parser, size_t *len, const char *begin, const char *end) {
+    size_t appendedLen = (size_t)(end - begin);
+    if (*len + appendedLen > parser->lineBuffSize) {
+        size_t size = parser->lineBuffSize ? parser->lineBuffSize : 256u;
+        while (size < *len + appendedLen) {
+            size *= 2u;
+        }
+        char *lineBuff = realloc(parser->lineBuff, size);
+        if (!lineBuff) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        track_bytes(parser, &parser->bufferBytes, size, parser->lineBuffSize);
+        parser->lineBuff     = lineBuff;
+        parser->lineBuffSize = size;
+    }
+    copy_bytes(parser->lineBuff + *len, begin, appendedLen);
+    *len += appendedLen;
+    return true;
+}
+
+typedef bool (*Obj_LinesFn)(void *context, const char *begin, const char *end);
+
+/*
+ * Reads @file through read-ahead buffers, and hands all its lines to @consume in order, along with
+ * @context, as ranges of complete, newline terminated lines. Lines are parsed in place in the read
+ * buffers, but for those which straddle two blocks, and the last one if it has no newline, which
+ * are first copied to the line buffer.
+ */
+static bool read_lines(Obj_Parser *parser, FILE *file, Obj_LinesFn consume, void *context) {
+    Obj_ReadAhead  readAhead;
+    Obj_TaskLaunch launch;
+    if (!start_read_ahead(parser, &readAhead, &launch, file)) {
+        return false;
+    }
+
+    bool        successfulRead = true;
+    size_t      lineLen        = 0u;  // length of the line carried over to the next block
+    const char *data;
+    size_t      len;
+    while (successfulRead && next_read_ahead_block(&readAhead, &data, &len)) {
+        parser->stats.bytesRead += len;
+
+        const char *end        = data + len;
+        const char *linesBegin = data;
+
+        if (lineLen > 0u) {
+            const char *newline = memchr(data, '\n', len);
+            linesBegin          = newline ? newline + 1 : end;
+            successfulRead      = append_line_buff(parser, &lineLen, data, linesBegin);
+            if (successfulRead && newline) {
+                successfulRead = consume(context, parser->lineBuff, parser->lineBuff + lineLen);
+                lineLen        = 0u;
+            }
+        }
+
+        // The incomplete line ending the block is carried over to the next one
+        const char *linesEnd =
+            linesBegin + complete_lines_len(linesBegin, (size_t)(end - linesBegin));
+        successfulRead       = successfulRead && consume(context, linesBegin, linesEnd);
+        successfulRead       = successfulRead && append_line_buff(parser, &lineLen, linesEnd, end);
+
+        release_read_ahead_block(&readAhead);
+    }
+
+    if (successfulRead && lineLen > 0u) {
+        // The last line has no newline, which is appended so it is complete
+        static const char NEWLINE = '\n';
+        successfulRead            = append_line_buff(parser, &lineLen, &NEWLINE, &NEWLINE + 1);
+        successfulRead = successfulRead
+                      && consume(context, parser->lineBuff, parser->lineBuff + lineLen);
+    }
+
+    if (stop_read_ahead(&readAhead)) {
+        report_error(parser, OBJ_ERROR_READ_FAILED);
+        return false;
+    }
+    return successfulRead;
+}
+
+static bool count_lines(void *context, const char *begin, const char *end) {
+    Obj_ParseState *state     = context;
+    Obj_Parser     *parser    = state->parser;
+    uint32_t        loadFlags = parser->options.loadFlags;
+    Obj_MeshSizes   sizes     = get_sizes_from_buffer(begin, end, loadFlags, NULL);
+
+    if (parser->options.quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+        get_bounds_from_buffer(begin, end, &parser->posBounds);
+    }
+    state->count = add_sizes(state->count, sizes);
+    return true;
+}
+
+static bool get_sizes(Obj_Parser *parser, FILE *fptr, Obj_MeshSizes *sizes) {
+    Obj_ParseState state = {.parser = parser};
+    double         start = start_timer(parser);
+
+    parser->posBounds = empty_bounds();
+    bool counted      = read_lines(parser, fptr, count_lines, &state);
+    parser->stats.countSeconds += stop_timer(parser, start);
+    if (!counted) {
+        return false;
+    }
+    set_position_bounds(parser, parser->posBounds);
+    *sizes = state.count;
+    return true;
+}
+
+/*
+ * Parses the mesh data out of the file. @sizes holds the initial capacity to allocate on input, and
+ * the number of elements actually read on output. The arrays grow as needed whenever the initial
+ * capacity is exceeded, which is how the single pass mode reads files it has not counted.
+ */
+static Obj_MeshData try_get_data(
+    Obj_Parser    *parser,
+    FILE          *fptr,
+    Obj_MeshSizes *sizes,
+    void         **block,
+    bool          *successfulRead
+) {
+    double         start     = start_timer(parser);
+    Obj_ParseState state;
+    bool           allocated = init_parse_state(&state, parser, *sizes, block);
+    parser->stats.allocSeconds += stop_timer(parser, start);
+
+    start       = start_timer(parser);
+    bool parsed = allocated && read_lines(parser, fptr, parse_lines, &state);
+    parser->stats.parseSeconds += stop_timer(parser, start);
+    if (!parsed) {
+        return state.data;
+    }
+
+    *sizes          = state.count;
+    *successfulRead = true;
+    return state.data;
+}
+
+static void count_chunk_task(void *context, uint32_t taskIdx) {
+    Obj_ChunkedRead *read      = context;
+    Obj_Chunk       *chunk     = read->chunks + taskIdx;
+    uint32_t         loadFlags = read->parser->options.loadFlags;
+
+    chunk->sizes = get_sizes_from_buffer(chunk->begin, chunk->end, loadFlags, &chunk->numLines);
+
+    chunk->posBounds = empty_bounds();
+    if (read->parser->options.quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+        get_bounds_from_buffer(chunk->begin, chunk->end, &chunk->posBounds);
+    }
+}
+
+static void parse_chunk_task(void *context, uint32_t taskIdx) {
+    Obj_ChunkedRead *read  = context;
+    Obj_Chunk       *chunk = read->chunks + taskIdx;
+
+    Obj_ParseState state = {
+        .parser          = read->parser,
+        .data            = read->data,
+        .capacity        = add_sizes(chunk->offset, chunk->sizes),
+        .count           = chunk->offset,
+        .lineNum         = chunk->firstLine,
+        .offset          = (uint64_t)(chunk->begin - read->begin),
+        .fixedCapacity   = true,
+        .stats           = read->parser->options.stats ? &chunk->stats : NULL,
+        .marks           = &chunk->marks,
+        .libs            = read->parser->options.loadMaterials ? &chunk->libs : NULL,
+        .relativeIndices = read->parser->options.incremental ? &chunk->relativeIndices : NULL,
+        .chunkIdx        = taskIdx,
+        .firstFailed     = &read->firstFailed,
+    };
+    chunk->successfulRead = parse_buffer(&state, chunk->begin, chunk->end);
+    chunk->read           = state.count;
+    chunk->numErrors      = state.numLineErrors;
+
+    uint32_t firstFailed = atomic_load(&read->firstFailed);
+    while (!chunk->successfulRead && taskIdx < firstFailed
+           && !atomic_compare_exchange(&read->firstFailed, firstFailed, taskIdx)) {
+        firstFailed = atomic_load(&read->firstFailed);
+    }
+}
+
+static void move_components(
+    Obj_ComponentArrays components,
+    uint32_t            dst,
+    uint32_t            src,
+    uint32_t            count
+) {
+    for (uint32_t i = 0u; dst != src && i < components.numArrays; ++i) {
+        char *array = *components.arrays[i];
+        memmove(
+            array + dst * components.elemSize,
+            array + src * components.elemSize,
+            count * components.elemSize
+        );
+    }
+}
+
+/*
+ * Moves the @count elements found at @src offsets in the mesh arrays to @dst offsets
+ */
+static void move_mesh_elements(
+    Obj_MeshData *data,
+    uint32_t      quantizeFlags,
+    Obj_MeshSizes dst,
+    Obj_MeshSizes src,
+    Obj_MeshSizes count
+) {
+    move_components(
+        get_component_arrays(data, OBJ_VECPOS, quantizeFlags),
+        dst.nPos,
+        src.nPos,
+        count.nPos
+    );
+    if (data->posW && dst.nPos != src.nPos) {
+        memmove(data->posW + dst.nPos, data->posW + src.nPos, count.nPos * sizeof(*data->posW));
+    }
+    move_components(
+        get_component_arrays(data, OBJ_VECNORM, quantizeFlags),
+        dst.nNorms,
+        src.nNorms,
+        count.nNorms
+    );
+    move_components(
+        get_component_arrays(data, OBJ_VECTEXT, quantizeFlags),
+        dst.nTex,
+        src.nTex,
+        count.nTex
+    );
+    if (dst.flatFacesSize != src.flatFacesSize) {
+        memmove(
+            data->faces + dst.flatFacesSize,
+            data->faces + src.flatFacesSize,
+            count.flatFacesSize * sizeof(*data->faces)
+        );
+    }
+    if (dst.nFaces != src.nFaces) {
+        memmove(
+            data->faceSizes + dst.nFaces,
+            data->faceSizes + src.nFaces,
+            count.nFaces * sizeof(*data->faceSizes)
+        );
+    }
+}
+
+/*
+ * Appends the statements of @other to @marks, moving their faces back by @faceShift and their face
+ * vertices by @cornerShift
+ */
+static bool append_range_marks(
+    Obj_RangeMarks       *marks,
+    const Obj_RangeMarks *other,
+    uint32_t              faceShift,
+    uint32_t              cornerShift
+) {
+    size_t numMarks  = (size_t)marks->numMarks + other->numMarks;
+    size_t namesSize = (size_t)marks->namesSize + other->namesSize;
+    if (!reserve_range_marks(marks, numMarks, namesSize)) {
+        return false;
+    }
+
+    for (uint32_t i = 0u; i < other->numMarks; ++i) {
+        Obj_RangeMark mark = other->marks[i];
+        mark.firstFace -= faceShift;
+        mark.firstCorner -= cornerShift;
+        if (mark.kind != OBJ_RANGE_SMOOTHING) {
+            mark.value += marks->namesSize;
+        }
+        marks->marks[marks->numMarks++] = mark;
+    }
+    copy_bytes(marks->names + marks->namesSize, other->names, other->namesSize);
+    marks->namesSize += other->namesSize;
+    return true;
+}
+
+/*
+ * Splits the [begin, end) buffer in up to @maxChunks chunks ending on line boundaries, and returns
+ * how many were made.
+ */
+static uint32_t split_chunks(
+    const char *begin,
+    const char *end,
+    Obj_Chunk  *chunks,
+    uint32_t    maxChunks
+) {
+    size_t   chunkSize = (size_t)(end - begin) / maxChunks;
+    uint32_t numChunks = 0u;
+
+    for (const char *chunkBegin = begin; chunkBegin < end; ++numChunks) {
+        const char *chunkEnd = end;
+        if (numChunks + 1u < maxChunks && (size_t)(end - chunkBegin) > chunkSize) {
+            chunkEnd = memchr(chunkBegin + chunkSize, '\n', (size_t)(end - chunkBegin - chunkSize));
+            chunkEnd = chunkEnd ? chunkEnd + 1 : end;
+        }
+        chunks[numChunks] = (Obj_Chunk) {.begin = chunkBegin, .end = chunkEnd};
+        chunkBegin        = chunkEnd;
+    }
+    return numChunks;
+}
+
+/*
+ * Gathers the elements, range statements and material libraries the @numChunks chunks of @read
+ * parsed, and sets @readSizes to the number of elements read. Chunks holding invalid elements read
+ * fewer than counted, and leave gaps to close. The errors of the chunks after the first one which
+ * failed are dropped, so that the errors reported do not depend on the number of threads. Returns
+ * whether all chunks were read.
+ */
+static bool merge_chunks(
+    Obj_Parser      *parser,
+    Obj_ChunkedRead *read,
+    uint32_t         numChunks,
+    Obj_MeshSizes   *readSizes
+) {
+    bool allRead            = true;
+    *readSizes              = (Obj_MeshSizes) {0u, 0u, 0u, 0u, 0u};
+    parser->marks.numMarks  = 0u;
+    parser->marks.namesSize = 0u;
+    release_material_libs(&parser->libs);
+    for (uint32_t i = 0u; i < numChunks; ++i) {
+        Obj_Chunk    *chunk         = read->chunks + i;
+        Obj_MeshSizes count         = sub_sizes(chunk->read, chunk->offset);
+        uint32_t      quantizeFlags = parser->options.quantizeFlags;
+        move_mesh_elements(&read->data, quantizeFlags, *readSizes, chunk->offset, count);
+
+        uint32_t faceShift   = chunk->offset.nFaces - readSizes->nFaces;
+        uint32_t cornerShift = chunk->offset.flatFacesSize - readSizes->flatFacesSize;
+        if (!append_range_marks(&parser->marks, &chunk->marks, faceShift, cornerShift)) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            allRead = false;
+        }
+        free_range_marks(&chunk->marks);
+
+        for (uint32_t j = 0u; j < chunk->libs.count; ++j) {
+            allRead = add_material_lib(&parser->libs, chunk->libs.entries[j]) && allRead;
+        }
+        chunk->libs.count = 0u;
+        free_material_libs(&chunk->libs);
+
+        *readSizes = add_sizes(*readSizes, count);
+        allRead    = allRead && chunk->successfulRead;
+        merge_line_stats(&parser->stats, &chunk->stats);
+    }
+
+    for (uint32_t i = 0u; i < numChunks; ++i) {
+        if (!read->chunks[i].successfulRead) {
+            uint32_t numDropped = 0u;
+            for (uint32_t j = i + 1u; j < numChunks; ++j) {
+                numDropped += read->chunks[j].numErrors;
+            }
+            drop_errors_past(parser, (uint64_t)(read->chunks[i].end - read->begin), numDropped);
+            break;
+        }
+    }
+    return allRead;
+}
+
+/*
+ * Parses the [begin, end) buffer on @numThreads threads. The buffer is split in chunks at line
+ * boundaries, which are counted in parallel. A prefix sum over the counts then gives each chunk the
+ * range of the mesh arrays it parses into, in parallel again.
+ */
+static Obj_MeshData try_get_data_chunked(
+    Obj_Parser    *parser,
+    const char    *begin,
+    const char    *end,
+    uint32_t       numThreads,
+    Obj_MeshSizes *sizes,
+    void         **block,
+    bool          *successfulRead
+) {
+    Obj_ChunkedRead read = {.parser = parser, .begin = begin, .firstFailed = UINT32_MAX};
+
+    double start = start_timer(parser);
+    size_t size  = numThreads * sizeof(*read.chunks);
+    read.chunks  = malloc(size);
+    if (!read.chunks) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return read.data;
+    }
+    track_bytes(parser, &parser->bufferBytes, size, 0u);
+    uint32_t numChunks = split_chunks(begin, end, read.chunks, numThreads);
+
+    run_tasks(count_chunk_task, &read, numChunks);
+
+    Obj_MeshSizes total     = {0u, 0u, 0u, 0u, 0u};
+    uint32_t      firstLine = 0u;
+    Obj_Bounds    posBounds = empty_bounds();
+    for (uint32_t i = 0u; i < numChunks; ++i) {
+        read.chunks[i].offset    = total;
+        read.chunks[i].firstLine = firstLine;
+        total                    = add_sizes(total, read.chunks[i].sizes);
+        firstLine += read.chunks[i].numLines;
+        merge_bounds(&posBounds, &read.chunks[i].posBounds);
+    }
+    set_position_bounds(parser, posBounds);
+    parser->stats.countSeconds += stop_timer(parser, start);
+
+    start                   = start_timer(parser);
+    Obj_MeshSizes capacity  = {0u, 0u, 0u, 0u, 0u};
+    bool          allocated = parser->options.singleBlock
+                                ? alloc_mesh_block(
+                                      parser,
+                                      reserve_generated_normals(parser, total),
+                                      &read.data,
+                                      block
+                                  )
+                                : reserve_mesh_data(parser, &read.data, &capacity, total);
+    parser->stats.allocSeconds += stop_timer(parser, start);
+    if (!allocated) {
+        free(read.chunks);
+        track_bytes(parser, &parser->bufferBytes, 0u, size);
+        return read.data;
+    }
+
+    start = start_timer(parser);
+    run_tasks(parse_chunk_task, &read, numChunks);
+
+    Obj_MeshSizes readSizes;
+    bool          allRead = merge_chunks(parser, &read, numChunks, &readSizes);
+    free(read.chunks);
+    track_bytes(parser, &parser->bufferBytes, 0u, size);
+    parser->stats.parseSeconds += stop_timer(parser, start);
+
+    if (allRead) {
+        *sizes          = readSizes;
+        *successfulRead = true;
+    }
+    return read.data;
+}
+
+/*
+ * Hashes the bytes of [begin, end) eight at a time, on four independent lanes so that their
+ * multiplications overlap
+ */
+static uint64_t hash_bytes(const char *begin, const char *end) {
+    static const uint64_t MULTIPLIER = UINT64_C(0x9E3779B97F4A7C15);
+
+    size_t   len      = (size_t)(end - begin);
+    uint64_t lanes[4] = {MULTIPLIER, MULTIPLIER + 1u, MULTIPLIER + 2u, MULTIPLIER + 3u};
+    for (; end - begin >= 32; begin += 32) {
+        for (uint32_t i = 0u; i < 4u; ++i) {
+            uint64_t word;
+            memcpy(&word, begin + 8u * i, sizeof(word));
+            lanes[i] = (lanes[i] ^ word) * MULTIPLIER;
+            lanes[i] ^= lanes[i] >> 29;
+        }
+    }
+    for (uint32_t i = 0u; begin < end; ++i, begin += 8) {
+        uint64_t word = 0u;
+        memcpy(&word, begin, end - begin < 8 ? (size_t)(end - begin) : sizeof(word));
+        lanes[i] = (lanes[i] ^ word) * MULTIPLIER;
+        lanes[i] ^= lanes[i] >> 29;
+    }
+
+    uint64_t hash = len;
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        hash = (hash ^ lanes[i]) * MULTIPLIER;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+/*
+ * Whether the line [line, lineEnd) may start a chunk of an incremental read, as told by a hash of
+ * its first and last bytes and of its length, so that edits elsewhere do not move the cut
+ */
+static bool is_cut_line(const char *line, const char *lineEnd) {
+    static const uint64_t MULTIPLIER = UINT64_C(0x9E3779B97F4A7C15);
+
+    size_t   len  = (size_t)(lineEnd - line);
+    size_t   size = len < 8u ? len : 8u;
+    uint64_t head = 0u;
+    uint64_t tail = 0u;
+    memcpy(&head, line, size);
+    memcpy(&tail, lineEnd - size, size);
+
+    uint64_t hash = ((head * MULTIPLIER) ^ tail ^ len) * MULTIPLIER;
+    hash ^= hash >> 32;
+    return (hash * MULTIPLIER >> 40) % INCREMENTAL_CUT_LINES == 0u;
+}
+
+/*
+ * Collects the lines of a range which may start a chunk of an incremental read
+ */
+static void find_cuts_task(void *context, uint32_t taskIdx) {
+    Obj_CutSearch *search = (Obj_CutSearch *)context + taskIdx;
+    search->allocated     = true;
+    for (const char *line = search->begin; line < search->end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(search->end - line));
+        lineEnd             = lineEnd ? lineEnd : search->end;
+        if (is_cut_line(line, lineEnd)) {
+            if (search->numCuts == search->capacity) {
+                uint32_t     capacity = grown_capacity(search->capacity, search->numCuts + 1u);
+                const char **grown    = realloc((void *)search->cuts, capacity * sizeof(*grown));
+                if (!grown) {
+                    search->allocated = false;
+                    return;
+                }
+                search->cuts     = grown;
+                search->capacity = capacity;
+            }
+            search->cuts[search->numCuts++] = line;
+        }
+        line = lineEnd + 1;
+    }
+}
+
+/*
+ * Splits the [begin, end) buffer in the chunks of an incremental read, allocated in @read. The
+ * lines which may start a chunk are found on @numThreads threads, and then start one when the
+ * previous chunk is large enough. Returns the number of chunks, or UINT32_MAX when the chunks could
+ * not be allocated.
+ */
+static uint32_t split_content_chunks(
+    Obj_ChunkedRead *read,
+    const char      *begin,
+    const char      *end,
+    uint32_t         numThreads
+) {
+    Obj_Chunk     *regions  = calloc(numThreads, sizeof(*regions));
+    Obj_CutSearch *searches = calloc(numThreads, sizeof(*searches));
+    if (!regions || !searches) {
+        FREE(regions);
+        FREE(searches);
+        return UINT32_MAX;
+    }
+
+    uint32_t numRegions = split_chunks(begin, end, regions, numThreads);
+    for (uint32_t i = 0u; i < numRegions; ++i) {
+        searches[i] = (Obj_CutSearch) {.begin = regions[i].begin, .end = regions[i].end};
+    }
+    run_tasks(find_cuts_task, searches, numRegions);
+
+    size_t maxChunks = 1u;
+    bool   allocated = true;
+    for (uint32_t i = 0u; i < numRegions; ++i) {
+        maxChunks += searches[i].numCuts;
+        allocated  = allocated && searches[i].allocated;
+    }
+    read->chunks = allocated && maxChunks < UINT32_MAX ? malloc(maxChunks * sizeof(*read->chunks))
+                                                       : NULL;
+
+    uint32_t    numChunks  = 0u;
+    const char *chunkBegin = begin;
+    for (uint32_t i = 0u; read->chunks && i < numRegions; ++i) {
+        for (uint32_t j = 0u; j < searches[i].numCuts; ++j) {
+            const char *cut = searches[i].cuts[j];
+            if ((size_t)(cut - chunkBegin) >= MIN_INCREMENTAL_CHUNK_SIZE) {
+                read->chunks[numChunks++] = (Obj_Chunk) {.begin = chunkBegin, .end = cut};
+                chunkBegin                = cut;
+            }
+        }
+    }
+    if (read->chunks && chunkBegin < end) {
+        read->chunks[numChunks++] = (Obj_Chunk) {.begin = chunkBegin, .end = end};
+    }
+
+    for (uint32_t i = 0u; i < numRegions; ++i) {
+        free((void *)searches[i].cuts);
+    }
+    free(regions);
+    free(searches);
+    return read->chunks ? numChunks : UINT32_MAX;
+}
+
+/*
+ * Runs the chunk task of @read on its chunks, which the workers take in turn
+ */
+static void chunk_worker_task(void *context, uint32_t taskIdx) {
+    Obj_ChunkedRead *read = context;
+    (void)taskIdx;
+
+    uint32_t i;
+    while ((i = atomic_increment(&read->nextChunk) - 1u) < read->numChunks) {
+        read->chunkTask(read, i);
+    }
+}
+
+/*
+ * Runs @task on every chunk of @read, on up to @numThreads worker threads
+ */
+static void run_chunk_tasks(Obj_ChunkedRead *read, Obj_TaskFn task, uint32_t numThreads) {
+    read->chunkTask = task;
+    read->nextChunk = 0u;
+    run_tasks(chunk_worker_task, read, numThreads < read->numChunks ? numThreads : read->numChunks);
+}
+
+static void hash_chunk_task(void *context, uint32_t taskIdx) {
+    Obj_ChunkedRead *read  = context;
+    Obj_Chunk       *chunk = read->chunks + taskIdx;
+    chunk->hash            = hash_bytes(chunk->begin, chunk->end);
+}
+
+/*
+ * Counts a chunk, unless a record of the previous read has the same content, and hence the same
+ * counts
+ */
+static void count_new_chunk_task(void *context, uint32_t taskIdx) {
+    Obj_ChunkedRead       *read   = context;
+    Obj_Chunk             *chunk  = read->chunks + taskIdx;
+    const Obj_ChunkRecord *record = chunk->record;
+    if (!record) {
+        count_chunk_task(context, taskIdx);
+        return;
+    }
+    chunk->sizes     = record->counted;
+    chunk->numLines  = record->numLines;
+    chunk->posBounds = record->posBounds;
+}
+
+/*
+ * Copies the @count elements found at @src offsets in the @srcData mesh arrays to @dst offsets in
+ * the @dstData ones
+ */
+static void copy_mesh_elements(
+    Obj_MeshData       *dstData,
+    const Obj_MeshData *srcData,
+    uint32_t            quantizeFlags,
+    Obj_MeshSizes       dst,
+    Obj_MeshSizes       src,
+    Obj_MeshSizes       count
+) {
+    static const Obj_LineType TYPES[]    = {OBJ_VECPOS, OBJ_VECNORM, OBJ_VECTEXT};
+    Obj_MeshData              source     = *srcData;
+    const uint32_t            dstIdx[3]  = {dst.nPos, dst.nNorms, dst.nTex};
+    const uint32_t            srcIdx[3]  = {src.nPos, src.nNorms, src.nTex};
+    const uint32_t            counts[3]  = {count.nPos, count.nNorms, count.nTex};
+    for (uint32_t t = 0u; t < 3u; ++t) {
+        Obj_ComponentArrays dstArrays = get_component_arrays(dstData, TYPES[t], quantizeFlags);
+        Obj_ComponentArrays srcArrays = get_component_arrays(&source, TYPES[t], quantizeFlags);
+        for (uint32_t i = 0u; i < dstArrays.numArrays; ++i) {
+            copy_bytes(
+                (char *)*dstArrays.arrays[i] + dstIdx[t] * dstArrays.elemSize,
+                (const char *)*srcArrays.arrays[i] + srcIdx[t] * srcArrays.elemSize,
+                counts[t] * dstArrays.elemSize
+            );
+        }
+    }
+    if (dstData->posW) {
+        copy_bytes(
+            dstData->posW + dst.nPos,
+            srcData->posW + src.nPos,
+            count.nPos * sizeof(*dstData->posW)
+        );
+    }
+    copy_bytes(
+        dstData->faces + dst.flatFacesSize,
+        srcData->faces + src.flatFacesSize,
+        count.flatFacesSize * sizeof(*dstData->faces)
+    );
+    copy_bytes(
+        dstData->faceSizes + dst.nFaces,
+        srcData->faceSizes + src.nFaces,
+        count.nFaces * sizeof(*dstData->faceSizes)
+    );
+}
+
+/*
+ * Fills the range of the mesh arrays of a chunk, copying the elements of reused chunks from the
+ * previous mesh, and parsing the others
+ */
+static void fill_chunk_task(void *context, uint32_t taskIdx) {
+    Obj_ChunkedRead       *read   = context;
+    Obj_Chunk             *chunk  = read->chunks + taskIdx;
+    const Obj_ChunkRecord *record = chunk->record;
+    if (!chunk->reused) {
+        parse_chunk_task(context, taskIdx);
+        return;
+    }
+
+    uint32_t quantizeFlags = read->parser->options.quantizeFlags;
+    copy_mesh_elements(
+        &read->data,
+        read->previous,
+        quantizeFlags,
+        chunk->offset,
+        record->offset,
+        record->read
+    );
+    chunk->read            = add_sizes(chunk->offset, record->read);
+    chunk->numErrors       = record->numErrors;
+    chunk->relativeIndices = record->relativeIndices;
+    chunk->successfulRead  = append_range_marks(
+        &chunk->marks,
+        &record->marks,
+        0u - chunk->offset.nFaces,
+        0u - chunk->offset.flatFacesSize
+    );
+}
+
+/*
+ * Points each chunk of @read at the record of @parser holding the same content, if any. The
+ * records are looked up by their hash in an open-addressing table.
+ */
+static void match_chunk_records(const Obj_Parser *parser, Obj_ChunkedRead *read) {
+    size_t tableSize = 1u;
+    while (tableSize < 2u * (size_t)parser->numRecords) {
+        tableSize *= 2u;
+    }
+    uint32_t *table = parser->numRecords > 0u ? calloc(tableSize, sizeof(*table)) : NULL;
+    if (!table) {
+        return;
+    }
+
+    size_t tableMask = tableSize - 1u;
+    for (uint32_t i = 0u; i < parser->numRecords; ++i) {
+        size_t slot = (size_t)parser->records[i].hash & tableMask;
+        while (table[slot]) {
+            slot = (slot + 1u) & tableMask;
+        }
+        table[slot] = i + 1u;
+    }
+    for (uint32_t i = 0u; i < read->numChunks; ++i) {
+        Obj_Chunk *chunk  = read->chunks + i;
+        size_t     length = (size_t)(chunk->end - chunk->begin);
+        for (size_t slot = (size_t)chunk->hash & tableMask; table[slot] && !chunk->record;
+             slot        = (slot + 1u) & tableMask) {
+            const Obj_ChunkRecord *record = parser->records + table[slot] - 1u;
+            chunk->record = record->hash == chunk->hash && record->length == length ? record : NULL;
+        }
+    }
+    free(table);
+}
+
+/*
+ * Whether @chunk can copy its elements from the previous mesh of @read instead of being parsed.
+ * Chunks whose relative face indices now resolve to other elements, whose quantized positions
+ * changed with the bounds of the mesh, whose faces refer to generated normals the read no longer
+ * generates, or whose errors were not all recorded are parsed again, as are those loading material
+ * libraries, to hold a reference on them.
+ */
+static bool reuses_chunk(
+    const Obj_ChunkedRead *read,
+    const Obj_Chunk       *chunk,
+    bool                   boundsChanged,
+    bool                   normalsChanged
+) {
+    const Obj_ChunkRecord *record = chunk->record;
+    if (!record || !read->previous) {
+        return false;
+    }
+    bool moved = chunk->offset.nPos != record->base.nPos || chunk->offset.nTex != record->base.nTex
+              || chunk->offset.nNorms != record->base.nNorms;
+    return !record->materialLibs && !(record->relativeIndices && moved)
+        && !(boundsChanged && record->counted.nPos > 0u)
+        && !(normalsChanged && record->counted.nFaces > 0u)
+        && !(record->numErrors > 0u && !record->errors);
+}
+
+/*
+ * Reports again the errors of the chunks of @read which are reused, moved to the lines they are
+ * now on. This is done before the other chunks are parsed, so that the error policy of @parser
+ * accounts for them as it does in a read parsing every chunk.
+ */
+static void restore_chunk_errors(Obj_Parser *parser, const Obj_ChunkedRead *read) {
+    for (uint32_t i = 0u; i < read->numChunks; ++i) {
+        const Obj_Chunk *chunk  = read->chunks + i;
+        uint64_t         offset = (uint64_t)(chunk->begin - read->begin);
+        for (uint32_t j = 0u; chunk->reused && j < chunk->record->numErrors; ++j) {
+            Obj_Error error = chunk->record->errors[j];
+            error.line += chunk->firstLine;
+            error.offset += offset;
+            record_error(parser, error);
+        }
+    }
+}
+
+static void free_chunk_records(Obj_ChunkRecord *records, uint32_t numRecords) {
+    for (uint32_t i = 0u; records && i < numRecords; ++i) {
+        free_range_marks(&records[i].marks);
+        free(records[i].errors);
+    }
+    free(records);
+}
+
+/*
+ * Keeps in @record the @count errors found at @errors about the lines of @chunk, which starts at
+ * @offset in the buffer read, with their lines and offsets counted from the start of the chunk.
+ * They are only kept when the read recorded all the errors of the chunk, and could allocate room
+ * for them, the next read parsing the chunk again otherwise.
+ */
+static void record_chunk_errors(
+    Obj_ChunkRecord *record,
+    const Obj_Chunk *chunk,
+    const Obj_Error *errors,
+    uint32_t         count,
+    uint64_t         offset
+) {
+    record->numErrors = chunk->numErrors;
+    if (count == 0u || count < chunk->numErrors) {
+        return;
+    }
+    record->errors = malloc(count * sizeof(*record->errors));
+    for (uint32_t i = 0u; record->errors && i < count; ++i) {
+        record->errors[i] = errors[i];
+        record->errors[i].line -= chunk->firstLine;
+        record->errors[i].offset -= offset;
+    }
+}
+
+/*
+ * Records the @numChunks chunks of @read, once parsed, for the next incremental read. The errors
+ * of the read are sorted to be split among the chunks they are about. Returns NULL when the records
+ * could not be allocated, which only makes the next read parse every chunk.
+ */
+static Obj_ChunkRecord *record_chunks(const Obj_ChunkedRead *read, uint32_t numChunks) {
+    Obj_ChunkRecord *records  = calloc(numChunks > 0u ? numChunks : 1u, sizeof(*records));
+    bool             recorded = records != NULL;
+
+    Obj_Parser *parser    = read->parser;
+    uint32_t    numErrors = num_recorded_errors(parser);
+    if (numErrors > 0u) {
+        qsort(parser->errors, numErrors, sizeof(*parser->errors), compare_errors);
+    }
+    const Obj_Error *error     = parser->errors;
+    const Obj_Error *errorsEnd = parser->errors + numErrors;
+
+    Obj_MeshSizes offset = {0u, 0u, 0u, 0u, 0u};
+    for (uint32_t i = 0u; recorded && i < numChunks; ++i) {
+        const Obj_Chunk *chunk       = read->chunks + i;
+        Obj_MeshSizes    count       = sub_sizes(chunk->read, chunk->offset);
+        const Obj_Error *chunkErrors = error;
+        uint64_t         chunkEnd    = (uint64_t)(chunk->end - read->begin);
+        while (error < errorsEnd && error->line && error->offset < chunkEnd) {
+            ++error;
+        }
+        records[i]             = (Obj_ChunkRecord) {
+            .hash            = chunk->hash,
+            .length          = (size_t)(chunk->end - chunk->begin),
+            .numLines        = chunk->numLines,
+            .counted         = chunk->sizes,
+            .read            = count,
+            .base            = chunk->offset,
+            .offset          = offset,
+            .posBounds       = chunk->posBounds,
+            .relativeIndices = chunk->relativeIndices,
+            .materialLibs    = chunk->libs.count > 0u,
+        };
+        record_chunk_errors(
+            records + i,
+            chunk,
+            chunkErrors,
+            (uint32_t)(error - chunkErrors),
+            (uint64_t)(chunk->begin - read->begin)
+        );
+        offset   = add_sizes(offset, count);
+        recorded = append_range_marks(
+            &records[i].marks,
+            &chunk->marks,
+            chunk->offset.nFaces,
+            chunk->offset.flatFacesSize
+        );
+    }
+    if (!recorded) {
+        free_chunk_records(records, numChunks);
+        return NULL;
+    }
+    return records;
+}
+
+/*
+ * Parses the [begin, end) buffer in chunks split by their content, on @numThreads threads, and
+ * records them in @parser for the next incremental read. The chunks holding the same content as a
+ * record of the previous read skip the counting pass, and copy their elements from the @previous
+ * mesh when they can, instead of being parsed again. Others are counted and parsed as in
+ * try_get_data_chunked.
+ */
+static Obj_MeshData try_get_data_incremental(
+    Obj_Parser     *parser,
+    const char     *begin,
+    const char     *end,
+    const Obj_Mesh *previous,
+    Obj_MeshSizes  *sizes,
+    void          **block,
+    bool          *successfulRead
+) {
+    uint32_t        numThreads = parser->options.numThreads > 1u ? parser->options.numThreads : 1u;
+    Obj_ChunkedRead read       = {
+        .parser      = parser,
+        .begin       = begin,
+        .previous    = previous ? &previous->data : NULL,
+        .firstFailed = UINT32_MAX,
+    };
+
+    double start   = start_timer(parser);
+    read.numChunks = split_content_chunks(&read, begin, end, numThreads);
+    if (read.numChunks == UINT32_MAX) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return read.data;
+    }
+    size_t size = read.numChunks * sizeof(*read.chunks);
+    track_bytes(parser, &parser->bufferBytes, size, 0u);
+
+    run_chunk_tasks(&read, hash_chunk_task, numThreads);
+    match_chunk_records(parser, &read);
+    run_chunk_tasks(&read, count_new_chunk_task, numThreads);
+
+    Obj_MeshSizes total     = {0u, 0u, 0u, 0u, 0u};
+    uint32_t      firstLine = 0u;
+    Obj_Bounds    posBounds = empty_bounds();
+    for (uint32_t i = 0u; i < read.numChunks; ++i) {
+        read.chunks[i].offset    = total;
+        read.chunks[i].firstLine = firstLine;
+        total                    = add_sizes(total, read.chunks[i].sizes);
+        firstLine += read.chunks[i].numLines;
+        merge_bounds(&posBounds, &read.chunks[i].posBounds);
+    }
+    set_position_bounds(parser, posBounds);
+
+    bool boundsChanged  = previous && (parser->options.quantizeFlags & OBJ_QUANTIZE_POSITIONS)
+                      && memcmp(&posBounds, &previous->posBounds, sizeof(posBounds)) != 0;
+    bool normalsChanged = parser->generatedNormals && !generates_normals(parser, total);
+    for (uint32_t i = 0u; i < read.numChunks; ++i) {
+        read.chunks[i].reused = reuses_chunk(&read, read.chunks + i, boundsChanged, normalsChanged);
+    }
+    restore_chunk_errors(parser, &read);
+    parser->stats.countSeconds += stop_timer(parser, start);
+
+    start                   = start_timer(parser);
+    Obj_MeshSizes capacity  = {0u, 0u, 0u, 0u, 0u};
+    bool          allocated = parser->options.singleBlock
+                                ? alloc_mesh_block(
+                                      parser,
+                                      reserve_generated_normals(parser, total),
+                                      &read.data,
+                                      block
+                                  )
+                                : reserve_mesh_data(parser, &read.data, &capacity, total);
+    parser->stats.allocSeconds += stop_timer(parser, start);
+    if (!allocated) {
+        free(read.chunks);
+        track_bytes(parser, &parser->bufferBytes, 0u, size);
+        return read.data;
+    }
+
+    start = start_timer(parser);
+    run_chunk_tasks(&read, fill_chunk_task, numThreads);
+
+    Obj_ChunkRecord *records = record_chunks(&read, read.numChunks);
+    Obj_MeshSizes    readSizes;
+    bool             allRead = merge_chunks(parser, &read, read.numChunks, &readSizes);
+    free_chunk_records(parser->records, parser->numRecords);
+    parser->records          = allRead ? records : NULL;
+    parser->numRecords       = allRead && records ? read.numChunks : 0u;
+    parser->generatedNormals = allRead && generates_normals(parser, readSizes);
+    if (!allRead) {
+        free_chunk_records(records, read.numChunks);
+    }
+    free(read.chunks);
+    track_bytes(parser, &parser->bufferBytes, 0u, size);
+    parser->stats.parseSeconds += stop_timer(parser, start);
+
+    if (allRead) {
+        *sizes          = readSizes;
+        *successfulRead = true;
+    }
+    return read.data;
+}
+
+/*
+ * Initial capacity of the arrays grown by single pass reads, none for the streams skipped by
+ * @loadFlags
+ */
+static Obj_MeshSizes single_pass_initial_capacity(uint32_t loadFlags) {
+    uint32_t faceCapacity = loadFlags & OBJ_LOAD_SKIP_FACES ? 0u : SINGLE_PASS_INITIAL_CAPACITY;
+    return (Obj_MeshSizes) {
+        .nPos          = SINGLE_PASS_INITIAL_CAPACITY,
+        .nNorms        = loadFlags & OBJ_LOAD_SKIP_NORMALS ? 0u : SINGLE_PASS_INITIAL_CAPACITY,
+        .nTex          = loadFlags & OBJ_LOAD_SKIP_TEXCOORDS ? 0u : SINGLE_PASS_INITIAL_CAPACITY,
+        .nFaces        = faceCapacity,
+        .flatFacesSize = 4u * faceCapacity,
+    };
+}
+
+/*
+ * Interns the null terminated @name among the names of @ranges, which the open addressing @table of
+ * @tableMask + 1 slots indexes, and returns its index
+ */
+static uint32_t intern_name(
+    Obj_FaceRanges *ranges,
+    uint32_t       *table,
+    size_t          tableMask,
+    const char     *name
+) {
+    // FNV-1a
+    size_t   len  = strlen(name);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0u; i < len; ++i) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+
+    size_t slot = hash & tableMask;
+    for (; table[slot] != 0u; slot = (slot + 1u) & tableMask) {
+        uint32_t idx = table[slot] - 1u;
+        if (strcmp(ranges->names + ranges->nameOffsets[idx], name) == 0) {
+            return idx;
+        }
+    }
+
+    uint32_t idx             = ranges->numNames++;
+    ranges->nameOffsets[idx] = ranges->namesSize;
+    memcpy(ranges->names + ranges->namesSize, name, len + 1u);
+    ranges->namesSize += (uint32_t)len + 1u;
+    table[slot] = idx + 1u;
+    return idx;
+}
+
+/*
+ * Ends the last @kind range of @ranges right before @endFace and @endCorner, and drops it when it
+ * holds no face
+ */
+static void end_face_range(
+    Obj_FaceRanges *ranges,
+    uint32_t        kind,
+    uint32_t        endFace,
+    uint32_t        endCorner
+) {
+    uint32_t *numRanges = ranges->numRanges + kind;
+    if (*numRanges == 0u) {
+        return;
+    }
+
+    Obj_FaceRange *range = ranges->ranges[kind] + *numRanges - 1u;
+    range->numFaces      = endFace - range->firstFace;
+    range->numCorners    = endCorner - range->firstCorner;
+    if (range->numFaces == 0u) {
+        --*numRanges;
+    }
+}
+
+/*
+ * Turns the range statements of the read into the face ranges of @mesh, which get a single block
+ * holding them along with their interned names. Meshes without statements allocate nothing.
+ */
+static bool build_face_ranges(Obj_Parser *parser, Obj_Mesh *mesh) {
+    const Obj_RangeMarks *marks = &parser->marks;
+
+    mesh->faceRanges = (Obj_FaceRanges) {};
+    if (marks->numMarks == 0u) {
+        return true;
+    }
+
+    // The ranges are first gathered in scratch arrays sized for a range and a name per statement
+    Obj_FaceRanges ranges = {.namesSize = marks->namesSize};
+    for (uint32_t i = 0u; i < marks->numMarks; ++i) {
+        ++ranges.numRanges[marks->marks[i].kind];
+        ranges.numNames += marks->marks[i].kind != OBJ_RANGE_SMOOTHING;
+    }
+    size_t tableSize = 1u;
+    while (tableSize < 2u * (size_t)ranges.numNames) {
+        tableSize *= 2u;
+    }
+
+    size_t rangesSize = face_ranges_size(&ranges);
+    char  *scratch    = malloc(rangesSize + tableSize * sizeof(uint32_t));
+    if (!scratch) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+    carve_face_ranges(scratch, &ranges);
+    uint32_t *table = (uint32_t *)(scratch + rangesSize);
+    memset(table, 0, tableSize * sizeof(*table));
+    memset(ranges.numRanges, 0, sizeof(ranges.numRanges));
+    ranges.numNames  = 0u;
+    ranges.namesSize = 0u;
+
+    for (uint32_t i = 0u; i < marks->numMarks; ++i) {
+        const Obj_RangeMark *mark = marks->marks + i;
+
+        uint32_t name = mark->value;
+        if (mark->kind != OBJ_RANGE_SMOOTHING) {
+            name = intern_name(&ranges, table, tableSize - 1u, marks->names + mark->value);
+        }
+        end_face_range(&ranges, mark->kind, mark->firstFace, mark->firstCorner);
+
+        // Statements repeating the name of the range they end extend it
+        uint32_t      *numRanges = ranges.numRanges + mark->kind;
+        Obj_FaceRange *kindRanges = ranges.ranges[mark->kind];
+        if (*numRanges == 0u || kindRanges[*numRanges - 1u].name != name) {
+            kindRanges[(*numRanges)++] = (Obj_FaceRange) {
+                .firstFace   = mark->firstFace,
+                .firstCorner = mark->firstCorner,
+                .name        = name,
+            };
+        }
+    }
+
+    uint32_t totalRanges = 0u;
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        end_face_range(&ranges, kind, mesh->sizes.nFaces, mesh->sizes.flatFacesSize);
+        totalRanges += ranges.numRanges[kind];
+    }
+    if (totalRanges == 0u) {
+        free(scratch);
+        return true;
+    }
+
+    Obj_FaceRanges *faceRanges = &mesh->faceRanges;
+    memcpy(faceRanges->numRanges, ranges.numRanges, sizeof(ranges.numRanges));
+    faceRanges->numNames  = ranges.numNames;
+    faceRanges->namesSize = ranges.namesSize;
+
+    size_t size       = face_ranges_size(faceRanges);
+    faceRanges->block = mem_allocate(&mesh->allocator, size, ARRAY_ALIGNMENT);
+    if (!faceRanges->block) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        free(scratch);
+        mesh->faceRanges = (Obj_FaceRanges) {};
+        return false;
+    }
+    track_bytes(parser, &parser->meshBytes, size, 0u);
+
+    carve_face_ranges(faceRanges->block, faceRanges);
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        size_t kindSize = ranges.numRanges[kind] * sizeof(**ranges.ranges);
+        copy_bytes(faceRanges->ranges[kind], ranges.ranges[kind], kindSize);
+    }
+    copy_bytes(faceRanges->nameOffsets, ranges.nameOffsets, ranges.numNames * sizeof(uint32_t));
+    copy_bytes(faceRanges->names, ranges.names, ranges.namesSize);
+    free(scratch);
+    return true;
+}
+
+static const char *get_range_name(
+    const Obj_Mesh      *mesh,
+    Obj_RangeKind        kind,
+    const Obj_FaceRange *range
+) {
+    const Obj_FaceRanges *ranges = &mesh->faceRanges;
+    if (kind == OBJ_RANGE_SMOOTHING || range->name >= ranges->numNames) {
+        return NULL;
+    }
+    return ranges->names + ranges->nameOffsets[range->name];
+}
+
+/*
+ * Returns the number of ranges a geometry pass over @count positions or face vertices is split in,
+ * so that no thread gets fewer than MIN_GEOMETRY_RANGE_SIZE of them
+ */
+static uint32_t num_geometry_ranges(uint32_t count, uint32_t numThreads) {
+    uint32_t maxRanges = count / MIN_GEOMETRY_RANGE_SIZE;
+    numThreads         = numThreads > 1u ? numThreads : 1u;
+    return maxRanges < 1u ? 1u : (maxRanges < numThreads ? maxRanges : numThreads);
+}
+
+/*
+ * Splits the @numPositions positions in @numRanges ranges of about as many positions each
+ */
+static void split_position_ranges(
+    uint32_t           numPositions,
+    Obj_GeometryRange *ranges,
+    uint32_t           numRanges
+) {
+    uint32_t rangeSize = numPositions / numRanges;
+    for (uint32_t i = 0u; i < numRanges; ++i) {
+        ranges[i] = (Obj_GeometryRange) {
+            .first = i * rangeSize,
+            .end   = i + 1u < numRanges ? (i + 1u) * rangeSize : numPositions,
+            .valid = true,
+        };
+    }
+}
+
+/*
+ * Splits the faces of @mesh in up to @maxRanges ranges holding about as many face vertices each,
+ * and returns how many were made
+ */
+static uint32_t split_face_ranges(
+    const Obj_Mesh    *mesh,
+    Obj_GeometryRange *ranges,
+    uint32_t           maxRanges
+) {
+    uint32_t rangeSize = mesh->sizes.flatFacesSize / maxRanges;
+    uint32_t numRanges = 0u;
+    uint32_t corner    = 0u;
+
+    for (uint32_t face = 0u; face < mesh->sizes.nFaces; ++numRanges) {
+        Obj_GeometryRange *range = ranges + numRanges;
+        *range = (Obj_GeometryRange) {.first = face, .firstCorner = corner, .valid = true};
+
+        uint32_t endCorner = numRanges + 1u < maxRanges ? corner + rangeSize : UINT32_MAX;
+        do {
+            corner += mesh->data.faceSizes[face++];
+        } while (face < mesh->sizes.nFaces && corner < endCorner);
+        range->end = face;
+    }
+    return numRanges;
+}
+
+static bool all_geometry_ranges_valid(const Obj_GeometryRange *ranges, uint32_t numRanges) {
+    for (uint32_t i = 0u; i < numRanges; ++i) {
+        if (!ranges[i].valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Extends [@min, @max] with the @count values of @values, several at a time where vector extensions
+ * are available
+ */
+static void extend_array_bounds(const float *values, uint32_t count, float *min, float *max) {
+    uint32_t i = 0u;
+#if defined(SIMD_AVX2)
+    float  lanesMin[8];
+    float  lanesMax[8];
+    __m256 vecMin = _mm256_set1_ps(*min);
+    __m256 vecMax = _mm256_set1_ps(*max);
+    for (; count - i >= 8u; i += 8u) {
+        __m256 v = _mm256_loadu_ps(values + i);
+        vecMin   = _mm256_min_ps(v, vecMin);
+        vecMax   = _mm256_max_ps(v, vecMax);
+    }
+    _mm256_storeu_ps(lanesMin, vecMin);
+    _mm256_storeu_ps(lanesMax, vecMax);
+#elif defined(SIMD_SSE2)
+    float  lanesMin[4];
+    float  lanesMax[4];
+    __m128 vecMin = _mm_set1_ps(*min);
+    __m128 vecMax = _mm_set1_ps(*max);
+    for (; count - i >= 4u; i += 4u) {
+        __m128 v = _mm_loadu_ps(values + i);
+        vecMin   = _mm_min_ps(v, vecMin);
+        vecMax   = _mm_max_ps(v, vecMax);
+    }
+    _mm_storeu_ps(lanesMin, vecMin);
+    _mm_storeu_ps(lanesMax, vecMax);
+#elif defined(SIMD_NEON)
+    float       lanesMin[4];
+    float       lanesMax[4];
+    float32x4_t vecMin = vdupq_n_f32(*min);
+    float32x4_t vecMax = vdupq_n_f32(*max);
+    for (; count - i >= 4u; i += 4u) {
+        float32x4_t v = vld1q_f32(values + i);
+        vecMin        = vminq_f32(v, vecMin);
+        vecMax        = vmaxq_f32(v, vecMax);
+    }
+    vst1q_f32(lanesMin, vecMin);
+    vst1q_f32(lanesMax, vecMax);
+#endif
+#if defined(SIMD_AVX2) || defined(SIMD_SSE2) || defined(SIMD_NEON)
+    for (uint32_t lane = 0u; lane < sizeof(lanesMin) / sizeof(*lanesMin); ++lane) {
+        *min = lanesMin[lane] < *min ? lanesMin[lane] : *min;
+        *max = lanesMax[lane] > *max ? lanesMax[lane] : *max;
+    }
+#endif
+    for (; i < count; ++i) {
+        *min = values[i] < *min ? values[i] : *min;
+        *max = values[i] > *max ? values[i] : *max;
+    }
+}
+
+static void bounds_range_task(void *context, uint32_t taskIdx) {
+    Obj_GeometryPass  *pass   = context;
+    const Obj_Mesh    *mesh   = pass->mesh;
+    Obj_GeometryRange *range  = pass->ranges + taskIdx;
+    Obj_Bounds        *bounds = &range->bounds;
+
+    *bounds = empty_bounds();
+    if (!(mesh->quantizeFlags & OBJ_QUANTIZE_POSITIONS)) {
+        const float *components[3] = {mesh->data.posX, mesh->data.posY, mesh->data.posZ};
+        for (uint32_t i = 0u; i < 3u; ++i) {
+            const float *values = components[i] + range->first;
+            uint32_t     count  = range->end - range->first;
+            extend_array_bounds(values, count, bounds->min + i, bounds->max + i);
+        }
+        return;
+    }
+    for (uint32_t i = range->first; i < range->end; ++i) {
+        float position[3];
+        get_position(mesh, i, position);
+        extend_bounds(bounds, position);
+    }
+}
+
+/*
+ * Computes the bounds of the positions of @mesh, split across @numThreads threads. Without memory
+ * for the ranges, the positions are bounded as a single range on the calling thread.
+ */
+static Obj_Bounds compute_bounds(const Obj_Mesh *mesh, uint32_t numThreads) {
+    Obj_GeometryRange single;
+    uint32_t          numRanges = num_geometry_ranges(mesh->sizes.nPos, numThreads);
+    Obj_GeometryPass  pass      = {.mesh = mesh};
+    if (numRanges > 1u) {
+        pass.ranges = malloc(numRanges * sizeof(*pass.ranges));
+    }
+    if (!pass.ranges) {
+        pass.ranges = &single;
+        numRanges   = 1u;
+    }
+
+    split_position_ranges(mesh->sizes.nPos, pass.ranges, numRanges);
+    run_tasks(bounds_range_task, &pass, numRanges);
+
+    Obj_Bounds bounds = empty_bounds();
+    for (uint32_t i = 0u; i < numRanges; ++i) {
+        merge_bounds(&bounds, &pass.ranges[i].bounds);
+    }
+    if (pass.ranges != &single) {
+        free(pass.ranges);
+    }
+    return bounds;
+}
+
+static float dot_3d(const float *a, const float *b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void cross_3d(const float *a, const float *b, float cross[3]) {
+    cross[0] = a[1] * b[2] - a[2] * b[1];
+    cross[1] = a[2] * b[0] - a[0] * b[2];
+    cross[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/*
+ * Scales @v to unit length, leaving null vectors as they are, and returns its length
+ */
+static float normalize_3d(float v[3]) {
+    float length = sqrtf(dot_3d(v, v));
+    if (length > 0.f) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+    return length;
+}
+
+static bool is_valid_vert_idx(Obj_VertIdx vertIdx, Obj_MeshSizes sizes) {
+    return vertIdx.posIdx >= 1 && (uint32_t)vertIdx.posIdx <= sizes.nPos
+        && (vertIdx.texIdx == -1 || (vertIdx.texIdx >= 1 && (uint32_t)vertIdx.texIdx <= sizes.nTex))
+        && (vertIdx.normIdx == -1
+            || (vertIdx.normIdx >= 1 && (uint32_t)vertIdx.normIdx <= sizes.nNorms));
+}
+
+/*
+ * Gets the position face vertex @corner of @mesh refers to, and returns false when it is missing
+ */
+static bool get_corner_position(const Obj_Mesh *mesh, uint32_t corner, float position[3]) {
+    int32_t posIdx = get_face_vertex(mesh, corner).posIdx;
+    if (posIdx < 1 || (uint32_t)posIdx > mesh->sizes.nPos) {
+        return false;
+    }
+    get_position(mesh, (uint32_t)posIdx - 1u, position);
+    return true;
+}
+
+/*
+ * Computes the normal of the face of @faceSize vertices starting at face vertex @corner, with
+ * Newell's method so that it holds for non planar and concave polygons. Its length is twice the
+ * area of the face, which summing face normals weights them by. Returns false when a face vertex
+ * refers to a missing position.
+ */
+static bool face_normal(const Obj_Mesh *mesh, uint32_t corner, uint32_t faceSize, float normal[3]) {
+    normal[0] = normal[1] = normal[2] = 0.f;
+
+    // Positions are taken relative to the first one, which keeps precision far from the origin
+    float first[3];
+    if (faceSize == 0u || !get_corner_position(mesh, corner, first)) {
+        return faceSize == 0u;
+    }
+    float p[3] = {0.f, 0.f, 0.f};
+    for (uint32_t i = 1u; i <= faceSize; ++i) {
+        float q[3] = {first[0], first[1], first[2]};
+        if (i < faceSize && !get_corner_position(mesh, corner + i, q)) {
+            return false;
+        }
+        q[0] -= first[0];
+        q[1] -= first[1];
+        q[2] -= first[2];
+        normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+        normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+        normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+        memcpy(p, q, sizeof(p));
+    }
+    return true;
+}
+
+static void face_normals_task(void *context, uint32_t taskIdx) {
+    Obj_GeometryPass  *pass   = context;
+    const Obj_Mesh    *mesh   = pass->mesh;
+    Obj_GeometryRange *range  = pass->ranges + taskIdx;
+    uint32_t           corner = range->firstCorner;
+
+    for (uint32_t face = range->first; face < range->end; ++face) {
+        uint32_t faceSize = mesh->data.faceSizes[face];
+        if (!face_normal(mesh, corner, faceSize, pass->faceNormals[face])) {
+            range->valid = false;
+        }
+        corner += faceSize;
+    }
+}
+
+/*
+ * Sums the face normals of @pass into the normals of the positions of their faces. Each position
+ * gets its face normals added in the order of the faces, so that the sums do not depend on the
+ * number of threads.
+ */
+static void sum_face_normals(Obj_GeometryPass *pass) {
+    const Obj_Mesh *mesh   = pass->mesh;
+    uint32_t        corner = 0u;
+
+    for (uint32_t face = 0u; face < mesh->sizes.nFaces; ++face) {
+        const float *normal = pass->faceNormals[face];
+        for (uint32_t end = corner + mesh->data.faceSizes[face]; corner < end; ++corner) {
+            uint32_t pos = (uint32_t)get_face_vertex(mesh, corner).posIdx - 1u;
+            pass->normals[0][pos] += normal[0];
+            pass->normals[1][pos] += normal[1];
+            pass->normals[2][pos] += normal[2];
+        }
+    }
+}
+
+static void normalize_normals_task(void *context, uint32_t taskIdx) {
+    Obj_GeometryPass        *pass  = context;
+    const Obj_GeometryRange *range = pass->ranges + taskIdx;
+    float                   *x     = pass->normals[0];
+    float                   *y     = pass->normals[1];
+    float                   *z     = pass->normals[2];
+
+    for (uint32_t i = range->first; i < range->end; ++i) {
+        float length = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        float scale  = length > 0.f ? 1.f / length : 0.f;
+        x[i] *= scale;
+        y[i] *= scale;
+        z[i] *= scale;
+    }
+}
+
+/*
+ * Writes the smooth normal of each position of @mesh to @normals, split across @numThreads threads.
+ * The face normals are computed in parallel over ranges of faces, summed into their positions in
+ * face order, and the sums normalized in parallel over ranges of positions.
+ */
+static bool compute_normals(const Obj_Mesh *mesh, uint32_t numThreads, float *const normals[3]) {
+    uint32_t nPos   = mesh->sizes.nPos;
+    uint32_t nFaces = mesh->sizes.nFaces;
+    for (uint32_t i = 0u; i < 3u && nPos > 0u; ++i) {
+        memset(normals[i], 0, nPos * sizeof(*normals[i]));
+    }
+    if (nFaces == 0u || (!mesh->data.faces && !mesh->data.compactFaces)) {
+        return true;
+    }
+
+    uint32_t numFaceRanges = num_geometry_ranges(mesh->sizes.flatFacesSize, numThreads);
+    uint32_t numPosRanges  = num_geometry_ranges(nPos, numThreads);
+    uint32_t maxRanges     = numFaceRanges > numPosRanges ? numFaceRanges : numPosRanges;
+
+    Obj_GeometryPass pass = {
+        .mesh        = mesh,
+        .ranges      = malloc(maxRanges * sizeof(*pass.ranges)),
+        .faceNormals = malloc(nFaces * sizeof(*pass.faceNormals)),
+        .normals     = {normals[0], normals[1], normals[2]},
+    };
+
+    bool computed = pass.ranges && pass.faceNormals;
+    if (computed) {
+        uint32_t numRanges = split_face_ranges(mesh, pass.ranges, numFaceRanges);
+        run_tasks(face_normals_task, &pass, numRanges);
+        computed = all_geometry_ranges_valid(pass.ranges, numRanges);
+    }
+    if (computed) {
+        sum_face_normals(&pass);
+        split_position_ranges(nPos, pass.ranges, numPosRanges);
+        run_tasks(normalize_normals_task, &pass, numPosRanges);
+    }
+
+    FREE(pass.ranges);
+    FREE(pass.faceNormals);
+    return computed;
+}
+
+/*
+ * Adds the tangent and bitangent of the triangle of face vertices @corners of @mesh, weighted by
+ * its area, to @tangent and @bitangent, and returns the signed area of its texture coordinates,
+ * which is negative when they are mirrored. Triangles degenerate in space or in texture space add
+ * nothing.
+ */
+static float add_triangle_tangent(
+    const Obj_Mesh   *mesh,
+    const Obj_VertIdx corners[3],
+    float             tangent[3],
+    float             bitangent[3]
+) {
+    float p[3][3];
+    float uv[3][2];
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        get_position(mesh, (uint32_t)corners[i].posIdx - 1u, p[i]);
+        get_texcoord(mesh, (uint32_t)corners[i].texIdx - 1u, uv[i]);
+    }
+
+    float e1[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+    float e2[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+    float du1   = uv[1][0] - uv[0][0];
+    float dv1   = uv[1][1] - uv[0][1];
+    float du2   = uv[2][0] - uv[0][0];
+    float dv2   = uv[2][1] - uv[0][1];
+
+    float normal[3];
+    cross_3d(e1, e2, normal);
+    float area   = sqrtf(dot_3d(normal, normal));
+    float uvArea = du1 * dv2 - du2 * dv1;
+    if (area == 0.f || uvArea == 0.f) {
+        return 0.f;
+    }
+
+    // The directions along which u and v grow on the triangle
+    float sign = uvArea > 0.f ? 1.f : -1.f;
+    float t[3];
+    float b[3];
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        t[i] = (e1[i] * dv2 - e2[i] * dv1) * sign;
+        b[i] = (e2[i] * du1 - e1[i] * du2) * sign;
+    }
+    if (normalize_3d(t) == 0.f || normalize_3d(b) == 0.f) {
+        return 0.f;
+    }
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        tangent[i] += t[i] * area;
+        bitangent[i] += b[i] * area;
+    }
+    return uvArea;
+}
+
+static void tangent_faces_task(void *context, uint32_t taskIdx) {
+    Obj_GeometryPass  *pass   = context;
+    const Obj_Mesh    *mesh   = pass->mesh;
+    Obj_GeometryRange *range  = pass->ranges + taskIdx;
+    uint32_t           corner = range->firstCorner;
+
+    for (uint32_t face = range->first; face < range->end; ++face) {
+        uint32_t faceSize  = mesh->data.faceSizes[face];
+        float   *tangent   = pass->faceTangents[face];
+        float   *bitangent = pass->faceBitangents[face];
+        tangent[0] = tangent[1] = tangent[2] = 0.f;
+        bitangent[0] = bitangent[1] = bitangent[2] = 0.f;
+
+        bool textured = true;
+        for (uint32_t i = 0u; i < faceSize; ++i) {
+            Obj_VertIdx vertIdx = get_face_vertex(mesh, corner + i);
+            range->valid          = range->valid && is_valid_vert_idx(vertIdx, mesh->sizes);
+            range->missingNormals = range->missingNormals || vertIdx.normIdx == -1;
+            textured              = textured && vertIdx.texIdx != -1;
+        }
+
+        // Polygons are fanned out of their first vertex
+        float uvArea = 0.f;
+        for (uint32_t i = 2u; range->valid && textured && i < faceSize; ++i) {
+            Obj_VertIdx triangle[3] = {
+                get_face_vertex(mesh, corner),
+                get_face_vertex(mesh, corner + i - 1u),
+                get_face_vertex(mesh, corner + i),
+            };
+            uvArea += add_triangle_tangent(mesh, triangle, tangent, bitangent);
+        }
+        pass->faceFlipped[face] = uvArea < 0.f;
+        corner += faceSize;
+    }
+}
+
+/*
+ * Sums the face tangents and bitangents of @pass into the texture coordinates of their faces, in
+ * face order as for normals. Faces with mirrored texture coordinates are summed apart, so that the
+ * two sides of a mirror seam sharing texture coordinates keep their own tangents.
+ */
+static void sum_face_tangents(Obj_GeometryPass *pass) {
+    const Obj_Mesh *mesh   = pass->mesh;
+    uint32_t        corner = 0u;
+
+    for (uint32_t face = 0u; face < mesh->sizes.nFaces; ++face) {
+        const float *tangent   = pass->faceTangents[face];
+        const float *bitangent = pass->faceBitangents[face];
+        size_t       flipped   = pass->faceFlipped[face] ? 1u : 0u;
+        for (uint32_t end = corner + mesh->data.faceSizes[face]; corner < end; ++corner) {
+            int32_t texIdx = get_face_vertex(mesh, corner).texIdx;
+            if (texIdx == -1) {
+                continue;
+            }
+            size_t slot = 2u * ((size_t)texIdx - 1u) + flipped;
+            for (uint32_t i = 0u; i < 3u; ++i) {
+                pass->texTangents[slot][i] += tangent[i];
+                pass->texBitangents[slot][i] += bitangent[i];
+            }
+        }
+    }
+}
+
+/*
+ * Writes the tangent of face vertex @corner, in a face with mirrored texture coordinates when
+ * @flipped. The tangent of its texture coordinates is made orthogonal to its normal, and the sign
+ * of the bitangent is found from the bitangent of its texture coordinates.
+ */
+static void write_corner_tangent(Obj_GeometryPass *pass, uint32_t corner, bool flipped) {
+    const Obj_Mesh *mesh       = pass->mesh;
+    Obj_VertIdx     vertIdx    = get_face_vertex(mesh, corner);
+    float           tangent[4] = {0.f, 0.f, 0.f, 1.f};
+
+    if (vertIdx.texIdx != -1) {
+        float normal[3];
+        if (vertIdx.normIdx != -1) {
+            get_normal(mesh, (uint32_t)vertIdx.normIdx - 1u, normal);
+        } else {
+            uint32_t pos = (uint32_t)vertIdx.posIdx - 1u;
+            normal[0]    = pass->normals[0][pos];
+            normal[1]    = pass->normals[1][pos];
+            normal[2]    = pass->normals[2][pos];
+        }
+        normalize_3d(normal);
+
+        size_t       slot      = 2u * ((size_t)vertIdx.texIdx - 1u) + (flipped ? 1u : 0u);
+        const float *bitangent = pass->texBitangents[slot];
+        memcpy(tangent, pass->texTangents[slot], 3u * sizeof(*tangent));
+
+        float projection = dot_3d(normal, tangent);
+        for (uint32_t i = 0u; i < 3u; ++i) {
+            tangent[i] -= normal[i] * projection;
+        }
+        if (normalize_3d(tangent) > 0.f) {
+            float cross[3];
+            cross_3d(normal, tangent, cross);
+            tangent[3] = dot_3d(cross, bitangent) < 0.f ? -1.f : 1.f;
+        }
+    }
+
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        pass->tangents[i][corner] = tangent[i];
+    }
+}
+
+static void tangent_corners_task(void *context, uint32_t taskIdx) {
+    Obj_GeometryPass        *pass   = context;
+    const Obj_Mesh          *mesh   = pass->mesh;
+    const Obj_GeometryRange *range  = pass->ranges + taskIdx;
+    uint32_t                 corner = range->firstCorner;
+
+    for (uint32_t face = range->first; face < range->end; ++face) {
+        for (uint32_t end = corner + mesh->data.faceSizes[face]; corner < end; ++corner) {
+            write_corner_tangent(pass, corner, pass->faceFlipped[face]);
+        }
+    }
+}
+
+/*
+ * Writes the tangent of each face vertex of @mesh to @tangents, split across @numThreads threads.
+ * The face tangents are computed in parallel over ranges of faces, summed into their texture
+ * coordinates in face order, and each face vertex then finds its own in parallel again. Face
+ * vertices without a normal use the smooth normal of their position.
+ */
+static bool compute_tangents(const Obj_Mesh *mesh, uint32_t numThreads, float *const tangents[4]) {
+    uint32_t nFaces = mesh->sizes.nFaces;
+    if (nFaces == 0u || (!mesh->data.faces && !mesh->data.compactFaces)) {
+        return true;
+    }
+
+    uint32_t maxRanges = num_geometry_ranges(mesh->sizes.flatFacesSize, numThreads);
+    size_t   numSlots  = 2u * (size_t)mesh->sizes.nTex;
+
+    Obj_GeometryPass pass = {
+        .mesh           = mesh,
+        .ranges         = malloc(maxRanges * sizeof(*pass.ranges)),
+        .faceTangents   = malloc(nFaces * sizeof(*pass.faceTangents)),
+        .faceBitangents = malloc(nFaces * sizeof(*pass.faceBitangents)),
+        .faceFlipped    = malloc(nFaces * sizeof(*pass.faceFlipped)),
+        .texTangents    = calloc(numSlots, sizeof(*pass.texTangents)),
+        .texBitangents  = calloc(numSlots, sizeof(*pass.texBitangents)),
+        .tangents       = {tangents[0], tangents[1], tangents[2], tangents[3]},
+    };
+
+    bool computed = pass.ranges && pass.faceTangents && pass.faceBitangents && pass.faceFlipped
+                 && (numSlots == 0u || (pass.texTangents && pass.texBitangents));
+    uint32_t numRanges      = 0u;
+    bool     missingNormals = false;
+    if (computed) {
+        numRanges = split_face_ranges(mesh, pass.ranges, maxRanges);
+        run_tasks(tangent_faces_task, &pass, numRanges);
+        computed = all_geometry_ranges_valid(pass.ranges, numRanges);
+        for (uint32_t i = 0u; i < numRanges; ++i) {
+            missingNormals = missingNormals || pass.ranges[i].missingNormals;
+        }
+    }
+
+    float *smoothNormals = NULL;
+    if (computed && missingNormals) {
+        size_t nPos   = mesh->sizes.nPos;
+        smoothNormals = malloc(3u * nPos * sizeof(*smoothNormals));
+        for (uint32_t i = 0u; smoothNormals && i < 3u; ++i) {
+            pass.normals[i] = smoothNormals + i * nPos;
+        }
+        computed = smoothNormals && compute_normals(mesh, numThreads, pass.normals);
+    }
+    if (computed) {
+        sum_face_tangents(&pass);
+        run_tasks(tangent_corners_task, &pass, numRanges);
+    }
+
+    FREE(pass.ranges);
+    FREE(pass.faceTangents);
+    FREE(pass.faceBitangents);
+    FREE(pass.faceFlipped);
+    FREE(pass.texTangents);
+    FREE(pass.texBitangents);
+    FREE(smoothNormals);
+    return computed;
+}
+
+/*
+ * Allocates the normals generated for the @numPositions positions of a read whose arrays are not
+ * carved from a block. Normal arrays left by single pass reads hold no normal, and are replaced.
+ */
+static bool alloc_generated_normals(Obj_Parser *parser, Obj_MeshData *data, uint32_t numPositions) {
+    const Obj_Allocator *allocator = &parser->options.allocator;
+    Obj_ComponentArrays  normals =
+        get_component_arrays(data, OBJ_VECNORM, parser->options.quantizeFlags);
+
+    for (uint32_t i = 0u; i < normals.numArrays; ++i) {
+        mem_deallocate(allocator, *normals.arrays[i]);
+        *normals.arrays[i] = NULL;
+    }
+    if (!resize_components(allocator, normals, 0u, numPositions)) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+    size_t size = (size_t)numPositions * normals.numArrays * normals.elemSize;
+    track_bytes(parser, &parser->meshBytes, size, 0u);
+    return true;
+}
+
+/*
+ * Fills the normal arrays of @mesh, which hold one normal per position, with the smooth normals of
+ * its positions, and points each face vertex at the normal of its position
+ */
+static bool generate_normals(Obj_Parser *parser, Obj_Mesh *mesh) {
+    Obj_MeshData *data      = &mesh->data;
+    size_t        nPos      = mesh->sizes.nPos;
+    bool          quantized = mesh->quantizeFlags & OBJ_QUANTIZE_NORMALS;
+
+    // Quantized normals are computed as floats first
+    float *scratch    = quantized ? malloc(3u * nPos * sizeof(*scratch)) : NULL;
+    float *normals[3] = {data->normX, data->normY, data->normZ};
+    for (uint32_t i = 0u; scratch && i < 3u; ++i) {
+        normals[i] = scratch + i * nPos;
+    }
+
+    bool generated =
+        (!quantized || scratch) && compute_normals(mesh, parser->options.numThreads, normals);
+    for (size_t i = 0u; generated && quantized && i < nPos; ++i) {
+        data->quantized.normX[i] = float_to_half(normals[0][i]);
+        data->quantized.normY[i] = float_to_half(normals[1][i]);
+        data->quantized.normZ[i] = float_to_half(normals[2][i]);
+    }
+    for (uint32_t i = 0u; generated && i < mesh->sizes.flatFacesSize; ++i) {
+        data->faces[i].normIdx = data->faces[i].posIdx;
+    }
+    FREE(scratch);
+
+    if (!generated) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+    }
+    return generated;
+}
+
+/*
+ * Finalises the arrays of a read. Failed reads release everything they allocated and return an
+ * empty mesh. Arrays grown by a single pass read are then trimmed or packed in a single block, as
+ * requested by the options, the normals generated for meshes without any when asked for, the face
+ * ranges built out of the range statements read, and the material libraries handed over to the
+ * mesh.
+ */
+static bool finish_read(Obj_Parser *parser, Obj_Mesh *mesh, bool successfulRead, bool grownArrays) {
+    const Obj_ReadOptions *options = &parser->options;
+
+    mesh->allocator     = options->allocator;
+    mesh->quantizeFlags = options->quantizeFlags;
+    if (options->quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+        mesh->posBounds = parser->posBounds;
+    }
+
+    // Blocks allocated up front only hold the generated normals when the counting pass found none
+    bool generateNormals = successfulRead && generates_normals(parser, mesh->sizes)
+                        && (!mesh->block || parser->reservedNormals);
+    parser->reservedNormals = false;
+    if (generateNormals && !mesh->block) {
+        double start   = start_timer(parser);
+        successfulRead = alloc_generated_normals(parser, &mesh->data, mesh->sizes.nPos);
+        parser->stats.allocSeconds += stop_timer(parser, start);
+    }
+    if (generateNormals) {
+        mesh->sizes.nNorms = mesh->sizes.nPos;
+    }
+
+    if (successfulRead && grownArrays) {
+        double start = start_timer(parser);
+        if (options->singleBlock) {
+            successfulRead = pack_mesh_data(parser, mesh->sizes, &mesh->data, &mesh->block);
+        } else if (options->shrinkToFit) {
+            shrink_mesh_data(parser, &mesh->data, mesh->sizes);
+        }
+        parser->stats.allocSeconds += stop_timer(parser, start);
+    }
+    if (successfulRead && generateNormals) {
+        successfulRead = generate_normals(parser, mesh);
+    }
+    if (successfulRead) {
+        successfulRead = build_face_ranges(parser, mesh) && attach_material_libs(parser, mesh);
+    }
+
+    if (!successfulRead) {
+        free_mesh_data(&mesh->allocator, &mesh->data, mesh->block);
+        mem_deallocate(&mesh->allocator, mesh->faceRanges.block);
+        release_material_libs(&parser->libs);
+        *mesh = (Obj_Mesh) {.allocator = options->allocator};
+    }
+    return successfulRead;
+}
+
+/*
+ * Reads a mesh out of an in-memory wavefront buffer, which is parsed in place
+ */
+static Obj_Return read_buffer(Obj_Parser *parser, const char *data, size_t len) {
+    const Obj_ReadOptions *options = &parser->options;
+
+    Obj_Mesh mesh = {};
+
+    const char *begin = data;
+    const char *end   = data + len;
+
+    uint32_t numThreads = options->numThreads;
+    if ((size_t)numThreads > len / MIN_CHUNK_SIZE) {
+        numThreads = (uint32_t)(len / MIN_CHUNK_SIZE);
+    }
+
+    bool successfulRead = false;
+    bool grownArrays    = false;
+
+    parser->stats.bytesRead += len;
+    if (options->incremental) {
+        mesh.data = try_get_data_incremental(
+            parser,
+            begin,
+            end,
+            NULL,
+            &mesh.sizes,
+            &mesh.block,
+            &successfulRead
+        );
+    } else if (numThreads > 1u) {
+        mesh.data = try_get_data_chunked(
+            parser,
+            begin,
+            end,
+            numThreads,
+            &mesh.sizes,
+            &mesh.block,
+            &successfulRead
+        );
+    } else {
+        if (options->singlePass) {
+            mesh.sizes  = single_pass_initial_capacity(options->loadFlags);
+            grownArrays = true;
+        } else {
+            double start = start_timer(parser);
+            mesh.sizes   = get_sizes_from_buffer(begin, end, options->loadFlags, NULL);
+
+            Obj_Bounds posBounds = empty_bounds();
+            if (options->quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+                get_bounds_from_buffer(begin, end, &posBounds);
+            }
+            set_position_bounds(parser, posBounds);
+            parser->stats.countSeconds += stop_timer(parser, start);
+        }
+        mesh.data =
+            try_get_data_from_buffer(parser, begin, end, &mesh.sizes, &mesh.block, &successfulRead);
+    }
+
+    successfulRead = finish_read(parser, &mesh, successfulRead, grownArrays);
+    return (Obj_Return) {.successfulRead = successfulRead, .mesh = mesh};
+}
+
+static Obj_Return parse_file(Obj_Parser *parser, const char *path) {
+    const Obj_ReadOptions *options = &parser->options;
+
+    // TODO: sanitise path (trim if too long and remove %p and other known attacks)
+    parser->path = path;
+    reset_errors(parser);
+
+    Obj_Mesh mesh = {};
+
+    FILE *fptr;
+    if (!try_open_obj(parser, &fptr)) {
+        return (Obj_Return) {.successfulRead = false, .mesh = mesh};
+    }
+
+    if (options->verbose) {
+        fprintf(stdout, "Opened obj file %s for reading\n", parser->path);
+    }
+
+    if (options->singlePass) {
+        mesh.sizes = single_pass_initial_capacity(options->loadFlags);
+    } else {
+        if (!get_sizes(parser, fptr, &mesh.sizes)) {
+            fclose(fptr);
+            return (Obj_Return) {.successfulRead = false, .mesh = mesh};
+        }
+        rewind(fptr);
+    }
+
+    bool successfulRead = false;
+
+    mesh.data = try_get_data(parser, fptr, &mesh.sizes, &mesh.block, &successfulRead);
+    fclose(fptr);
+
+    successfulRead = finish_read(parser, &mesh, successfulRead, options->singlePass);
+    return (Obj_Return) {.successfulRead = successfulRead, .mesh = mesh};
+}
+
+static Obj_Return parse_mapped_file(Obj_Parser *parser, const char *path) {
+    parser->path = path;
+    reset_errors(parser);
+
+    Obj_FileMapping mapping;
+    if (!try_map_obj(parser, &mapping)) {
+        return (Obj_Return) {.successfulRead = false};
+    }
+
+    if (parser->options.verbose) {
+        fprintf(stdout, "Mapped obj file %s for reading\n", parser->path);
+    }
+
+    Obj_Return ret = read_buffer(parser, mapping.data, mapping.size);
+    unmap_obj(&mapping);
+    return ret;
+}
+
+/*
+ * Writes the @size bytes at @data to @file, followed by the padding aligning the next array
+ */
+static bool write_padded(FILE *file, const void *data, size_t size) {
+    static const char PADDING[BLOCK_ALIGNMENT] = {0};
+
+    size_t paddingSize = align_block_size(size) - size;
+    return (size == 0u || fwrite(data, 1u, size, file) == size)
+        && (paddingSize == 0u || fwrite(PADDING, 1u, paddingSize, file) == paddingSize);
+}
+
+/*
+ * Writes the face range arrays of @ranges to @file, with the layout carve_face_ranges expects
+ */
+static bool write_face_ranges(FILE *file, const Obj_FaceRanges *ranges) {
+    bool written = true;
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        size_t size = ranges->numRanges[kind] * sizeof(**ranges->ranges);
+        written     = written && write_padded(file, ranges->ranges[kind], size);
+    }
+    return written
+        && write_padded(file, ranges->nameOffsets, ranges->numNames * sizeof(*ranges->nameOffsets))
+        && write_padded(file, ranges->names, ranges->namesSize);
+}
+
+/*
+ * Writes the paths of the material libraries of @mesh to @file, null terminated and back to back,
+ * and returns their size in @size
+ */
+static bool write_material_lib_paths(FILE *file, const Obj_Mesh *mesh, uint32_t *size) {
+    size_t pathsSize = 0u;
+    for (uint32_t i = 0u; i < mesh->numMaterialLibs; ++i) {
+        pathsSize += strlen(mesh->materialLibs[i]->path) + 1u;
+    }
+    if (pathsSize > UINT32_MAX) {
+        return false;
+    }
+
+    char *paths = malloc(pathsSize ? pathsSize : 1u);
+    if (!paths) {
+        return false;
+    }
+    char *cursor = paths;
+    for (uint32_t i = 0u; i < mesh->numMaterialLibs; ++i) {
+        const char *path = mesh->materialLibs[i]->path;
+        copy_pool_string(&cursor, path, path + strlen(path));
+    }
+
+    bool written = write_padded(file, paths, pathsSize);
+    free(paths);
+    *size = (uint32_t)pathsSize;
+    return written;
+}
+
+/*
+ * Writes @mesh, read from the wavefront file of stamp @source, as a binary cache at @path. The
+ * header is written last, so that no valid cache is left behind when writing fails halfway.
+ */
+static bool write_cache(
+    Obj_Parser          *parser,
+    const Obj_Mesh      *mesh,
+    const char          *path,
+    uint32_t             loadFlags,
+    const Obj_FileStamp *source
+) {
+    const Obj_MeshData *data  = &mesh->data;
+    Obj_MeshSizes       sizes = mesh->sizes;
+
+    if (!data->posW) {
+        loadFlags |= OBJ_LOAD_SKIP_POSW;
+    }
+    size_t posWSize = data->posW ? sizes.nPos * sizeof(*data->posW) : 0u;
+
+    if (data->compactFaces || mesh->quantizeFlags) {
+        report_error(parser, OBJ_ERROR_UNSUPPORTED_MESH);
+        return false;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        report_error(parser, OBJ_ERROR_WRITE_FAILED);
+        return false;
+    }
+
+    Obj_CacheHeader header = {
+        .version         = CACHE_VERSION,
+        .byteOrder       = CACHE_BYTE_ORDER,
+        .source          = *source,
+        .loadFlags       = loadFlags,
+        .sizes           = sizes,
+        .numNames        = mesh->faceRanges.numNames,
+        .namesSize       = mesh->faceRanges.namesSize,
+        .numMaterialLibs = mesh->numMaterialLibs,
+    };
+    memcpy(header.numRanges, mesh->faceRanges.numRanges, sizeof(header.numRanges));
+    Obj_CacheHeader blankHeader = {0};
+
+    bool written = write_padded(file, &blankHeader, sizeof(blankHeader))
+                && write_padded(file, data->posX, sizes.nPos * sizeof(*data->posX))
+                && write_padded(file, data->posY, sizes.nPos * sizeof(*data->posY))
+                && write_padded(file, data->posZ, sizes.nPos * sizeof(*data->posZ))
+                && write_padded(file, data->posW, posWSize)
+                && write_padded(file, data->normX, sizes.nNorms * sizeof(*data->normX))
+                && write_padded(file, data->normY, sizes.nNorms * sizeof(*data->normY))
+                && write_padded(file, data->normZ, sizes.nNorms * sizeof(*data->normZ))
+                && write_padded(file, data->texU, sizes.nTex * sizeof(*data->texU))
+                && write_padded(file, data->texV, sizes.nTex * sizeof(*data->texV))
+                && write_padded(file, data->faces, sizes.flatFacesSize * sizeof(*data->faces))
+                && write_padded(file, data->faceSizes, sizes.nFaces * sizeof(*data->faceSizes))
+                && write_face_ranges(file, &mesh->faceRanges)
+                && write_material_lib_paths(file, mesh, &header.materialLibsSize);
+
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    written = written && fflush(file) == 0 && fseek(file, 0, SEEK_SET) == 0
+           && fwrite(&header, sizeof(header), 1u, file) == 1u;
+    written = fclose(file) == 0 && written;
+
+    if (!written) {
+        report_error(parser, OBJ_ERROR_WRITE_FAILED);
+        remove(path);
+    }
+    return written;
+}
+
+/*
+ * Whether the face arrays and ranges of @mesh, mapped from a cache, hold what a read could have
+ * produced, so that a corrupted cache does not send the readers of the mesh out of its arrays:
+ * face sizes adding up to the face vertices, indices 1 and up, ranges within the faces and names
+ * null terminated within their pool
+ */
+static bool is_valid_cached_mesh(const Obj_Mesh *mesh) {
+    const Obj_MeshData   *data   = &mesh->data;
+    const Obj_FaceRanges *ranges = &mesh->faceRanges;
+    Obj_MeshSizes         sizes  = mesh->sizes;
+
+    uint64_t numCorners = 0u;
+    for (uint32_t i = 0u; i < sizes.nFaces; ++i) {
+        numCorners += data->faceSizes[i];
+    }
+    if (numCorners != sizes.flatFacesSize) {
+        return false;
+    }
+    for (uint32_t i = 0u; i < sizes.flatFacesSize; ++i) {
+        Obj_VertIdx vertIdx = data->faces[i];
+        if (vertIdx.posIdx < 1 || vertIdx.texIdx == 0 || vertIdx.texIdx < -1
+            || vertIdx.normIdx == 0 || vertIdx.normIdx < -1) {
+            return false;
+        }
+    }
+
+    for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+        for (uint32_t i = 0u; i < ranges->numRanges[kind]; ++i) {
+            const Obj_FaceRange *range = &ranges->ranges[kind][i];
+            if ((uint64_t)range->firstFace + range->numFaces > sizes.nFaces
+                || (uint64_t)range->firstCorner + range->numCorners > sizes.flatFacesSize
+                || (kind != OBJ_RANGE_SMOOTHING && range->name >= ranges->numNames)) {
+                return false;
+            }
+        }
+    }
+
+    if (ranges->namesSize > 0u && ranges->names[ranges->namesSize - 1u] != '\0') {
+        return false;
+    }
+    for (uint32_t i = 0u; i < ranges->numNames; ++i) {
+        if (ranges->nameOffsets[i] >= ranges->namesSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Whether @size bytes at @paths hold @numPaths null terminated paths
+ */
+static bool are_valid_cached_paths(const char *paths, uint32_t size, uint32_t numPaths) {
+    const char *end = paths + size;
+    for (uint32_t i = 0u; i < numPaths; ++i) {
+        const char *pathEnd = memchr(paths, '\0', (size_t)(end - paths));
+        if (!pathEnd) {
+            return false;
+        }
+        paths = pathEnd + 1;
+    }
+    return true;
+}
+
+/*
+ * Maps the binary cache at @path, and points the arrays of the returned mesh straight into the
+ * mapping. Caches which were not written with @loadFlags, or from a wavefront file of stamp
+ * @source, are skipped, unless these are NULL. The contents are checked before the mesh is handed
+ * out, so that a corrupted cache fails the read rather than being read past.
+ */
+static bool read_cache(
+    Obj_Parser          *parser,
+    const char          *path,
+    const uint32_t      *loadFlags,
+    const Obj_FileStamp *source,
+    Obj_Return          *ret
+) {
+    *ret         = (Obj_Return) {.successfulRead = false};
+    parser->path = path;
+
+    Obj_FileMapping mapping;
+    if (!map_file(parser, &mapping, true)) {
+        return false;
+    }
+
+    Obj_CacheHeader header;
+    size_t          headerSize = align_block_size(sizeof(header));
+    if (mapping.size < headerSize) {
+        report_error(parser, OBJ_ERROR_INVALID_CACHE);
+        unmap_obj(&mapping);
+        return false;
+    }
+    memcpy(&header, mapping.data, sizeof(header));
+
+    bool compatible = memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0
+                   && header.version == CACHE_VERSION && header.byteOrder == CACHE_BYTE_ORDER;
+    if (!compatible) {
+        report_error(parser, OBJ_ERROR_INVALID_CACHE);
+        unmap_obj(&mapping);
+        return false;
+    }
+    if ((loadFlags && header.loadFlags != *loadFlags)
+        || (source && !same_file_stamp(&header.source, source))) {
+        unmap_obj(&mapping);
+        return false;
+    }
+
+    Obj_FaceRanges faceRanges = {
+        .namesSize = header.namesSize,
+        .numNames  = header.numNames,
+    };
+    memcpy(faceRanges.numRanges, header.numRanges, sizeof(faceRanges.numRanges));
+
+    bool   loadPosW   = !(header.loadFlags & OBJ_LOAD_SKIP_POSW);
+    size_t meshSize   = mesh_block_size(header.sizes, loadPosW, OBJ_QUANTIZE_NONE);
+    size_t rangesSize = face_ranges_size(&faceRanges);
+    size_t libsSize   = align_block_size(header.materialLibsSize);
+    if (mapping.size - headerSize < meshSize + rangesSize + libsSize) {
+        report_error(parser, OBJ_ERROR_INVALID_CACHE);
+        unmap_obj(&mapping);
+        return false;
+    }
+
+    Obj_Mesh *mesh = &ret->mesh;
+    char     *arrays = (char *)mapping.data + headerSize;
+    mesh->sizes      = header.sizes;
+    carve_mesh_block(arrays, header.sizes, loadPosW, OBJ_QUANTIZE_NONE, &mesh->data);
+    carve_face_ranges(arrays + meshSize, &faceRanges);
+    mesh->faceRanges = faceRanges;
+
+    const char *libPath = arrays + meshSize + rangesSize;
+    if (!is_valid_cached_mesh(mesh)
+        || !are_valid_cached_paths(libPath, header.materialLibsSize, header.numMaterialLibs)) {
+        report_error(parser, OBJ_ERROR_INVALID_CACHE);
+        *mesh = (Obj_Mesh) {};
+        unmap_obj(&mapping);
+        return false;
+    }
+    mesh->mappingSize = mapping.size;
+    mesh->mapping     = detach_mapping(&mapping);
+
+    // The libraries of cached meshes are loaded again from the paths they were parsed with
+    release_material_libs(&parser->libs);
+    for (uint32_t i = 0u; parser->options.loadMaterials && i < header.numMaterialLibs; ++i) {
+        Obj_MtlEntry *entry = acquire_material_lib(libPath);
+        if (entry) {
+            add_material_lib(&parser->libs, entry);
+        }
+        libPath += strlen(libPath) + 1u;
+    }
+    attach_material_libs(parser, mesh);
+
+    ret->successfulRead = true;
+    return true;
+}
+
+/*
+ * Returns the path of the cache of the file at @path, to be freed by the caller
+ */
+static char *get_cache_path(const char *path) {
+    size_t pathLen   = strlen(path);
+    size_t suffixLen = sizeof(CACHE_SUFFIX) - 1u;
+
+    char *cachePath = malloc(pathLen + suffixLen + 1u);
+    if (cachePath) {
+        memcpy(cachePath, path, pathLen);
+        memcpy(cachePath + pathLen, CACHE_SUFFIX, suffixLen + 1u);
+    }
+    return cachePath;
+}
+
+/*
+ * Reads the file at @path with @parse, unless the options of @parser use caches and the cache of
+ * the file was written from it in its current state, with the same size and modification time.
+ * Files which get parsed then have their cache written, stamped with the state they were in before
+ * being parsed, so that a file changing during the read leaves a cache the next read skips.
+ */
+static Obj_Return read_cached(Obj_Parser *parser, const char *path, Obj_ReadFn parse) {
+    if (!parser->options.useCache) {
+        return parse(parser, path);
+    }
+
+    char *cachePath = get_cache_path(path);
+    if (!cachePath) {
+        return parse(parser, path);
+    }
+
+    uint32_t      loadFlags = parser->options.loadFlags;
+    Obj_FileStamp source;
+    Obj_FileStamp cacheStamp;
+    Obj_Return    ret;
+
+    // Caches of reads generating normals hold them, so only reads generating normals use them
+    if (parser->options.generateNormals) {
+        loadFlags |= CACHE_GENERATED_NORMALS;
+    }
+
+    // Files without a cache yet are not errors
+    bool stamped = get_file_stamp(path, &source);
+    if (stamped && get_file_stamp(cachePath, &cacheStamp)
+        && read_cache(parser, cachePath, &loadFlags, &source, &ret)) {
+        parser->stats.bytesRead += ret.mesh.mappingSize;
+        parser->path = path;
+        free(cachePath);
+        return ret;
+    }
+
+    ret = parse(parser, path);
+    if (ret.successfulRead && stamped) {
+        write_cache(parser, &ret.mesh, cachePath, loadFlags, &source);
+    }
+    parser->path = path;
+    free(cachePath);
+    return ret;
+}
+
+/*
+ * Compacts the faces of a successful read when the options of @parser ask for it. Meshes which
+ * cannot be compacted are still returned as read.
+ */
+static Obj_Return compact_read(Obj_Parser *parser, Obj_Return ret) {
+    if (!ret.successfulRead || !parser->options.compactFaces) {
+        return ret;
+    }
+    if (!compact_faces(&ret.mesh)) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+    } else if (ret.mesh.mapping) {
+        // Faces mapped from a cache are compacted in a new array, others in place
+        size_t size = (size_t)ret.mesh.sizes.flatFacesSize * ret.mesh.faceFormat.stride;
+        track_bytes(parser, &parser->meshBytes, size, 0u);
+    }
+    return ret;
+}
+
+/*
+ * Resets the stats of @parser before a read, and returns the time it starts at
+ */
+static double start_stats(Obj_Parser *parser) {
+    parser->stats     = (Obj_Stats) {.peakBytes = parser->bufferBytes};
+    parser->meshBytes = 0u;
+    return start_timer(parser);
+}
+
+/*
+ * Completes the stats of the read started at @start, and copies them out when asked for
+ */
+static void finish_stats(Obj_Parser *parser, double start) {
+    Obj_Stats *stats = parser->options.stats;
+    if (!stats) {
+        return;
+    }
+
+    static const Obj_LineType UNSUPPORTED[] = {
+        OBJ_VECPARAM,
+        OBJ_LINE,
+        OBJ_MTLSPEC,
+    };
+    for (size_t i = 0u; i < sizeof(UNSUPPORTED) / sizeof(*UNSUPPORTED); ++i) {
+        parser->stats.numUnsupportedLines += parser->stats.numLines[UNSUPPORTED[i]];
+    }
+    parser->stats.totalSeconds = stop_timer(parser, start);
+    *stats                     = parser->stats;
+}
+
+static Obj_Return read_file(Obj_Parser *parser, const char *path) {
+    reset_errors(parser);
+
+    double     start = start_stats(parser);
+    Obj_Return ret   = compact_read(parser, read_cached(parser, path, parse_file));
+    ret.error        = finish_errors(parser);
+    finish_stats(parser, start);
+    return ret;
+}
+
+static Obj_Return read_mapped_file(Obj_Parser *parser, const char *path) {
+    reset_errors(parser);
+
+    double     start = start_stats(parser);
+    Obj_Return ret   = compact_read(parser, read_cached(parser, path, parse_mapped_file));
+    ret.error        = finish_errors(parser);
+    finish_stats(parser, start);
+    return ret;
+}
+
+/*
+ * Frees the arrays, face ranges and material libraries of @mesh, or unmaps the cache it came from
+ */
+static void free_mesh(Obj_Mesh *mesh) {
+    if (mesh->mapping) {
+        mem_deallocate(&mesh->allocator, mesh->data.compactFaces);
+        unmap_view(mesh->mapping, mesh->mappingSize);
+        mesh->data        = (Obj_MeshData) {};
+        mesh->mapping     = NULL;
+        mesh->mappingSize = 0u;
+    } else {
+        free_mesh_data(&mesh->allocator, &mesh->data, mesh->block);
+        mem_deallocate(&mesh->allocator, mesh->faceRanges.block);
+    }
+    detach_material_libs(mesh);
+    mesh->block      = NULL;
+    mesh->faceFormat = (Obj_FaceFormat) {};
+    mesh->faceRanges = (Obj_FaceRanges) {};
+}
+
+/*
+ * Whether @mesh can be a previous mesh of an incremental read of @parser: it must hold the elements
+ * its chunk records describe, with faces which were not compacted
+ */
+static bool matches_chunk_records(const Obj_Parser *parser, const Obj_Mesh *mesh) {
+    Obj_MeshSizes recorded = {0u, 0u, 0u, 0u, 0u};
+    for (uint32_t i = 0u; i < parser->numRecords; ++i) {
+        recorded = add_sizes(recorded, parser->records[i].read);
+    }
+    if (parser->generatedNormals) {
+        recorded.nNorms = recorded.nPos;
+    }
+    return parser->numRecords > 0u && !mesh->mapping && !mesh->data.compactFaces
+        && memcmp(&recorded, &mesh->sizes, sizeof(recorded)) == 0;
+}
+
+/*
+ * Maps the file at @path and reads it again into @mesh, reusing the elements of the chunks which
+ * did not change since the previous incremental read, as long as @mesh is the mesh it returned.
+ * The mesh read replaces @mesh, which is left untouched when the read fails.
+ */
+static bool reload_mapped_file(Obj_Parser *parser, const char *path, Obj_Mesh *mesh) {
+    if (!parser->options.incremental) {
+        Obj_Return ret = read_mapped_file(parser, path);
+        if (ret.successfulRead) {
+            free_mesh(mesh);
+            *mesh = ret.mesh;
+        }
+        return ret.successfulRead;
+    }
+
+    parser->path = path;
+    reset_errors(parser);
+    double start      = start_stats(parser);
+
+    Obj_FileMapping mapping;
+    if (!try_map_obj(parser, &mapping)) {
+        finish_stats(parser, start);
+        return false;
+    }
+    if (parser->options.verbose) {
+        fprintf(stdout, "Mapped obj file %s for reloading\n", parser->path);
+    }
+
+    const Obj_Mesh *previous       = matches_chunk_records(parser, mesh) ? mesh : NULL;
+    Obj_Mesh        reloaded       = {};
+    bool            successfulRead = false;
+    parser->stats.bytesRead += mapping.size;
+    reloaded.data = try_get_data_incremental(
+        parser,
+        mapping.data,
+        mapping.data + mapping.size,
+        previous,
+        &reloaded.sizes,
+        &reloaded.block,
+        &successfulRead
+    );
+    successfulRead = finish_read(parser, &reloaded, successfulRead, false);
+    unmap_obj(&mapping);
+
+    if (successfulRead) {
+        free_mesh(mesh);
+        *mesh = compact_read(parser, (Obj_Return) {.successfulRead = true, .mesh = reloaded}).mesh;
+    }
+    finish_errors(parser);
+    finish_stats(parser, start);
+    return successfulRead;
+}
+
+static Obj_Return read_memory(Obj_Parser *parser, const char *data, size_t len) {
+    parser->path = MEMORY_BUFFER_NAME;
+    reset_errors(parser);
+
+    double     start = start_stats(parser);
+    Obj_Return ret   = compact_read(parser, read_buffer(parser, data, len));
+    ret.error        = finish_errors(parser);
+    finish_stats(parser, start);
+    return ret;
+}
+
+static void init_parser(Obj_Parser *parser, const Obj_ReadOptions *options) {
+    *parser = (Obj_Parser) {};
+    if (options) {
+        parser->options = *options;
+    }
+
+    // Quantizing needs the counts and bounds, and cached meshes hold floats
+    if (parser->options.quantizeFlags) {
+        parser->options.singlePass = false;
+        parser->options.useCache   = false;
+    }
+
+    // Incremental reads need the chunks they parsed, which cached meshes do not have
+    if (parser->options.incremental) {
+        parser->options.useCache = false;
+    }
+
+    if (!parser->options.maxErrors) {
+        parser->options.maxErrors = DEFAULT_MAX_ERRORS;
+    }
+}
+
+static void release_parser(Obj_Parser *parser) {
+    FREE(parser->readBuffers);
+    FREE(parser->lineBuff);
+    parser->readBuffers  = NULL;
+    parser->lineBuff     = NULL;
+    parser->lineBuffSize = 0u;
+    parser->bufferBytes  = 0u;
+    free_range_marks(&parser->marks);
+    free_material_libs(&parser->libs);
+    free_chunk_records(parser->records, parser->numRecords);
+    parser->records    = NULL;
+    parser->numRecords = 0u;
+    FREE(parser->errors);
+    parser->errors         = NULL;
+    parser->errorsCapacity = 0u;
+}
+
+static int compare_pending_files(const void *a, const void *b) {
+    uint64_t aSize = ((const Obj_PendingFile *)a)->size;
+    uint64_t bSize = ((const Obj_PendingFile *)b)->size;
+    return (aSize < bSize) - (aSize > bSize);
+}
+
+static void read_many_task(void *context, uint32_t taskIdx) {
+    Obj_ManyRead *read = context;
+    (void)taskIdx;
+
+    Obj_Parser parser;
+    init_parser(&parser, &read->options);
+
+    uint32_t i;
+    while ((i = atomic_increment(&read->nextFile) - 1u) < read->numFiles) {
+        uint32_t fileIdx       = read->files[i].idx;
+        read->results[fileIdx] = read_mapped_file(&parser, read->paths[fileIdx]);
+    }
+
+    release_parser(&parser);
+}
+
+static bool all_reads_successful(const Obj_Return *results, uint32_t count) {
+    for (uint32_t i = 0u; i < count; ++i) {
+        if (!results[i].successfulRead) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Reads @count files on the threads requested by @options. Files large enough to keep all the
+ * threads busy are read one after the other, split in chunks. The remaining ones are then handed
+ * to the threads from largest to smallest, so small files are packed around the larger ones.
+ */
+static bool read_many(
+    const char *const     *paths,
+    uint32_t               count,
+    Obj_Return            *results,
+    const Obj_ReadOptions *options
+) {
+    Obj_Parser parser;
+    init_parser(&parser, options);
+    parser.options.stats = NULL;
+
+    uint32_t         numThreads = parser.options.numThreads > 1u ? parser.options.numThreads : 1u;
+    Obj_PendingFile *files      = malloc((count ? count : 1u) * sizeof(*files));
+    if (!files) {
+        // Without the memory to schedule them, files are read one after the other
+        for (uint32_t i = 0u; i < count; ++i) {
+            results[i] = read_mapped_file(&parser, paths[i]);
+        }
+        release_parser(&parser);
+        return all_reads_successful(results, count);
+    }
+
+    uint64_t totalSize = 0u;
+    for (uint32_t i = 0u; i < count; ++i) {
+        files[i] = (Obj_PendingFile) {get_file_size(paths[i]), i};
+        totalSize += files[i].size;
+    }
+    qsort(files, count, sizeof(*files), compare_pending_files);
+
+    // Files larger than a fair share of the total are worth splitting across all the threads
+    uint32_t numLarge = 0u;
+    for (; numThreads > 1u && numLarge < count; ++numLarge) {
+        const Obj_PendingFile *file = files + numLarge;
+        if (file->size < 2u * MIN_CHUNK_SIZE || file->size < totalSize / numThreads) {
+            break;
+        }
+        results[file->idx] = read_mapped_file(&parser, paths[file->idx]);
+    }
+    release_parser(&parser);
+
+    Obj_ManyRead read = {
+        .paths    = paths,
+        .results  = results,
+        .files    = files + numLarge,
+        .numFiles = count - numLarge,
+        .options  = parser.options,
+    };
+    read.options.numThreads = 1u;
+
+    if (read.numFiles > 0u) {
+        run_tasks(read_many_task, &read, numThreads < read.numFiles ? numThreads : read.numFiles);
+    }
+    free(files);
+
+    return all_reads_successful(results, count);
+}
+
+/*
+ * Reads the file of @stream into its buffer, after the line carried over from the previous batch,
+ * until it holds at least one complete line or the end of the file. Returns the length of the
+ * lines to parse in the next batch.
+ */
+static bool fill_stream_buffer(Obj_Stream *stream, size_t *linesLen) {
+    Obj_Parser *parser = &stream->parser;
+
+    size_t filled = stream->carryLen;
+    for (;;) {
+        size_t wanted = stream->bufferSize - filled;
+        size_t read   = fread(stream->buffer + filled, 1u, wanted, stream->file);
+        filled += read;
+
+        if (read < wanted) {
+            if (ferror(stream->file)) {
+                report_error(parser, OBJ_ERROR_READ_FAILED);
+                return false;
+            }
+            stream->endOfFile = true;
+            *linesLen         = filled;
+            break;
+        }
+
+        *linesLen = complete_lines_len(stream->buffer, filled);
+        if (*linesLen > 0u) {
+            break;
+        }
+
+        // The whole buffer holds a single line, which it needs to grow for
+        char *buffer = realloc(stream->buffer, 2u * stream->bufferSize);
+        if (!buffer) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        stream->buffer = buffer;
+        stream->bufferSize *= 2u;
+    }
+
+    stream->filledLen = filled;
+    return true;
+}
+
+/*
+ * Parses the next batch of lines of @stream, the elements of which replace those of the previous
+ * batch in the stream arrays
+ */
+static bool read_stream_batch(Obj_Stream *stream) {
+    Obj_ParseState *state = &stream->state;
+
+    state->base  = add_sizes(state->base, state->count);
+    state->count = (Obj_MeshSizes) {0u, 0u, 0u, 0u, 0u};
+
+    size_t linesLen;
+    if (!fill_stream_buffer(stream, &linesLen)
+        || !parse_buffer(state, stream->buffer, stream->buffer + linesLen)) {
+        return false;
+    }
+
+    stream->carryLen = stream->filledLen - linesLen;
+    memmove(stream->buffer, stream->buffer + linesLen, stream->carryLen);
+    return true;
+}
+
+/*
+ * Whether the lines of @type hold elements that reads with @loadFlags load
+ */
+static bool loads_elements(Obj_LineType type, uint32_t loadFlags) {
+    switch (type) {
+        case OBJ_VECPOS:
+            return true;
+        case OBJ_VECTEXT:
+            return !(loadFlags & OBJ_LOAD_SKIP_TEXCOORDS);
+        case OBJ_VECNORM:
+            return !(loadFlags & OBJ_LOAD_SKIP_NORMALS);
+        case OBJ_FACE:
+            return !(loadFlags & OBJ_LOAD_SKIP_FACES);
+        default:
+            return false;
+    }
+}
+
+/*
+ * Returns the Obj_LazyStreams bit of the stream the elements of @type belong to
+ */
+static uint32_t get_lazy_stream(Obj_LineType type) {
+    switch (type) {
+        case OBJ_VECPOS:
+            return OBJ_LAZY_POSITIONS;
+        case OBJ_VECTEXT:
+            return OBJ_LAZY_TEXCOORDS;
+        case OBJ_VECNORM:
+            return OBJ_LAZY_NORMALS;
+        case OBJ_FACE:
+            return OBJ_LAZY_FACES;
+        default:
+            return 0u;
+    }
+}
+
+/*
+ * Extends the last element run of @lazy up to the line of @type spanning the [begin, end) bytes of
+ * the file, or starts a new run with it when the last one holds elements of another kind
+ */
+static bool add_element_line(Obj_LazyMesh *lazy, Obj_LineType type, uint64_t begin, uint64_t end) {
+    Obj_ElementRun *last = lazy->numRuns > 0u ? lazy->runs + lazy->numRuns - 1u : NULL;
+    if (last && last->type == type) {
+        last->end = end;
+        return true;
+    }
+
+    if (lazy->numRuns == lazy->runsCapacity) {
+        uint32_t        capacity = grown_capacity(lazy->runsCapacity, 16u);
+        Obj_ElementRun *grown    = realloc(lazy->runs, (size_t)capacity * sizeof(*grown));
+        if (!grown) {
+            report_error(&lazy->parser, OBJ_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+        lazy->runs         = grown;
+        lazy->runsCapacity = capacity;
+    }
+    lazy->runs[lazy->numRuns++] = (Obj_ElementRun) {
+        .type      = type,
+        .begin     = begin,
+        .end       = end,
+        .firstLine = lazy->lineNum,
+        .base      = lazy->mesh.sizes,
+    };
+    return true;
+}
+
+/*
+ * Counts the elements of the lines of the [begin, end) buffer into the Obj_LazyMesh at @context, as
+ * read_lines hands them out, and records the element runs they belong to
+ */
+static bool index_lines(void *context, const char *begin, const char *end) {
+    Obj_LazyMesh *lazy      = context;
+    uint32_t      loadFlags = lazy->parser.options.loadFlags;
+
+    for (const char *line = begin; line < end;) {
+        const char *lineEnd = memchr(line, '\n', (size_t)(end - line));
+        const char *next    = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+
+        Obj_LineType type = get_line_type(line, lineEnd);
+        if (loads_elements(type, loadFlags)) {
+            uint64_t lineOffset = lazy->offset + (uint64_t)(line - begin);
+            uint64_t nextOffset = lazy->offset + (uint64_t)(next - begin);
+            if (!add_element_line(lazy, type, lineOffset, nextOffset)) {
+                return false;
+            }
+            count_line(&lazy->mesh.sizes, type, line, lineEnd, loadFlags);
+        }
+        ++lazy->lineNum;
+        line = next;
+    }
+
+    if (lazy->parser.options.quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+        get_bounds_from_buffer(begin, end, &lazy->parser.posBounds);
+    }
+    lazy->offset += (uint64_t)(end - begin);
+    return true;
+}
+
+/*
+ * Opens the file of @parser in binary mode, so that the offsets of its lines are those of its bytes
+ */
+static bool open_lazy_file(Obj_Parser *parser, FILE **file) {
+    if (!is_obj_path(parser)) {
+        return false;
+    }
+    *file = fopen(parser->path, "rb");
+    if (!*file) {
+        report_error(parser, OBJ_ERROR_OPEN_FAILED);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Counts the elements of the file of @lazy and records its element runs, reading it either through
+ * its mapping or through read-ahead buffers, which are freed once done
+ */
+static bool index_lazy_file(Obj_LazyMesh *lazy) {
+    Obj_Parser *parser = &lazy->parser;
+    parser->posBounds  = empty_bounds();
+
+    bool indexed;
+    if (lazy->mapped) {
+        if (!try_map_obj(parser, &lazy->mapping)) {
+            lazy->mapped = false;
+            return false;
+        }
+        if (parser->options.verbose) {
+            fprintf(stdout, "Mapped obj file %s for lazy reading\n", parser->path);
+        }
+        indexed = index_lines(lazy, lazy->mapping.data, lazy->mapping.data + lazy->mapping.size);
+    } else {
+        FILE *file;
+        if (!open_lazy_file(parser, &file)) {
+            return false;
+        }
+        if (!get_file_stamp(parser->path, &lazy->fileStamp)) {
+            report_error(parser, OBJ_ERROR_OPEN_FAILED);
+            fclose(file);
+            return false;
+        }
+        if (parser->options.verbose) {
+            fprintf(stdout, "Opened obj file %s for lazy reading\n", parser->path);
+        }
+        indexed = read_lines(parser, file, index_lines, lazy);
+        fclose(file);
+
+        // Loads read the runs through buffers of their own, which only live as long as them
+        release_parser(parser);
+    }
+    if (!indexed) {
+        return false;
+    }
+
+    set_position_bounds(parser, parser->posBounds);
+    lazy->mesh.allocator     = parser->options.allocator;
+    lazy->mesh.quantizeFlags = parser->options.quantizeFlags;
+    if (parser->options.quantizeFlags & OBJ_QUANTIZE_POSITIONS) {
+        lazy->mesh.posBounds = parser->posBounds;
+    }
+    return true;
+}
+
+/*
+ * Opens the file of @lazy again to read its element runs, as long as it did not change since it was
+ * counted
+ */
+static bool reopen_lazy_file(Obj_LazyMesh *lazy, FILE **file) {
+    Obj_Parser *parser = &lazy->parser;
+
+    Obj_FileStamp fileStamp;
+    bool          changed = !get_file_stamp(parser->path, &fileStamp)
+                         || !same_file_stamp(&fileStamp, &lazy->fileStamp);
+    if (changed) {
+        report_error(parser, OBJ_ERROR_FILE_CHANGED);
+        return false;
+    }
+    return open_lazy_file(parser, file);
+}
+
+/*
+ * Parses the element run @run of @file, which is @fileSize bytes long, into @state through
+ * @buffer, of @bufferSize bytes. The buffer only grows to fit lines longer than it.
+ */
+static bool read_element_run(
+    FILE                 *file,
+    uint64_t              fileSize,
+    const Obj_ElementRun *run,
+    Obj_ParseState       *state,
+    char                **buffer,
+    size_t               *bufferSize
+) {
+    Obj_Parser *parser = state->parser;
+    if (!seek_file(file, run->begin)) {
+        report_error(parser, OBJ_ERROR_READ_FAILED);
+        return false;
+    }
+
+    // The last line of the file is counted with a newline, which it may not have
+    uint64_t left   = (run->end < fileSize ? run->end : fileSize) - run->begin;
+    size_t   filled = 0u;
+    while (left > 0u) {
+        if (filled == *bufferSize) {
+            char *grown = realloc(*buffer, 2u * *bufferSize);
+            if (!grown) {
+                report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+                return false;
+            }
+            *buffer = grown;
+            *bufferSize *= 2u;
+        }
+
+        size_t wanted = *bufferSize - filled;
+        if (wanted > left) {
+            wanted = (size_t)left;
+        }
+        if (fread(*buffer + filled, 1u, wanted, file) != wanted) {
+            report_error(parser, OBJ_ERROR_READ_FAILED);
+            return false;
+        }
+        filled += wanted;
+        left -= wanted;
+
+        size_t linesLen = left > 0u ? complete_lines_len(*buffer, filled) : filled;
+        if (!parse_buffer(state, *buffer, *buffer + linesLen)) {
+            return false;
+        }
+        filled -= linesLen;
+        memmove(*buffer, *buffer + linesLen, filled);
+    }
+    return true;
+}
+
+/*
+ * Allocates the arrays of the @streams of the mesh of @lazy, and parses the element runs of these
+ * streams into them, in place in the mapping of the file or by seeking to each run in the file
+ */
+static bool load_lazy_streams(Obj_LazyMesh *lazy, uint32_t streams) {
+    Obj_Parser   *parser = &lazy->parser;
+    Obj_MeshSizes sizes  = lazy->mesh.sizes;
+    Obj_MeshSizes needed = {
+        .nPos          = streams & OBJ_LAZY_POSITIONS ? sizes.nPos : 0u,
+        .nNorms        = streams & OBJ_LAZY_NORMALS ? sizes.nNorms : 0u,
+        .nTex          = streams & OBJ_LAZY_TEXCOORDS ? sizes.nTex : 0u,
+        .nFaces        = streams & OBJ_LAZY_FACES ? sizes.nFaces : 0u,
+        .flatFacesSize = streams & OBJ_LAZY_FACES ? sizes.flatFacesSize : 0u,
+    };
+    if (!reserve_mesh_data(parser, &lazy->mesh.data, &lazy->capacity, needed)) {
+        return false;
+    }
+
+    FILE  *file       = NULL;
+    char  *buffer     = NULL;
+    size_t bufferSize = DEFAULT_STREAM_BUFFER_SIZE;
+    if (!lazy->mapped) {
+        if (!reopen_lazy_file(lazy, &file)) {
+            return false;
+        }
+        buffer = malloc(bufferSize);
+        if (!buffer) {
+            report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+            fclose(file);
+            return false;
+        }
+    }
+
+    bool loaded = true;
+    for (uint32_t i = 0u; loaded && i < lazy->numRuns; ++i) {
+        const Obj_ElementRun *run = lazy->runs + i;
+        if (!(get_lazy_stream(run->type) & streams)) {
+            continue;
+        }
+
+        Obj_ParseState state = {
+            .parser        = parser,
+            .data          = lazy->mesh.data,
+            .capacity      = lazy->capacity,
+            .count         = run->base,
+            .lineNum       = run->firstLine,
+            .offset        = run->begin,
+            .fixedCapacity = true,
+        };
+        if (lazy->mapped) {
+            const char *data = lazy->mapping.data;
+            loaded           = parse_buffer(&state, data + run->begin, data + run->end);
+        } else {
+            loaded =
+                read_element_run(file, lazy->fileStamp.size, run, &state, &buffer, &bufferSize);
+        }
+    }
+
+    if (file) {
+        fclose(file);
+    }
+    free(buffer);
+    return loaded;
+}
+
+static uint32_t hash_vert_idx(Obj_VertIdx vertIdx) {
+    uint32_t hash = (uint32_t)vertIdx.posIdx * 0x9E3779B1u;
+    hash ^= (uint32_t)vertIdx.texIdx * 0x85EBCA77u;
+    hash ^= (uint32_t)vertIdx.normIdx * 0xC2B2AE3Du;
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    return hash ^ (hash >> 13);
+}
+
+static bool same_vert_idx(Obj_VertIdx a, Obj_VertIdx b) {
+    return a.posIdx == b.posIdx && a.texIdx == b.texIdx && a.normIdx == b.normIdx;
+}
+
+/*
+ * Whether the indices of @vertIdx refer to elements of a mesh of @sizes, -1 marking missing
+ * normals and texture coordinates
+ */
+/*
+ * Inserts face vertex @corner in the hash set of @build, which other threads insert into at the
+ * same time. Slots are never emptied and only ever swap a face vertex for an earlier one sharing
+ * its indices, so all the face vertices sharing some indices end up probing the same slot, which
+ * holds the first of them whatever the order of insertion.
+ */
+static void insert_gpu_corner(Obj_GpuBuild *build, uint32_t corner) {
+    const Obj_Mesh *mesh    = build->mesh;
+    Obj_VertIdx     vertIdx = get_face_vertex(mesh, corner);
+
+    size_t slot = hash_vert_idx(vertIdx) & build->tableMask;
+    for (;;) {
+        uint32_t *entry   = build->table + slot;
+        uint32_t  current = atomic_load(entry);
+        if (current == 0u) {
+            if (atomic_compare_exchange(entry, 0u, corner + 1u)) {
+                return;
+            }
+            continue;
+        }
+        if (same_vert_idx(get_face_vertex(mesh, current - 1u), vertIdx)) {
+            if (current - 1u <= corner || atomic_compare_exchange(entry, current, corner + 1u)) {
+                return;
+            }
+            continue;
+        }
+        slot = (slot + 1u) & build->tableMask;
+    }
+}
+
+/*
+ * Returns the first face vertex sharing the indices of face vertex @corner, once all the face
+ * vertices were inserted
+ */
+static uint32_t find_gpu_corner(const Obj_GpuBuild *build, uint32_t corner) {
+    const Obj_Mesh *mesh    = build->mesh;
+    Obj_VertIdx     vertIdx = get_face_vertex(mesh, corner);
+
+    size_t slot = hash_vert_idx(vertIdx) & build->tableMask;
+    while (!same_vert_idx(get_face_vertex(mesh, build->table[slot] - 1u), vertIdx)) {
+        slot = (slot + 1u) & build->tableMask;
+    }
+    return build->table[slot] - 1u;
+}
+
+/*
+ * Validates the face vertices of a range, and inserts those of its triangulated faces in the hash
+ * set
+ */
+static void insert_gpu_range_task(void *context, uint32_t taskIdx) {
+    Obj_GpuBuild   *build = context;
+    Obj_GpuRange   *range = build->ranges + taskIdx;
+    const Obj_Mesh *mesh  = build->mesh;
+
+    range->valid    = true;
+    uint32_t corner = range->firstCorner;
+    for (uint32_t face = range->firstFace; face < range->endFace; ++face) {
+        uint32_t faceSize = mesh->data.faceSizes[face];
+        for (uint32_t i = 0u; i < faceSize; ++i) {
+            if (!is_valid_vert_idx(get_face_vertex(mesh, corner + i), mesh->sizes)) {
+                range->valid = false;
+                return;
+            }
+            if (faceSize >= 3u) {
+                insert_gpu_corner(build, corner + i);
+            }
+        }
+        corner += faceSize;
+    }
+}
+
+/*
+ * Finds the representative of each face vertex of a range, and counts the vertices first appearing
+ * in it
+ */
+static void find_gpu_range_task(void *context, uint32_t taskIdx) {
+    Obj_GpuBuild *build = context;
+    Obj_GpuRange *range = build->ranges + taskIdx;
+
+    range->numVerts = 0u;
+    uint32_t corner = range->firstCorner;
+    for (uint32_t face = range->firstFace; face < range->endFace; ++face) {
+        uint32_t faceSize = build->mesh->data.faceSizes[face];
+        if (faceSize >= 3u) {
+            for (uint32_t i = corner; i < corner + faceSize; ++i) {
+                build->representatives[i] = find_gpu_corner(build, i);
+                range->numVerts += build->representatives[i] == i;
+            }
+        }
+        corner += faceSize;
+    }
+}
+
+/*
+ * Writes the attributes of GPU vertex @vert from the elements face vertex @vertIdx refers to
+ */
+static void write_gpu_vertex(
+    Obj_GpuMesh    *gpuMesh,
+    const Obj_Mesh *mesh,
+    uint32_t        vert,
+    Obj_VertIdx     vertIdx
+) {
+    float pos[3];
+    float norm[3] = {0.f, 0.f, 0.f};
+    float tex[2]  = {0.f, 0.f};
+    get_position(mesh, (uint32_t)vertIdx.posIdx - 1u, pos);
+    if (gpuMesh->hasNormals && vertIdx.normIdx != -1) {
+        get_normal(mesh, (uint32_t)vertIdx.normIdx - 1u, norm);
+    }
+    if (gpuMesh->hasTexCoords && vertIdx.texIdx != -1) {
+        get_texcoord(mesh, (uint32_t)vertIdx.texIdx - 1u, tex);
+    }
+
+    if (!gpuMesh->vertices) {
+        gpuMesh->posX[vert] = pos[0];
+        gpuMesh->posY[vert] = pos[1];
+        gpuMesh->posZ[vert] = pos[2];
+        if (gpuMesh->hasNormals) {
+            gpuMesh->normX[vert] = norm[0];
+            gpuMesh->normY[vert] = norm[1];
+            gpuMesh->normZ[vert] = norm[2];
+        }
+        if (gpuMesh->hasTexCoords) {
+            gpuMesh->texU[vert] = tex[0];
+            gpuMesh->texV[vert] = tex[1];
+        }
+        return;
+    }
+
+    float *vertex = gpuMesh->vertices + (size_t)vert * gpuMesh->stride;
+    *vertex++     = pos[0];
+    *vertex++     = pos[1];
+    *vertex++     = pos[2];
+    if (gpuMesh->hasNormals) {
+        *vertex++ = norm[0];
+        *vertex++ = norm[1];
+        *vertex++ = norm[2];
+    }
+    if (gpuMesh->hasTexCoords) {
+        *vertex++ = tex[0];
+        *vertex   = tex[1];
+    }
+}
+
+/*
+ * Numbers the vertices first appearing in a range, in order, and writes their attributes
+ */
+static void write_gpu_vertices_task(void *context, uint32_t taskIdx) {
+    Obj_GpuBuild       *build = context;
+    Obj_GpuRange       *range = build->ranges + taskIdx;
+    const Obj_MeshData *data  = &build->mesh->data;
+
+    uint32_t vert   = range->firstVert;
+    uint32_t corner = range->firstCorner;
+    for (uint32_t face = range->firstFace; face < range->endFace; ++face) {
+        uint32_t faceSize = data->faceSizes[face];
+        if (faceSize >= 3u) {
+            for (uint32_t i = corner; i < corner + faceSize; ++i) {
+                if (build->representatives[i] == i) {
+                    build->vertIndices[i] = vert;
+                    Obj_VertIdx vertIdx   = get_face_vertex(build->mesh, i);
+                    write_gpu_vertex(build->gpuMesh, build->mesh, vert++, vertIdx);
+                }
+            }
+        }
+        corner += faceSize;
+    }
+}
+
+/*
+ * Computes the normal of the polygon of the @numCorners vertex positions @positions, with Newell's
+ * method so that it holds for non planar and concave polygons
+ */
+static void polygon_normal(
+    const Obj_Mesh *mesh,
+    const uint32_t *positions,
+    uint32_t        numCorners,
+    float           normal[3]
+) {
+    normal[0] = normal[1] = normal[2] = 0.f;
+    for (uint32_t i = 0u; i < numCorners; ++i) {
+        float p[3];
+        float q[3];
+        get_position(mesh, positions[i], p);
+        get_position(mesh, positions[(i + 1u) % numCorners], q);
+        normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+        normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+        normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+    }
+}
+
+static float abs_float(float x) {
+    return x < 0.f ? -x : x;
+}
+
+static float cross_2d(const float *o, const float *a, const float *b) {
+    return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+}
+
+/*
+ * Whether the vertex at position @i of the @numRemaining polygon vertices left is an ear: it is
+ * convex, and no other vertex lies in the triangle it makes with its neighbours.
+ */
+static bool is_ear(
+    const float    *coords,
+    const uint32_t *remaining,
+    uint32_t        numRemaining,
+    uint32_t        i
+) {
+    const float *a = coords + 2u * remaining[(i + numRemaining - 1u) % numRemaining];
+    const float *b = coords + 2u * remaining[i];
+    const float *c = coords + 2u * remaining[(i + 1u) % numRemaining];
+    if (cross_2d(a, b, c) <= 0.f) {
+        return false;
+    }
+
+    for (uint32_t k = 0u; k < numRemaining; ++k) {
+        const float *p = coords + 2u * remaining[k];
+        if (p == a || p == b || p == c) {
+            continue;
+        }
+        if (cross_2d(a, b, p) >= 0.f && cross_2d(b, c, p) >= 0.f && cross_2d(c, a, p) >= 0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Triangulates the polygon of the @numCorners face vertices of @mesh starting at @firstCorner by
+ * clipping its ears, and writes the @numCorners - 2 triangles as positions in the polygon to
+ * @triangles. @scratch holds 3 * @numCorners values. Whatever is left once no ear is found is
+ * fanned out.
+ */
+static void clip_ears(
+    const Obj_Mesh *mesh,
+    uint32_t        firstCorner,
+    uint32_t        numCorners,
+    uint32_t       *scratch,
+    uint32_t       *triangles
+) {
+    uint32_t *remaining = scratch;
+    float    *coords    = (float *)(scratch + numCorners);
+
+    // The remaining vertices first hold the vertex positions of the polygon
+    for (uint32_t i = 0u; i < numCorners; ++i) {
+        remaining[i] = (uint32_t)get_face_vertex(mesh, firstCorner + i).posIdx - 1u;
+    }
+    float normal[3];
+    polygon_normal(mesh, remaining, numCorners, normal);
+
+    // Project the polygon on the axis plane it is the most parallel to, counter-clockwise
+    float    absNormal[3] = {abs_float(normal[0]), abs_float(normal[1]), abs_float(normal[2])};
+    uint32_t dropped      = absNormal[0] > absNormal[1] ? (absNormal[0] > absNormal[2] ? 0u : 2u)
+                                                        : (absNormal[1] > absNormal[2] ? 1u : 2u);
+    float    orientation  = normal[dropped] < 0.f ? -1.f : 1.f;
+
+    for (uint32_t i = 0u; i < numCorners; ++i) {
+        float position[3];
+        get_position(mesh, remaining[i], position);
+        float x             = position[0];
+        float y             = position[1];
+        float z             = position[2];
+        remaining[i]        = i;
+        coords[2u * i]      = dropped == 0u ? y : (dropped == 1u ? z : x);
+        coords[2u * i + 1u] = orientation * (dropped == 0u ? z : (dropped == 1u ? x : y));
+    }
+
+    uint32_t numRemaining = numCorners;
+    uint32_t i            = 0u;
+    for (uint32_t misses = 0u; numRemaining > 3u && misses < numRemaining;) {
+        if (!is_ear(coords, remaining, numRemaining, i)) {
+            i = (i + 1u) % numRemaining;
+            ++misses;
+            continue;
+        }
+        *triangles++ = remaining[(i + numRemaining - 1u) % numRemaining];
+        *triangles++ = remaining[i];
+        *triangles++ = remaining[(i + 1u) % numRemaining];
+        memmove(remaining + i, remaining + i + 1u, (numRemaining - i - 1u) * sizeof(*remaining));
+        --numRemaining;
+        i      = (i + numRemaining - 1u) % numRemaining;
+        misses = 0u;
+    }
+
+    for (uint32_t k = 1u; k + 1u < numRemaining; ++k) {
+        *triangles++ = remaining[0];
+        *triangles++ = remaining[k];
+        *triangles++ = remaining[k + 1u];
+    }
+}
+
+/*
+ * Triangulates the faces of a range, and writes the indices of their triangles
+ */
+static void write_gpu_indices_task(void *context, uint32_t taskIdx) {
+    Obj_GpuBuild       *build   = context;
+    Obj_GpuRange       *range   = build->ranges + taskIdx;
+    Obj_GpuMesh        *gpuMesh = build->gpuMesh;
+    const Obj_MeshData *data    = &build->mesh->data;
+
+    // Ear clipping needs the projected polygon and its remaining vertices, then the triangles
+    uint32_t *scratch = NULL;
+    if (build->options->earClipping && build->maxFaceSize > 3u) {
+        scratch = malloc(6u * (size_t)build->maxFaceSize * sizeof(*scratch));
+    }
+
+    size_t   index  = 3u * (size_t)range->firstTriangle;
+    uint32_t corner = range->firstCorner;
+    for (uint32_t face = range->firstFace; face < range->endFace; ++face) {
+        uint32_t faceSize = data->faceSizes[face];
+        if (faceSize < 3u) {
+            corner += faceSize;
+            continue;
+        }
+
+        uint32_t *vertIndices = build->vertIndices + corner;
+        for (uint32_t i = 0u; i < faceSize; ++i) {
+            if (build->representatives[corner + i] != corner + i) {
+                vertIndices[i] = build->vertIndices[build->representatives[corner + i]];
+            }
+        }
+
+        uint32_t *triangles = scratch ? scratch + 3u * faceSize : NULL;
+        if (triangles && faceSize > 3u) {
+            clip_ears(build->mesh, corner, faceSize, scratch, triangles);
+        }
+        for (uint32_t k = 0u; k < 3u * (faceSize - 2u); ++k) {
+            // Fans make triangles (0, t + 1, t + 2)
+            uint32_t t        = k / 3u;
+            uint32_t fanIdx   = k % 3u == 0u ? 0u : t + k % 3u;
+            uint32_t position = triangles && faceSize > 3u ? triangles[k] : fanIdx;
+            if (gpuMesh->indices16) {
+                gpuMesh->indices16[index++] = (uint16_t)vertIndices[position];
+            } else {
+                gpuMesh->indices32[index++] = vertIndices[position];
+            }
+        }
+        corner += faceSize;
+    }
+    FREE(scratch);
+}
+
+/*
+ * Splits the faces of @mesh in up to @maxRanges ranges holding about as many face vertices each,
+ * and returns how many were made. Also finds the number of triangles and the largest face.
+ */
+static uint32_t split_gpu_ranges(
+    const Obj_Mesh *mesh,
+    Obj_GpuRange   *ranges,
+    uint32_t        maxRanges,
+    uint64_t       *numTriangles,
+    uint32_t       *maxFaceSize
+) {
+    uint32_t rangeSize = mesh->sizes.flatFacesSize / maxRanges;
+    uint32_t numRanges = 0u;
+    uint32_t corner    = 0u;
+    uint64_t triangle  = 0u;
+
+    *maxFaceSize = 0u;
+    for (uint32_t face = 0u; face < mesh->sizes.nFaces; ++numRanges) {
+        Obj_GpuRange *range = ranges + numRanges;
+        *range              = (Obj_GpuRange) {.firstFace = face, .firstCorner = corner};
+        range->firstTriangle = (uint32_t)triangle;
+
+        uint32_t endCorner = numRanges + 1u < maxRanges ? corner + rangeSize : UINT32_MAX;
+        do {
+            uint32_t faceSize = mesh->data.faceSizes[face++];
+            corner += faceSize;
+            triangle += faceSize >= 3u ? faceSize - 2u : 0u;
+            *maxFaceSize = faceSize > *maxFaceSize ? faceSize : *maxFaceSize;
+        } while (face < mesh->sizes.nFaces && corner < endCorner);
+        range->endFace = face;
+    }
+    *numTriangles = triangle;
+    return numRanges;
+}
+
+/*
+ * Allocates an array of @count elements of @size bytes for a GPU mesh, and clears @allocated on
+ * failure. Empty arrays are left NULL.
+ */
+static void *alloc_gpu_array(
+    const Obj_Allocator *allocator,
+    size_t               count,
+    size_t               size,
+    bool                *allocated
+) {
+    if (count == 0u) {
+        return NULL;
+    }
+    void *array = mem_allocate(allocator, count * size, ARRAY_ALIGNMENT);
+    *allocated  = *allocated && array;
+    return array;
+}
+
+/*
+ * Allocates the vertex and index arrays of @gpuMesh, once its sizes are known
+ */
+static bool alloc_gpu_mesh(Obj_GpuMesh *gpuMesh, bool interleaved, bool indices32) {
+    const Obj_Allocator *allocator = &gpuMesh->allocator;
+    size_t               nVerts    = gpuMesh->nVerts;
+    size_t               nIndices  = gpuMesh->nIndices;
+    bool                 allocated = true;
+
+    if (interleaved) {
+        gpuMesh->stride = 3u + (gpuMesh->hasNormals ? 3u : 0u) + (gpuMesh->hasTexCoords ? 2u : 0u);
+        gpuMesh->vertices =
+            alloc_gpu_array(allocator, gpuMesh->stride * nVerts, sizeof(float), &allocated);
+    } else {
+        gpuMesh->posX = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+        gpuMesh->posY = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+        gpuMesh->posZ = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+        if (gpuMesh->hasNormals) {
+            gpuMesh->normX = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+            gpuMesh->normY = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+            gpuMesh->normZ = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+        }
+        if (gpuMesh->hasTexCoords) {
+            gpuMesh->texU = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+            gpuMesh->texV = alloc_gpu_array(allocator, nVerts, sizeof(float), &allocated);
+        }
+    }
+
+    // The largest 16-bit index is left free, as the primitive restart index of graphics APIs
+    if (indices32 || nVerts > UINT16_MAX) {
+        gpuMesh->indices32 = alloc_gpu_array(allocator, nIndices, sizeof(uint32_t), &allocated);
+    } else {
+        gpuMesh->indices16 = alloc_gpu_array(allocator, nIndices, sizeof(uint16_t), &allocated);
+    }
+    return allocated;
+}
+
+static void free_gpu_mesh(Obj_GpuMesh *gpuMesh) {
+    const Obj_Allocator *allocator = &gpuMesh->allocator;
+    mem_deallocate(allocator, gpuMesh->vertices);
+    mem_deallocate(allocator, gpuMesh->posX);
+    mem_deallocate(allocator, gpuMesh->posY);
+    mem_deallocate(allocator, gpuMesh->posZ);
+    mem_deallocate(allocator, gpuMesh->normX);
+    mem_deallocate(allocator, gpuMesh->normY);
+    mem_deallocate(allocator, gpuMesh->normZ);
+    mem_deallocate(allocator, gpuMesh->texU);
+    mem_deallocate(allocator, gpuMesh->texV);
+    mem_deallocate(allocator, gpuMesh->indices16);
+    mem_deallocate(allocator, gpuMesh->indices32);
+    *gpuMesh = (Obj_GpuMesh) {.allocator = *allocator};
+}
+
+/*
+ * Merges the face vertices of @build and allocates its GPU mesh arrays, before the ranges write
+ * them. The hash set keeps the first of the face vertices sharing the same indices, so that a
+ * prefix sum over the number of first occurrences in each range numbers the vertices in the order
+ * they appear, whatever the order the threads ran in.
+ */
+static bool merge_gpu_vertices(Obj_Parser *parser, Obj_GpuBuild *build, uint32_t numRanges) {
+    Obj_GpuMesh *gpuMesh = build->gpuMesh;
+
+    run_tasks(insert_gpu_range_task, build, numRanges);
+    for (uint32_t i = 0u; i < numRanges; ++i) {
+        if (!build->ranges[i].valid) {
+            report_error(parser, OBJ_ERROR_MISSING_ELEMENTS);
+            return false;
+        }
+    }
+
+    run_tasks(find_gpu_range_task, build, numRanges);
+    for (uint32_t i = 0u; i < numRanges; ++i) {
+        build->ranges[i].firstVert = gpuMesh->nVerts;
+        gpuMesh->nVerts += build->ranges[i].numVerts;
+    }
+
+    if (!alloc_gpu_mesh(gpuMesh, build->options->interleaved, build->options->indices32)) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t get_gpu_index(const Obj_GpuMesh *gpuMesh, size_t idx) {
+    return gpuMesh->indices16 ? gpuMesh->indices16[idx] : gpuMesh->indices32[idx];
+}
+
+static void set_gpu_index(Obj_GpuMesh *gpuMesh, size_t idx, uint32_t vert) {
+    if (gpuMesh->indices16) {
+        gpuMesh->indices16[idx] = (uint16_t)vert;
+    } else {
+        gpuMesh->indices32[idx] = vert;
+    }
+}
+
+static void get_gpu_position(const Obj_GpuMesh *gpuMesh, uint32_t vert, float position[3]) {
+    if (gpuMesh->vertices) {
+        memcpy(position, gpuMesh->vertices + (size_t)vert * gpuMesh->stride, 3u * sizeof(float));
+        return;
+    }
+    position[0] = gpuMesh->posX[vert];
+    position[1] = gpuMesh->posY[vert];
+    position[2] = gpuMesh->posZ[vert];
+}
+
+static void free_cache_order(Obj_CacheOrder *order) {
+    FREE(order->indices);
+    FREE(order->liveTriangles);
+    FREE(order->firstTriangles);
+    FREE(order->vertTriangles);
+    FREE(order->cacheTimes);
+    FREE(order->emitted);
+    FREE(order->deadEnds);
+    FREE(order->order);
+    FREE(order->clusters);
+}
+
+/*
+ * Allocates the scratch of the cache order of the @numTriangles triangles of @gpuMesh starting at
+ * @firstTriangle, copies their indices relative to the first vertex they use, and finds the
+ * triangles of each vertex
+ */
+static bool init_cache_order(
+    Obj_CacheOrder    *order,
+    const Obj_GpuMesh *gpuMesh,
+    uint32_t           firstTriangle,
+    uint32_t           numTriangles,
+    uint32_t           cacheSize
+) {
+    size_t   numIndices = 3u * (size_t)numTriangles;
+    size_t   firstIndex = 3u * (size_t)firstTriangle;
+    uint32_t minVert    = UINT32_MAX;
+    uint32_t maxVert    = 0u;
+    for (size_t i = 0u; i < numIndices; ++i) {
+        uint32_t vert = get_gpu_index(gpuMesh, firstIndex + i);
+        minVert       = vert < minVert ? vert : minVert;
+        maxVert       = vert > maxVert ? vert : maxVert;
+    }
+
+    uint32_t numVerts = maxVert - minVert + 1u;
+    *order            = (Obj_CacheOrder) {
+        .indices        = malloc(numIndices * sizeof(*order->indices)),
+        .numVerts       = numVerts,
+        .liveTriangles  = calloc(numVerts, sizeof(*order->liveTriangles)),
+        .firstTriangles = calloc((size_t)numVerts + 1u, sizeof(*order->firstTriangles)),
+        .vertTriangles  = malloc(numIndices * sizeof(*order->vertTriangles)),
+        .cacheTimes     = calloc(numVerts, sizeof(*order->cacheTimes)),
+        .time           = cacheSize + 1u,
+        .emitted        = calloc(numTriangles, sizeof(*order->emitted)),
+        .deadEnds       = malloc(numIndices * sizeof(*order->deadEnds)),
+        .order          = malloc(numTriangles * sizeof(*order->order)),
+        .clusters       = malloc(numTriangles * sizeof(*order->clusters)),
+    };
+    if (!order->indices || !order->liveTriangles || !order->firstTriangles || !order->vertTriangles
+        || !order->cacheTimes || !order->emitted || !order->deadEnds || !order->order
+        || !order->clusters) {
+        free_cache_order(order);
+        return false;
+    }
+
+    for (size_t i = 0u; i < numIndices; ++i) {
+        order->indices[i] = get_gpu_index(gpuMesh, firstIndex + i) - minVert;
+        ++order->liveTriangles[order->indices[i]];
+    }
+    for (uint32_t vert = 0u; vert < numVerts; ++vert) {
+        order->firstTriangles[vert + 1u] = order->firstTriangles[vert] + order->liveTriangles[vert];
+    }
+
+    // Fills the triangles of each vertex, using its cache time as a cursor until the order starts
+    for (size_t i = 0u; i < numIndices; ++i) {
+        uint32_t vert = order->indices[i];
+        uint32_t slot = order->firstTriangles[vert] + order->cacheTimes[vert]++;
+        order->vertTriangles[slot] = (uint32_t)(i / 3u);
+    }
+    memset(order->cacheTimes, 0, numVerts * sizeof(*order->cacheTimes));
+    return true;
+}
+
+/*
+ * Emits the triangles of @vert which are not emitted yet, pushing their vertices on the dead-end
+ * stack, and moving the ones out of the cache back in
+ */
+static void emit_vertex_fan(Obj_CacheOrder *order, uint32_t vert, uint32_t cacheSize) {
+    for (uint32_t i = order->firstTriangles[vert]; i < order->firstTriangles[vert + 1u]; ++i) {
+        uint32_t triangle = order->vertTriangles[i];
+        if (order->emitted[triangle]) {
+            continue;
+        }
+        order->emitted[triangle]            = true;
+        order->order[order->numOrdered++] = triangle;
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            uint32_t corner                      = order->indices[3u * triangle + k];
+            order->deadEnds[order->numDeadEnds++] = corner;
+            --order->liveTriangles[corner];
+            if (order->time - order->cacheTimes[corner] > cacheSize) {
+                order->cacheTimes[corner] = order->time++;
+            }
+        }
+    }
+}
+
+/*
+ * Picks the vertex the next fan is emitted around, among the vertices pushed on the dead-end stack
+ * from @firstCandidate on: the one which entered the cache the earliest, among those which will
+ * still be in it once their triangles left are emitted. When no candidate has triangles left, the
+ * order restarts from the vertices last pushed on the stack, or else from the next vertex with
+ * triangles left, which starts a new cluster. Returns UINT32_MAX once all triangles are emitted.
+ */
+static uint32_t next_fan_vertex(
+    Obj_CacheOrder *order,
+    uint32_t        firstCandidate,
+    uint32_t        cacheSize
+) {
+    uint32_t best         = UINT32_MAX;
+    int64_t  bestPriority = -1;
+    for (uint32_t i = firstCandidate; i < order->numDeadEnds; ++i) {
+        uint32_t vert = order->deadEnds[i];
+        if (order->liveTriangles[vert] == 0u) {
+            continue;
+        }
+        uint64_t age      = order->time - order->cacheTimes[vert];
+        int64_t  priority = age + 2u * (uint64_t)order->liveTriangles[vert] <= cacheSize ? age : 0;
+        if (priority > bestPriority) {
+            bestPriority = priority;
+            best         = vert;
+        }
+    }
+    if (best != UINT32_MAX) {
+        return best;
+    }
+
+    while (order->numDeadEnds > 0u && best == UINT32_MAX) {
+        uint32_t vert = order->deadEnds[--order->numDeadEnds];
+        best          = order->liveTriangles[vert] > 0u ? vert : UINT32_MAX;
+    }
+    while (order->nextVert < order->numVerts && best == UINT32_MAX) {
+        uint32_t vert = order->nextVert++;
+        best          = order->liveTriangles[vert] > 0u ? vert : UINT32_MAX;
+    }
+    if (best != UINT32_MAX) {
+        order->clusters[order->numClusters - 1u].end = order->numOrdered;
+        order->clusters[order->numClusters++]       = (Obj_GpuCluster) {.first = order->numOrdered};
+    }
+    return best;
+}
+
+/*
+ * Orders the triangles of @order for a vertex cache of @cacheSize vertices, with the Tipsify
+ * algorithm of Sander, Nehab and Barczak: triangles are emitted in fans around a vertex, moving on
+ * to a vertex of the fan still in the cache, in linear time
+ */
+static void order_cache_triangles(Obj_CacheOrder *order, uint32_t cacheSize) {
+    order->clusters[0]  = (Obj_GpuCluster) {.first = 0u};
+    order->numClusters  = 1u;
+    uint32_t vert       = order->numVerts > 0u ? 0u : UINT32_MAX;
+    order->nextVert     = 1u;
+    while (vert != UINT32_MAX) {
+        uint32_t firstCandidate = order->numDeadEnds;
+        emit_vertex_fan(order, vert, cacheSize);
+        vert = next_fan_vertex(order, firstCandidate, cacheSize);
+    }
+    order->clusters[order->numClusters - 1u].end = order->numOrdered;
+}
+
+static int compare_gpu_clusters(const void *a, const void *b) {
+    const Obj_GpuCluster *clusterA = a;
+    const Obj_GpuCluster *clusterB = b;
+    if (clusterA->outwardness != clusterB->outwardness) {
+        return clusterA->outwardness > clusterB->outwardness ? -1 : 1;
+    }
+    return clusterA->first < clusterB->first ? -1 : (clusterA->first > clusterB->first);
+}
+
+/*
+ * Sorts the clusters of @order so that the ones lying furthest out of @centroid along their normal
+ * come first. These are the most likely to hide the others from viewpoints outside the mesh, as in
+ * the linear-speed overdraw ordering of Sander et al., while the triangles of each cluster keep
+ * their vertex cache order.
+ */
+static void sort_gpu_clusters(
+    Obj_CacheOrder    *order,
+    const Obj_GpuMesh *gpuMesh,
+    uint32_t           minVert,
+    const float        centroid[3]
+) {
+    for (uint32_t c = 0u; c < order->numClusters; ++c) {
+        Obj_GpuCluster *cluster   = order->clusters + c;
+        float           center[3] = {0.f, 0.f, 0.f};
+        float           normal[3] = {0.f, 0.f, 0.f};
+        for (uint32_t i = cluster->first; i < cluster->end; ++i) {
+            const uint32_t *triangle = order->indices + 3u * order->order[i];
+            float           p[3][3];
+            for (uint32_t k = 0u; k < 3u; ++k) {
+                get_gpu_position(gpuMesh, triangle[k] + minVert, p[k]);
+            }
+            float e1[3]  = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+            float e2[3]  = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+            float ray[3] = {0.f, 0.f, 0.f};
+            cross_3d(e1, e2, ray);
+            for (uint32_t k = 0u; k < 3u; ++k) {
+                center[k] += p[0][k] + p[1][k] + p[2][k];
+                normal[k] += ray[k];
+            }
+        }
+
+        float count = 3.f * (float)(cluster->end - cluster->first);
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            center[k] = center[k] / count - centroid[k];
+        }
+        cluster->outwardness = normalize_3d(normal) > 0.f ? dot_3d(center, normal) : 0.f;
+    }
+    qsort(order->clusters, order->numClusters, sizeof(*order->clusters), compare_gpu_clusters);
+}
+
+/*
+ * Reorders the triangles of a group for the vertex cache, and then for overdraw when asked for
+ */
+static void optimize_gpu_group_task(void *context, uint32_t taskIdx) {
+    Obj_GpuOptimize *optimize     = context;
+    Obj_GpuGroup    *group        = optimize->groups + taskIdx;
+    Obj_GpuMesh     *gpuMesh      = optimize->gpuMesh;
+    uint32_t         numTriangles = group->endTriangle - group->firstTriangle;
+    size_t           firstIndex   = 3u * (size_t)group->firstTriangle;
+
+    Obj_CacheOrder order;
+    group->optimized = numTriangles == 0u;
+    if (numTriangles == 0u
+        || !init_cache_order(&order, gpuMesh, group->firstTriangle, numTriangles,
+                             optimize->cacheSize)) {
+        return;
+    }
+
+    uint32_t minVert = get_gpu_index(gpuMesh, firstIndex) - order.indices[0];
+    order_cache_triangles(&order, optimize->cacheSize);
+    if (optimize->options->optimizeOverdraw) {
+        sort_gpu_clusters(&order, gpuMesh, minVert, optimize->centroid);
+    }
+
+    size_t index = firstIndex;
+    for (uint32_t c = 0u; c < order.numClusters; ++c) {
+        for (uint32_t i = order.clusters[c].first; i < order.clusters[c].end; ++i) {
+            const uint32_t *triangle = order.indices + 3u * order.order[i];
+            for (uint32_t k = 0u; k < 3u; ++k) {
+                set_gpu_index(gpuMesh, index++, triangle[k] + minVert);
+            }
+        }
+    }
+    free_cache_order(&order);
+    group->optimized = true;
+}
+
+/*
+ * Splits the triangles of @optimize in @numGroups groups of consecutive triangles. With several
+ * groups, the triangles are first moved to slabs of the longest axis of the mesh by their
+ * centroid, so that each group covers a part of the surface instead of scattered triangles.
+ */
+static bool split_gpu_groups(Obj_GpuOptimize *optimize, uint32_t numGroups) {
+    Obj_GpuMesh *gpuMesh      = optimize->gpuMesh;
+    uint32_t     numTriangles = gpuMesh->nIndices / 3u;
+    if (numGroups == 1u) {
+        optimize->groups[0] = (Obj_GpuGroup) {.firstTriangle = 0u, .endTriangle = numTriangles};
+        return true;
+    }
+
+    uint32_t *slabs   = malloc(numTriangles * sizeof(*slabs));
+    uint32_t *indices = malloc(gpuMesh->nIndices * sizeof(*indices));
+    if (!slabs || !indices) {
+        FREE(slabs);
+        FREE(indices);
+        return false;
+    }
+
+    float low[3]  = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float high[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (uint32_t vert = 0u; vert < gpuMesh->nVerts; ++vert) {
+        float position[3];
+        get_gpu_position(gpuMesh, vert, position);
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            low[k]  = position[k] < low[k] ? position[k] : low[k];
+            high[k] = position[k] > high[k] ? position[k] : high[k];
+        }
+    }
+    uint32_t axis = high[1] - low[1] > high[0] - low[0] ? 1u : 0u;
+    axis          = high[2] - low[2] > high[axis] - low[axis] ? 2u : axis;
+    float scale   = high[axis] > low[axis] ? (float)numGroups / (high[axis] - low[axis]) : 0.f;
+
+    // Counts the triangles of each slab in the end of its group, then turns the counts to offsets
+    for (uint32_t i = 0u; i < numGroups; ++i) {
+        optimize->groups[i] = (Obj_GpuGroup) {.firstTriangle = 0u, .endTriangle = 0u};
+    }
+    for (uint32_t triangle = 0u; triangle < numTriangles; ++triangle) {
+        float centroid = 0.f;
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            float position[3];
+            get_gpu_position(gpuMesh, get_gpu_index(gpuMesh, 3u * triangle + k), position);
+            centroid += position[axis];
+        }
+        float slab      = (centroid / 3.f - low[axis]) * scale;
+        slab            = slab > 0.f ? slab : 0.f;
+        slabs[triangle] = slab < (float)numGroups ? (uint32_t)slab : numGroups - 1u;
+        ++optimize->groups[slabs[triangle]].endTriangle;
+    }
+    uint32_t first = 0u;
+    for (uint32_t i = 0u; i < numGroups; ++i) {
+        uint32_t count                    = optimize->groups[i].endTriangle;
+        optimize->groups[i].firstTriangle = first;
+        optimize->groups[i].endTriangle   = first;
+        first                            += count;
+    }
+
+    for (uint32_t triangle = 0u; triangle < numTriangles; ++triangle) {
+        size_t slot = 3u * (size_t)optimize->groups[slabs[triangle]].endTriangle++;
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            indices[slot + k] = get_gpu_index(gpuMesh, 3u * triangle + k);
+        }
+    }
+    for (size_t i = 0u; i < gpuMesh->nIndices; ++i) {
+        set_gpu_index(gpuMesh, i, indices[i]);
+    }
+    FREE(slabs);
+    FREE(indices);
+    return true;
+}
+
+/*
+ * Reorders the triangles of @optimize for the vertex cache, in groups reordered in parallel.
+ * Groups only lose a few cache hits at their boundaries.
+ */
+static bool optimize_gpu_triangles(Obj_Parser *parser, Obj_GpuOptimize *optimize) {
+    const Obj_GpuOptions *options      = optimize->options;
+    Obj_GpuMesh          *gpuMesh      = optimize->gpuMesh;
+    uint32_t              numTriangles = gpuMesh->nIndices / 3u;
+    uint32_t              numThreads   = options->numThreads > 1u ? options->numThreads : 1u;
+    uint32_t              numGroups    = numTriangles / MIN_GPU_GROUP_SIZE;
+    numGroups = numGroups < 1u ? 1u : (numGroups < numThreads ? numGroups : numThreads);
+
+    optimize->groups = malloc(numGroups * sizeof(*optimize->groups));
+    if (!optimize->groups || !split_gpu_groups(optimize, numGroups)) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+        FREE(optimize->groups);
+        return false;
+    }
+
+    // Clusters are ordered around the centroid of the whole mesh
+    if (options->optimizeOverdraw && gpuMesh->nVerts > 0u) {
+        double sum[3] = {0.0, 0.0, 0.0};
+        for (uint32_t vert = 0u; vert < gpuMesh->nVerts; ++vert) {
+            float position[3];
+            get_gpu_position(gpuMesh, vert, position);
+            sum[0] += position[0];
+            sum[1] += position[1];
+            sum[2] += position[2];
+        }
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            optimize->centroid[k] = (float)(sum[k] / gpuMesh->nVerts);
+        }
+    }
+
+    run_tasks(optimize_gpu_group_task, optimize, numGroups);
+    bool optimized = true;
+    for (uint32_t i = 0u; i < numGroups; ++i) {
+        optimized = optimized && optimize->groups[i].optimized;
+    }
+    if (!optimized) {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+    }
+    FREE(optimize->groups);
+    return optimized;
+}
+
+/*
+ * Moves a range of vertices to their index in fetch order, in every vertex array
+ */
+static void move_gpu_vertices_task(void *context, uint32_t taskIdx) {
+    Obj_GpuOptimize         *optimize = context;
+    const Obj_GeometryRange *range    = optimize->ranges + taskIdx;
+    for (uint32_t a = 0u; a < optimize->numArrays; ++a) {
+        const float *array = *optimize->arrays[a];
+        size_t       width = optimize->widths[a];
+        for (uint32_t vert = range->first; vert < range->end; ++vert) {
+            float *moved = optimize->moved[a] + optimize->remap[vert] * width;
+            memcpy(moved, array + vert * width, width * sizeof(*moved));
+        }
+    }
+}
+
+/*
+ * Renumbers the vertices of @optimize in the order the triangles first use them, so that vertex
+ * fetches walk the vertex arrays mostly forward. The numbering follows the index buffer in order,
+ * and the vertices are then moved to new arrays in parallel.
+ */
+static bool optimize_gpu_vertex_fetch(Obj_Parser *parser, Obj_GpuOptimize *optimize) {
+    Obj_GpuMesh *gpuMesh = optimize->gpuMesh;
+    uint32_t     nVerts  = gpuMesh->nVerts;
+
+    float **arrays[MAX_GPU_VERTEX_ARRAYS] = {
+        &gpuMesh->posX, &gpuMesh->posY, &gpuMesh->posZ,
+        &gpuMesh->normX, &gpuMesh->normY, &gpuMesh->normZ,
+        &gpuMesh->texU, &gpuMesh->texV,
+    };
+    if (gpuMesh->vertices) {
+        optimize->arrays[0] = &gpuMesh->vertices;
+        optimize->widths[0] = gpuMesh->stride;
+        optimize->numArrays = 1u;
+    }
+    for (uint32_t a = 0u; !gpuMesh->vertices && a < MAX_GPU_VERTEX_ARRAYS; ++a) {
+        if (*arrays[a]) {
+            optimize->arrays[optimize->numArrays]   = arrays[a];
+            optimize->widths[optimize->numArrays++] = 1u;
+        }
+    }
+
+    uint32_t numRanges = num_geometry_ranges(nVerts, optimize->options->numThreads);
+    bool     allocated = true;
+    optimize->remap    = malloc(nVerts * sizeof(*optimize->remap));
+    optimize->ranges   = malloc(numRanges * sizeof(*optimize->ranges));
+    for (uint32_t a = 0u; a < optimize->numArrays; ++a) {
+        size_t count       = (size_t)optimize->widths[a] * nVerts;
+        optimize->moved[a] = alloc_gpu_array(&gpuMesh->allocator, count, sizeof(float), &allocated);
+    }
+    allocated = allocated && optimize->remap && optimize->ranges;
+
+    if (allocated) {
+        memset(optimize->remap, 0xFF, nVerts * sizeof(*optimize->remap));
+        uint32_t next = 0u;
+        for (size_t i = 0u; i < gpuMesh->nIndices; ++i) {
+            uint32_t vert = get_gpu_index(gpuMesh, i);
+            if (optimize->remap[vert] == UINT32_MAX) {
+                optimize->remap[vert] = next++;
+            }
+            set_gpu_index(gpuMesh, i, optimize->remap[vert]);
+        }
+
+        split_position_ranges(nVerts, optimize->ranges, numRanges);
+        run_tasks(move_gpu_vertices_task, optimize, numRanges);
+    } else {
+        report_error(parser, OBJ_ERROR_OUT_OF_MEMORY);
+    }
+
+    // The arrays the vertices are not moved to are the ones freed
+    for (uint32_t a = 0u; a < optimize->numArrays; ++a) {
+        float *unused = allocated ? *optimize->arrays[a] : optimize->moved[a];
+        if (allocated) {
+            *optimize->arrays[a] = optimize->moved[a];
+        }
+        mem_deallocate(&gpuMesh->allocator, unused);
+    }
+    FREE(optimize->remap);
+    FREE(optimize->ranges);
+    return allocated;
+}
+
+/*
+ * Runs the optimizations @options ask for on the triangles and vertices of @gpuMesh, once built
+ */
+static bool optimize_gpu_mesh(
+    Obj_Parser           *parser,
+    Obj_GpuMesh          *gpuMesh,
+    const Obj_GpuOptions *options
+) {
+    Obj_GpuOptimize optimize = {
+        .gpuMesh   = gpuMesh,
+        .options   = options,
+        .cacheSize = options->cacheSize ? options->cacheSize : DEFAULT_GPU_CACHE_SIZE,
+    };
+    if (gpuMesh->nIndices == 0u) {
+        return true;
+    }
+    if (options->optimizeVertexCache && !optimize_gpu_triangles(parser, &optimize)) {
+        return false;
+    }
+    return !options->optimizeVertexFetch || optimize_gpu_vertex_fetch(parser, &optimize);
+}
+
+/*
+ * Builds the GPU mesh of @mesh on the threads requested by @options. The faces are split in
+ * ranges of about as many face vertices, which are merged in parallel through a shared hash set,
+ * and then write their vertices and triangles in parallel again.
+ */
+static bool build_gpu_mesh(
+    const Obj_Mesh       *mesh,
+    const Obj_GpuOptions *options,
+    Obj_GpuMesh          *gpuMesh
+) {
+    Obj_Parser parser;
+    init_parser(&parser, NULL);
+
+    *gpuMesh = (Obj_GpuMesh) {
+        .hasNormals   = mesh->sizes.nNorms > 0u && (mesh->data.normX || mesh->data.quantized.normX),
+        .hasTexCoords = mesh->sizes.nTex > 0u && (mesh->data.texU || mesh->data.quantized.texU),
+        .allocator    = options->allocator,
+    };
+    if (mesh->sizes.nFaces == 0u || (!mesh->data.faces && !mesh->data.compactFaces)) {
+        return alloc_gpu_mesh(gpuMesh, options->interleaved, options->indices32);
+    }
+
+    uint32_t numCorners = mesh->sizes.flatFacesSize;
+    uint32_t numThreads = options->numThreads > 1u ? options->numThreads : 1u;
+    uint32_t maxRanges  = numCorners / MIN_GPU_RANGE_SIZE;
+    maxRanges           = maxRanges < 1u ? 1u : (maxRanges < numThreads ? maxRanges : numThreads);
+
+    // The hash set is kept at most half full, so probe sequences stay short
+    size_t tableSize = 1u;
+    while (tableSize < 2u * (size_t)numCorners) {
+        tableSize *= 2u;
+    }
+
+    Obj_GpuBuild build = {
+        .mesh            = mesh,
+        .options         = options,
+        .gpuMesh         = gpuMesh,
+        .ranges          = malloc(maxRanges * sizeof(*build.ranges)),
+        .table           = calloc(tableSize, sizeof(*build.table)),
+        .tableMask       = tableSize - 1u,
+        .representatives = malloc(numCorners * sizeof(*build.representatives)),
+        .vertIndices     = malloc(numCorners * sizeof(*build.vertIndices)),
+    };
+
+    bool built = build.ranges && build.table && build.representatives && build.vertIndices;
+    if (!built) {
+        report_error(&parser, OBJ_ERROR_OUT_OF_MEMORY);
+    }
+
+    uint64_t numTriangles = 0u;
+    uint32_t numRanges    = 0u;
+    if (built) {
+        numRanges =
+            split_gpu_ranges(mesh, build.ranges, maxRanges, &numTriangles, &build.maxFaceSize);
+        built = 3u * numTriangles <= UINT32_MAX;
+        if (!built) {
+            report_error(&parser, OBJ_ERROR_MESH_TOO_LARGE);
+        }
+    }
+
+    gpuMesh->nIndices = (uint32_t)(3u * numTriangles);
+    built             = built && merge_gpu_vertices(&parser, &build, numRanges);
+    if (built) {
+        run_tasks(write_gpu_vertices_task, &build, numRanges);
+        run_tasks(write_gpu_indices_task, &build, numRanges);
+        built = optimize_gpu_mesh(&parser, gpuMesh, options);
+    }
+    if (!built) {
+        free_gpu_mesh(gpuMesh);
+    }
+
+    FREE(build.ranges);
+    FREE(build.table);
+    FREE(build.representatives);
+    FREE(build.vertIndices);
+    release_parser(&parser);
+    return built;
+}
+
+/*
+ * Releases the GPU mesh and the meshlet block of @meshlets
+ */
+static void free_meshlets(Obj_Meshlets *meshlets) {
+    free_gpu_mesh(&meshlets->mesh);
+    mem_deallocate(&meshlets->mesh.allocator, meshlets->meshlets);
+    *meshlets = (Obj_Meshlets) {.mesh.allocator = meshlets->mesh.allocator};
+}
+
+/*
+ * Splits the triangles of @build in meshlets, each taking triangles in order until the next one
+ * would bring it over the vertex or triangle limit. The first pass only counts the meshlets, their
+ * vertices and triangle bytes, which the second one writes. The triangles of each meshlet start on
+ * a multiple of 4 bytes, the padding being zeroed.
+ */
+static void split_meshlets(Obj_MeshletBuild *build, bool write) {
+    Obj_Meshlets      *meshlets    = build->meshlets;
+    const Obj_GpuMesh *gpuMesh     = &meshlets->mesh;
+    uint32_t           numMeshlets = 0u;
+    uint32_t           numVertices = 0u;
+    uint32_t           numBytes    = 0u;
+    Obj_Meshlet        current     = {0};
+
+    memset(build->stamps, 0xFF, gpuMesh->nVerts * sizeof(*build->stamps));
+    if (write) {
+        memset(meshlets->triangles, 0, meshlets->nTriangleBytes);
+    }
+    for (size_t i = 0u; i < gpuMesh->nIndices; i += 3u) {
+        uint32_t verts[3] = {
+            get_gpu_index(gpuMesh, i),
+            get_gpu_index(gpuMesh, i + 1u),
+            get_gpu_index(gpuMesh, i + 2u),
+        };
+        uint32_t newVerts = (build->stamps[verts[0]] != numMeshlets)
+                          + (build->stamps[verts[1]] != numMeshlets && verts[1] != verts[0])
+                          + (build->stamps[verts[2]] != numMeshlets && verts[2] != verts[0]
+                             && verts[2] != verts[1]);
+        if (current.vertexCount + newVerts > build->maxVertices
+            || current.triangleCount == build->maxTriangles) {
+            if (write) {
+                meshlets->meshlets[numMeshlets] = current;
+            }
+            numVertices += current.vertexCount;
+            numBytes    += (3u * current.triangleCount + 3u) & ~3u;
+            ++numMeshlets;
+            current = (Obj_Meshlet) {.vertexOffset = numVertices, .triangleOffset = numBytes};
+        }
+
+        size_t firstByte = current.triangleOffset + 3u * current.triangleCount;
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            uint32_t vert = verts[k];
+            if (build->stamps[vert] != numMeshlets) {
+                build->stamps[vert] = numMeshlets;
+                build->slots[vert]  = (uint8_t)current.vertexCount;
+                if (write) {
+                    meshlets->vertexIndices[current.vertexOffset + current.vertexCount] = vert;
+                }
+                ++current.vertexCount;
+            }
+            if (write) {
+                meshlets->triangles[firstByte + k] = build->slots[vert];
+            }
+        }
+        ++current.triangleCount;
+    }
+
+    if (current.triangleCount > 0u) {
+        if (write) {
+            meshlets->meshlets[numMeshlets] = current;
+        }
+        numVertices += current.vertexCount;
+        numBytes    += (3u * current.triangleCount + 3u) & ~3u;
+        ++numMeshlets;
+    }
+    meshlets->nMeshlets      = numMeshlets;
+    meshlets->nVertexIndices = numVertices;
+    meshlets->nTriangleBytes = numBytes;
+}
+
+/*
+ * Computes the bounding sphere and normal cone of @meshlet. The sphere is centred on the bounding
+ * box of the vertices. The cone axis is the normalized sum of the triangle normals, and its apex
+ * the point furthest back along the axis which is behind the planes of all triangles, so that
+ * cameras in the cone oriented away from the axis from the apex only see back faces. Meshlets
+ * whose normals spread too much to cull get a cutoff of 1.
+ */
+static void compute_meshlet_bounds(const Obj_Meshlets *meshlets, Obj_Meshlet *meshlet) {
+    const uint32_t *vertexIndices = meshlets->vertexIndices + meshlet->vertexOffset;
+    const uint8_t  *triangles     = meshlets->triangles + meshlet->triangleOffset;
+    float           low[3]        = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float           high[3]       = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (uint32_t i = 0u; i < meshlet->vertexCount; ++i) {
+        float position[3];
+        get_gpu_position(&meshlets->mesh, vertexIndices[i], position);
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            low[k]  = position[k] < low[k] ? position[k] : low[k];
+            high[k] = position[k] > high[k] ? position[k] : high[k];
+        }
+    }
+    for (uint32_t k = 0u; k < 3u; ++k) {
+        meshlet->center[k] = 0.5f * (low[k] + high[k]);
+    }
+    float radius = 0.f;
+    for (uint32_t i = 0u; i < meshlet->vertexCount; ++i) {
+        float position[3];
+        get_gpu_position(&meshlets->mesh, vertexIndices[i], position);
+        float offset[3] = {
+            position[0] - meshlet->center[0],
+            position[1] - meshlet->center[1],
+            position[2] - meshlet->center[2],
+        };
+        float distance = sqrtf(dot_3d(offset, offset));
+        radius         = distance > radius ? distance : radius;
+    }
+    meshlet->radius = radius;
+
+    // Degenerate triangles have a null normal, and constrain neither the axis nor the apex
+    float normals[MAX_MESHLET_TRIANGLES][3];
+    float corners[MAX_MESHLET_TRIANGLES][3];
+    float axis[3] = {0.f, 0.f, 0.f};
+    for (uint32_t t = 0u; t < meshlet->triangleCount; ++t) {
+        float p[3][3];
+        for (uint32_t k = 0u; k < 3u; ++k) {
+            get_gpu_position(&meshlets->mesh, vertexIndices[triangles[3u * t + k]], p[k]);
+        }
+        float e1[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+        float e2[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+        cross_3d(e1, e2, normals[t]);
+        normalize_3d(normals[t]);
+        memcpy(corners[t], p[0], sizeof(corners[t]));
+        axis[0] += normals[t][0];
+        axis[1] += normals[t][1];
+        axis[2] += normals[t][2];
+    }
+
+    bool  hasAxis = normalize_3d(axis) > 0.f;
+    float minDot  = 1.f;
+    for (uint32_t t = 0u; hasAxis && t < meshlet->triangleCount; ++t) {
+        float d = dot_3d(normals[t], axis);
+        minDot  = dot_3d(normals[t], normals[t]) > 0.f && d < minDot ? d : minDot;
+    }
+    memcpy(meshlet->coneAxis, axis, sizeof(axis));
+    memcpy(meshlet->coneApex, meshlet->center, sizeof(meshlet->center));
+    meshlet->coneCutoff = 1.f;
+    if (!hasAxis || minDot <= MIN_MESHLET_CONE_DOT) {
+        return;
+    }
+
+    float maxOffset = 0.f;
+    for (uint32_t t = 0u; t < meshlet->triangleCount; ++t) {
+        float d = dot_3d(normals[t], axis);
+        if (dot_3d(normals[t], normals[t]) == 0.f) {
+            continue;
+        }
+        float toCenter[3] = {
+            meshlet->center[0] - corners[t][0],
+            meshlet->center[1] - corners[t][1],
+            meshlet->center[2] - corners[t][2],
+        };
+        float offset = dot_3d(toCenter, normals[t]) / d;
+        maxOffset    = offset > maxOffset ? offset : maxOffset;
+    }
+    for (uint32_t k = 0u; k < 3u; ++k) {
+        meshlet->coneApex[k] = meshlet->center[k] - axis[k] * maxOffset;
+    }
+    meshlet->coneCutoff = sqrtf(1.f - minDot * minDot);
+}
+
+/*
+ * Computes the bounds of a range of consecutive meshlets
+ */
+static void meshlet_bounds_task(void *context, uint32_t taskIdx) {
+    Obj_MeshletBuild *build      = context;
+    Obj_Meshlets     *meshlets   = build->meshlets;
+    uint32_t          rangeSize  = meshlets->nMeshlets / build->numRanges;
+    uint32_t          first      = taskIdx * rangeSize;
+    uint32_t          end        = taskIdx + 1u < build->numRanges ? first + rangeSize
+                                                                   : meshlets->nMeshlets;
+    for (uint32_t i = first; i < end; ++i) {
+        compute_meshlet_bounds(meshlets, meshlets->meshlets + i);
+    }
+}
+
+/*
+ * Builds the meshlets of @mesh: its GPU mesh is built as obj_gpu_mesh_build does, and its triangles
+ * are split in meshlets in order, before the bounds of the meshlets are computed in parallel. The
+ * index buffer of the GPU mesh is released once the meshlets hold its triangles.
+ */
+static bool build_meshlets(
+    const Obj_Mesh           *mesh,
+    const Obj_MeshletOptions *options,
+    Obj_Meshlets             *meshlets
+) {
+    Obj_Parser parser;
+    init_parser(&parser, NULL);
+
+    Obj_MeshletBuild build = {
+        .meshlets     = meshlets,
+        .maxVertices  = options->maxVertices ? options->maxVertices : DEFAULT_MESHLET_VERTICES,
+        .maxTriangles = options->maxTriangles ? options->maxTriangles : DEFAULT_MESHLET_TRIANGLES,
+    };
+    *meshlets  = (Obj_Meshlets) {.mesh.allocator = options->gpu.allocator};
+    bool built = build.maxVertices >= 3u && build.maxVertices <= MAX_MESHLET_VERTICES
+              && build.maxTriangles <= MAX_MESHLET_TRIANGLES;
+    if (!built) {
+        report_error(&parser, OBJ_ERROR_INVALID_OPTIONS);
+    }
+    built = built && build_gpu_mesh(mesh, &options->gpu, &meshlets->mesh);
+
+    Obj_GpuMesh *gpuMesh = &meshlets->mesh;
+    if (built) {
+        build.stamps = malloc(gpuMesh->nVerts * sizeof(*build.stamps));
+        build.slots  = malloc(gpuMesh->nVerts * sizeof(*build.slots));
+        built        = gpuMesh->nVerts == 0u || (build.stamps && build.slots);
+        if (!built) {
+            report_error(&parser, OBJ_ERROR_OUT_OF_MEMORY);
+        }
+    }
+
+    // The meshlets, their vertex indices and their triangles share a single block, in this order
+    if (built && gpuMesh->nIndices > 0u) {
+        split_meshlets(&build, false);
+        size_t meshletsSize = meshlets->nMeshlets * sizeof(*meshlets->meshlets);
+        size_t indicesSize  = meshlets->nVertexIndices * sizeof(*meshlets->vertexIndices);
+        size_t blockSize    = meshletsSize + indicesSize + meshlets->nTriangleBytes;
+        char  *block        = alloc_gpu_array(&gpuMesh->allocator, blockSize, 1u, &built);
+        if (!built) {
+            report_error(&parser, OBJ_ERROR_OUT_OF_MEMORY);
+        } else {
+            meshlets->meshlets      = (Obj_Meshlet *)block;
+            meshlets->vertexIndices = (uint32_t *)(block + meshletsSize);
+            meshlets->triangles     = (uint8_t *)(block + meshletsSize + indicesSize);
+            split_meshlets(&build, true);
+        }
+    }
+
+    if (built) {
+        uint32_t numThreads = options->gpu.numThreads > 1u ? options->gpu.numThreads : 1u;
+        build.numRanges     = meshlets->nMeshlets / MIN_MESHLET_RANGE_SIZE;
+        build.numRanges     = build.numRanges < 1u ? 1u
+                            : (build.numRanges < numThreads ? build.numRanges : numThreads);
+        run_tasks(meshlet_bounds_task, &build, build.numRanges);
+
+        const Obj_Allocator *allocator = &gpuMesh->allocator;
+        mem_deallocate(allocator, gpuMesh->indices16);
+        mem_deallocate(allocator, gpuMesh->indices32);
+        gpuMesh->indices16 = NULL;
+        gpuMesh->indices32 = NULL;
+        gpuMesh->nIndices  = 0u;
+    } else {
+        free_meshlets(meshlets);
+    }
+
+    FREE(build.stamps);
+    FREE(build.slots);
+    release_parser(&parser);
+    return built;
+}
+
+/*
+ * Returns ceil(log2(5^e)), or 1 when @e is 0
+ */
+static int32_t pow5_bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359u) >> 19) + 1;
+}
+
+/*
+ * Returns floor(log10(2^e))
+ */
+static uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913u) >> 18;
+}
+
+/*
+ * Returns floor(log10(5^e))
+ */
+static uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923u) >> 20;
+}
+
+/*
+ * Whether @value is a multiple of 5^p
+ */
+static bool is_multiple_of_pow5(uint32_t value, uint32_t p) {
+    uint32_t count = 0u;
+    while (value % 5u == 0u && count < p) {
+        value /= 5u;
+        ++count;
+    }
+    return count >= p;
+}
+
+/*
+ * Returns (@m * @factor) >> @shift, @shift being at least 32
+ */
+static uint32_t mul_shift_32(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t low  = (uint64_t)m * (uint32_t)factor;
+    uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((low >> 32) + high) >> (shift - 32));
+}
+
+/*
+ * Returns the decimal with the fewest digits which rounds back to the finite, non zero float of
+ * the given biased exponent and mantissa bits, the closest one to the float when several do. This
+ * is the Ryu algorithm: the float and the bounds of the interval rounding to it are scaled by a
+ * power of ten with a single multiplication each, after which the digits which do not tell them
+ * apart are dropped.
+ */
+static Obj_FloatDecimal get_shortest_decimal(uint32_t ieeeExponent, uint32_t ieeeMantissa) {
+    // The float is m2 * 2^e2, and the bounds of its interval lie halfway to its neighbours
+    int32_t  e2 = (ieeeExponent ? (int32_t)ieeeExponent : 1) - 127 - FLOAT_MANTISSA_BITS - 2;
+    uint32_t m2 = ieeeExponent ? (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa : ieeeMantissa;
+
+    bool     acceptBounds = (m2 & 1u) == 0u;
+    uint32_t mv           = 4u * m2;
+    uint32_t mp           = 4u * m2 + 2u;
+    uint32_t mmShift      = ieeeMantissa != 0u || ieeeExponent <= 1u;
+    uint32_t mm           = 4u * m2 - 1u - mmShift;
+
+    uint32_t vr, vp, vm;
+    int32_t  e10;
+    bool     vmIsTrailingZeros = false;
+    bool     vrIsTrailingZeros = false;
+    uint32_t lastRemovedDigit  = 0u;
+    if (e2 >= 0) {
+        uint32_t q = log10_pow2(e2);
+        int32_t  k = FLOAT_POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+        int32_t  i = -e2 + (int32_t)q + k;
+        e10        = (int32_t)q;
+        vr         = mul_shift_32(mv, FLOAT_POW5_INV_SPLIT[q], i);
+        vp         = mul_shift_32(mp, FLOAT_POW5_INV_SPLIT[q], i);
+        vm         = mul_shift_32(mm, FLOAT_POW5_INV_SPLIT[q], i);
+        if (q != 0u && (vp - 1u) / 10u <= vm / 10u) {
+            // The digit removed last is needed even when no digit is removed below
+            int32_t l        = FLOAT_POW5_INV_BITCOUNT + pow5_bits((int32_t)q - 1) - 1;
+            int32_t j        = -e2 + (int32_t)q - 1 + l;
+            lastRemovedDigit = mul_shift_32(mv, FLOAT_POW5_INV_SPLIT[q - 1u], j) % 10u;
+        }
+        if (q <= 9u) {
+            // At most one of mv, mp and mm is a multiple of 5
+            if (mv % 5u == 0u) {
+                vrIsTrailingZeros = is_multiple_of_pow5(mv, q);
+            } else if (acceptBounds) {
+                vmIsTrailingZeros = is_multiple_of_pow5(mm, q);
+            } else {
+                vp -= is_multiple_of_pow5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = log10_pow5(-e2);
+        int32_t  i = -e2 - (int32_t)q;
+        int32_t  j = (int32_t)q - (pow5_bits(i) - FLOAT_POW5_BITCOUNT);
+        e10        = (int32_t)q + e2;
+        vr         = mul_shift_32(mv, FLOAT_POW5_SPLIT[i], j);
+        vp         = mul_shift_32(mp, FLOAT_POW5_SPLIT[i], j);
+        vm         = mul_shift_32(mm, FLOAT_POW5_SPLIT[i], j);
+        if (q != 0u && (vp - 1u) / 10u <= vm / 10u) {
+            j                = (int32_t)q - 1 - (pow5_bits(i + 1) - FLOAT_POW5_BITCOUNT);
+            lastRemovedDigit = mul_shift_32(mv, FLOAT_POW5_SPLIT[i + 1], j) % 10u;
+        }
+        if (q <= 1u) {
+            // mv has at least two trailing zero bits, mp one, and mm one when mmShift is 1
+            vrIsTrailingZeros = true;
+            if (acceptBounds) {
+                vmIsTrailingZeros = mmShift == 1u;
+            } else {
+                --vp;
+            }
+        } else if (q < 31u) {
+            vrIsTrailingZeros = (mv & ((1u << (q - 1u)) - 1u)) == 0u;
+        }
+    }
+
+    // Drop the digits for as long as the bounds still differ
+    int32_t removed = 0;
+    while (vp / 10u > vm / 10u) {
+        vmIsTrailingZeros = vmIsTrailingZeros && vm % 10u == 0u;
+        vrIsTrailingZeros = vrIsTrailingZeros && lastRemovedDigit == 0u;
+        lastRemovedDigit  = vr % 10u;
+        vr /= 10u;
+        vp /= 10u;
+        vm /= 10u;
+        ++removed;
+    }
+    if (vmIsTrailingZeros) {
+        // The lower bound is exactly representable, and may lose more digits
+        while (vm % 10u == 0u) {
+            vrIsTrailingZeros = vrIsTrailingZeros && lastRemovedDigit == 0u;
+            lastRemovedDigit  = vr % 10u;
+            vr /= 10u;
+            vp /= 10u;
+            vm /= 10u;
+            ++removed;
+        }
+    }
+    if (vrIsTrailingZeros && lastRemovedDigit == 5u && vr % 2u == 0u) {
+        // Exactly halfway, round to even
+        lastRemovedDigit = 4u;
+    }
+
+    // Round up when the digits removed say so, or when vr lies outside the interval
+    bool roundUp = (vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5u;
+    return (Obj_FloatDecimal) {vr + roundUp, e10 + removed};
+}
+
+/*
+ * Writes the decimal digits of @value at @out, and returns their number
+ */
+static uint32_t format_uint(uint32_t value, char *out) {
+    char     digits[MAX_INDEX_TEXT_LEN];
+    uint32_t numDigits = 0u;
+    do {
+        digits[numDigits++] = (char)('0' + value % 10u);
+        value /= 10u;
+    } while (value != 0u);
+
+    for (uint32_t i = 0u; i < numDigits; ++i) {
+        out[i] = digits[numDigits - 1u - i];
+    }
+    return numDigits;
+}
+
+/*
+ * Writes at @out the shortest text parse_float reads back as @value, in plain or scientific
+ * notation whichever is shorter, and returns its length, at most MAX_FLOAT_TEXT_LEN. NaNs lose
+ * their sign and payload.
+ */
+static uint32_t format_float(float value, char *out) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1u);
+    uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & 0xFFu;
+
+    if (ieeeExponent == 0xFFu && ieeeMantissa != 0u) {
+        memcpy(out, "nan", 3u);
+        return 3u;
+    }
+
+    char *c = out;
+    if (bits >> 31) {
+        *c++ = '-';
+    }
+    if (ieeeExponent == 0xFFu) {
+        memcpy(c, "inf", 3u);
+        return (uint32_t)(c - out) + 3u;
+    }
+    if (ieeeExponent == 0u && ieeeMantissa == 0u) {
+        *c++ = '0';
+        return (uint32_t)(c - out);
+    }
+
+    Obj_FloatDecimal decimal = get_shortest_decimal(ieeeExponent, ieeeMantissa);
+    char             digits[MAX_INDEX_TEXT_LEN];
+    int32_t          numDigits = (int32_t)format_uint(decimal.mantissa, digits);
+
+    // Digits before the decimal point, and exponent of the scientific notation
+    int32_t  point     = numDigits + decimal.exponent;
+    int32_t  sciExp    = point - 1;
+    uint32_t sciExpAbs = (uint32_t)(sciExp < 0 ? -sciExp : sciExp);
+    int32_t  sciLen    = numDigits + (numDigits > 1) + 1 + (sciExp < 0) + (sciExpAbs >= 10u) + 1;
+    int32_t  plainLen  = point <= 0 ? 2 - point + numDigits
+                       : (decimal.exponent >= 0 ? point : numDigits + 1);
+
+    if (plainLen <= sciLen) {
+        if (point <= 0) {
+            *c++ = '0';
+            *c++ = '.';
+            memset(c, '0', (size_t)-point);
+            c += -point;
+            memcpy(c, digits, (size_t)numDigits);
+            c += numDigits;
+        } else if (decimal.exponent >= 0) {
+            memcpy(c, digits, (size_t)numDigits);
+            c += numDigits;
+            memset(c, '0', (size_t)decimal.exponent);
+            c += decimal.exponent;
+        } else {
+            memcpy(c, digits, (size_t)point);
+            c += point;
+            *c++ = '.';
+            memcpy(c, digits + point, (size_t)(numDigits - point));
+            c += numDigits - point;
+        }
+        return (uint32_t)(c - out);
+    }
+
+    *c++ = digits[0];
+    if (numDigits > 1) {
+        *c++ = '.';
+        memcpy(c, digits + 1, (size_t)numDigits - 1u);
+        c += numDigits - 1;
+    }
+    *c++ = 'e';
+    if (sciExp < 0) {
+        *c++ = '-';
+    }
+    c += format_uint(sciExpAbs, c);
+    return (uint32_t)(c - out);
+}
+
+/*
+ * Makes room for @len more bytes of text in @chunk, failing it when its text cannot grow
+ */
+static bool reserve_chunk_text(Obj_WriteChunk *chunk, size_t len) {
+    if (chunk->capacity - chunk->size >= len) {
+        return true;
+    }
+
+    size_t capacity = chunk->capacity ? chunk->capacity : WRITE_TEXT_INITIAL_SIZE;
+    while (capacity - chunk->size < len) {
+        capacity *= 2u;
+    }
+    char *text = realloc(chunk->text, capacity);
+    if (!text) {
+        chunk->failed = true;
+        return false;
+    }
+    chunk->text     = text;
+    chunk->capacity = capacity;
+    return true;
+}
+
+/*
+ * Appends to @chunk a vertex line of @type holding the @count floats of @values
+ */
+static void append_vertex_line(
+    Obj_WriteChunk *chunk,
+    Obj_LineType    type,
+    const float    *values,
+    uint32_t        count
+) {
+    if (!reserve_chunk_text(chunk, MAX_VERTEX_LINE_LEN)) {
+        return;
+    }
+
+    char *c = chunk->text + chunk->size;
+    memcpy(c, LINE_SPEC[type].keyword, LINE_SPEC[type].len);
+    c += LINE_SPEC[type].len;
+    for (uint32_t i = 0u; i < count; ++i) {
+        *c++ = ' ';
+        c += format_float(values[i], c);
+    }
+    *c++        = '\n';
+    chunk->size = (size_t)(c - chunk->text);
+}
+
+/*
+ * Appends to @chunk the statement starting @range, one of the @kind face ranges of @mesh
+ */
+static void append_range_line(
+    Obj_WriteChunk      *chunk,
+    const Obj_Mesh      *mesh,
+    Obj_RangeKind        kind,
+    const Obj_FaceRange *range
+) {
+    const Obj_LineSpec *spec = LINE_SPEC + RANGE_LINE_TYPES[kind];
+    const char         *name = get_range_name(mesh, kind, range);
+    size_t              len  = name ? strlen(name) : 0u;
+    if (!reserve_chunk_text(chunk, spec->len + len + MAX_INDEX_TEXT_LEN + 2u)) {
+        return;
+    }
+
+    // Keywords only read as such when a blank follows them, even without a name
+    char *c = chunk->text + chunk->size;
+    memcpy(c, spec->keyword, spec->len);
+    c += spec->len;
+    *c++ = ' ';
+    if (kind == OBJ_RANGE_SMOOTHING) {
+        if (range->name == 0u) {
+            memcpy(c, "off", 3u);
+            c += 3;
+        } else {
+            c += format_uint(range->name, c);
+        }
+    } else if (len > 0u) {
+        memcpy(c, name, len);
+        c += len;
+    }
+    *c++        = '\n';
+    chunk->size = (size_t)(c - chunk->text);
+}
+
+/*
+ * Appends to @chunk the line of the face of @mesh made of the @faceSize face vertices starting at
+ * @firstCorner
+ */
+static void append_face_line(
+    Obj_WriteChunk *chunk,
+    const Obj_Mesh *mesh,
+    uint32_t        firstCorner,
+    uint32_t        faceSize
+) {
+    if (!reserve_chunk_text(chunk, 2u + (size_t)faceSize * MAX_CORNER_TEXT_LEN)) {
+        return;
+    }
+
+    // Faces the skipped face lines left without vertices keep a blank, to read back as such
+    char *c = chunk->text + chunk->size;
+    *c++    = 'f';
+    if (faceSize == 0u) {
+        *c++ = ' ';
+    }
+    for (uint32_t corner = firstCorner; corner < firstCorner + faceSize; ++corner) {
+        Obj_VertIdx vertIdx = get_face_vertex(mesh, corner);
+        *c++                = ' ';
+        c += format_uint((uint32_t)vertIdx.posIdx, c);
+        if (vertIdx.texIdx > 0 || vertIdx.normIdx > 0) {
+            *c++ = '/';
+            if (vertIdx.texIdx > 0) {
+                c += format_uint((uint32_t)vertIdx.texIdx, c);
+            }
+            if (vertIdx.normIdx > 0) {
+                *c++ = '/';
+                c += format_uint((uint32_t)vertIdx.normIdx, c);
+            }
+        }
+    }
+    *c++        = '\n';
+    chunk->size = (size_t)(c - chunk->text);
+}
+
+/*
+ * Formats the lines of a chunk of the mesh being written. The elements of the chunk are numbered
+ * across the positions, texture coordinates, normals and faces, in the order they are written.
+ */
+static void format_chunk_task(void *context, uint32_t taskIdx) {
+    Obj_WavefrontWrite *write = context;
+    const Obj_Mesh     *mesh  = write->mesh;
+    Obj_WriteChunk     *chunk = write->chunks + taskIdx;
+    Obj_MeshSizes       sizes = mesh->sizes;
+
+    uint64_t texBegin  = sizes.nPos;
+    uint64_t normBegin = texBegin + sizes.nTex;
+    uint64_t faceBegin = normBegin + sizes.nNorms;
+    uint64_t element   = chunk->first;
+    float    values[4];
+    chunk->size   = 0u;
+    chunk->failed = false;
+
+    for (; element < chunk->end && element < texBegin; ++element) {
+        uint32_t idx   = (uint32_t)element;
+        uint32_t count = 3u;
+        get_position(mesh, idx, values);
+        if (mesh->data.posW && mesh->data.posW[idx] != 1.0f) {
+            values[3] = mesh->data.posW[idx];
+            count     = 4u;
+        }
+        append_vertex_line(chunk, OBJ_VECPOS, values, count);
+    }
+    for (; element < chunk->end && element < normBegin; ++element) {
+        get_texcoord(mesh, (uint32_t)(element - texBegin), values);
+        append_vertex_line(chunk, OBJ_VECTEXT, values, 2u);
+    }
+    for (; element < chunk->end && element < faceBegin; ++element) {
+        get_normal(mesh, (uint32_t)(element - normBegin), values);
+        append_vertex_line(chunk, OBJ_VECNORM, values, 3u);
+    }
+
+    const Obj_FaceRanges *ranges = &mesh->faceRanges;
+    uint32_t              corner = chunk->firstCorner;
+    for (; element < chunk->end; ++element) {
+        uint32_t face = (uint32_t)(element - faceBegin);
+        for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+            uint32_t next = chunk->nextRanges[kind];
+            if (next < ranges->numRanges[kind] && ranges->ranges[kind][next].firstFace == face) {
+                append_range_line(chunk, mesh, (Obj_RangeKind)kind, ranges->ranges[kind] + next);
+                chunk->nextRanges[kind] = next + 1u;
+            }
+        }
+        append_face_line(chunk, mesh, corner, mesh->data.faceSizes[face]);
+        corner += mesh->data.faceSizes[face];
+    }
+}
+
+/*
+ * Writes the mtllib statements of the material libraries of @mesh to @file
+ */
+static bool write_material_lib_statements(FILE *file, const Obj_Mesh *mesh) {
+    bool written = true;
+    for (uint32_t i = 0u; written && i < mesh->numMaterialLibs; ++i) {
+        written = fputs("mtllib ", file) >= 0 && fputs(mesh->materialLibs[i]->path, file) >= 0
+               && fputc('\n', file) != EOF;
+    }
+    return written;
+}
+
+/*
+ * Writes @mesh as a wavefront file at @path: its material libraries, vertex attributes, then its
+ * faces, preceded by the statements starting their ranges. The lines are formatted in rounds of
+ * WRITE_CHUNK_ELEMENTS elements for each of @numThreads threads, into text buffers then written in
+ * order. Without memory for the chunks, the lines are formatted on the calling thread only. The
+ * file is removed when writing fails.
+ */
+static bool write_wavefront(
+    Obj_Parser     *parser,
+    const Obj_Mesh *mesh,
+    const char     *path,
+    uint32_t        numThreads
+) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        report_error(parser, OBJ_ERROR_WRITE_FAILED);
+        return false;
+    }
+
+    Obj_WriteChunk     single    = {0};
+    uint32_t           numChunks = numThreads > 1u ? numThreads : 1u;
+    Obj_WavefrontWrite write     = {.mesh = mesh};
+    if (numChunks > 1u) {
+        write.chunks = calloc(numChunks, sizeof(*write.chunks));
+    }
+    if (!write.chunks) {
+        write.chunks = &single;
+        numChunks    = 1u;
+    }
+
+    Obj_MeshSizes sizes       = mesh->sizes;
+    uint64_t      faceBegin   = (uint64_t)sizes.nPos + sizes.nTex + sizes.nNorms;
+    uint64_t      numElements = faceBegin + sizes.nFaces;
+    uint64_t      element     = 0u;
+    uint32_t      corner      = 0u;
+
+    uint32_t nextRanges[OBJ_NUM_RANGE_KINDS] = {0};
+    bool     written     = write_material_lib_statements(file, mesh);
+    bool     outOfMemory = false;
+    while (written && element < numElements) {
+        // Each chunk starts at the face vertices and ranges which the previous chunks leave off at
+        uint32_t numRoundChunks = 0u;
+        for (; numRoundChunks < numChunks && element < numElements; ++numRoundChunks) {
+            Obj_WriteChunk *chunk = write.chunks + numRoundChunks;
+            uint64_t        end   = element + WRITE_CHUNK_ELEMENTS;
+            end                   = end < numElements ? end : numElements;
+            for (uint32_t kind = 0u; kind < OBJ_NUM_RANGE_KINDS; ++kind) {
+                const Obj_FaceRange *ranges = mesh->faceRanges.ranges[kind];
+                while (nextRanges[kind] < mesh->faceRanges.numRanges[kind] && element > faceBegin
+                       && ranges[nextRanges[kind]].firstFace < element - faceBegin) {
+                    ++nextRanges[kind];
+                }
+            }
+
+            chunk->first       = element;
+            chunk->end         = end;
+            chunk->firstCorner = corner;
+            memcpy(chunk->nextRanges, nextRanges, sizeof(nextRanges));
+            for (uint64_t face = element > faceBegin ? element : faceBegin; face < end; ++face) {
+                corner += mesh->data.faceSizes[face - faceBegin];
+            }
+            element = end;
+        }
+
+        run_tasks(format_chunk_task, &write, numRoundChunks);
+        for (uint32_t i = 0u; written && i < numRoundChunks; ++i) {
+            const Obj_WriteChunk *chunk = write.chunks + i;
+            outOfMemory                 = chunk->failed;
+            written = !chunk->failed && fwrite(chunk->text, 1u, chunk->size, file) == chunk->size;
+        }
+    }
+
+    for (uint32_t i = 0u; i < numChunks; ++i) {
+        FREE(write.chunks[i].text);
+    }
+    if (write.chunks != &single) {
+        free(write.chunks);
+    }
+
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        report_error(parser, outOfMemory ? OBJ_ERROR_OUT_OF_MEMORY : OBJ_ERROR_WRITE_FAILED);
+        remove(path);
+    }
+    return written;
+}
+
+/**************************************************************************************************
+ * Public methods
+ *************************************************************************************************/
+
+void obj_free(Obj_Mesh *mesh) {
+    free_mesh(mesh);
+}
+
+Obj_Parser *obj_parser_create(const Obj_ReadOptions *options) {
+    Obj_Parser *parser = malloc(sizeof(*parser));
+    if (parser) {
+        init_parser(parser, options);
+    }
+    return parser;
+}
+
+void obj_parser_destroy(Obj_Parser *parser) {
+    if (parser) {
+        release_parser(parser);
+        free(parser);
+    }
+}
+
+uint32_t obj_parser_num_errors(const Obj_Parser *parser) {
+    return parser->numErrors;
+}
+
+const Obj_Error *obj_parser_errors(const Obj_Parser *parser, uint32_t *count) {
+    *count = num_recorded_errors(parser);
+    return parser->errors;
+}
+
+const char *obj_error_string(Obj_ErrorCode code) {
+    if ((unsigned)code >= OBJ_NUM_ERROR_CODES) {
+        return "Unknown error";
+    }
+    return ERROR_STRINGS[code];
+}
+
+Obj_Return obj_parser_read(Obj_Parser *parser, const char *path) {
+    return read_file(parser, path);
+}
+
+Obj_Return obj_parser_read_mmap(Obj_Parser *parser, const char *path) {
+    return read_mapped_file(parser, path);
+}
+
+Obj_Return obj_parser_read_from_memory(Obj_Parser *parser, const char *data, size_t len) {
+    return read_memory(parser, data, len);
+}
+
+bool obj_parser_reload(Obj_Parser *parser, const char *path, Obj_Mesh *mesh) {
+    return reload_mapped_file(parser, path, mesh);
+}
+
+Obj_Return obj_read(const char *path) {
+    return obj_read_ex(path, NULL);
+}
+
+Obj_Return obj_read_ex(const char *path, const Obj_ReadOptions *options) {
+    Obj_Parser parser;
+    init_parser(&parser, options);
+    Obj_Return ret = read_file(&parser, path);
+    release_parser(&parser);
+    return ret;
+}
+
+Obj_Return obj_read_mmap(const char *path, const Obj_ReadOptions *options) {
+    Obj_Parser parser;
+    init_parser(&parser, options);
+    Obj_Return ret = read_mapped_file(&parser, path);
+    release_parser(&parser);
+    return ret;
+}
+
+Obj_Return obj_read_from_memory(const char *data, size_t len, const Obj_ReadOptions *options) {
+    Obj_Parser parser;
+    init_parser(&parser, options);
+    Obj_Return ret = read_memory(&parser, data, len);
+    release_parser(&parser);
+    return ret;
+}
+
+bool obj_compact_faces(Obj_Mesh *mesh) {
+    return compact_faces(mesh);
+}
+
+Obj_VertIdx obj_get_face_vertex(const Obj_Mesh *mesh, uint32_t idx) {
+    return get_face_vertex(mesh, idx);
+}
+
+void obj_get_position(const Obj_Mesh *mesh, uint32_t idx, float position[3]) {
+    get_position(mesh, idx, position);
+}
+
+void obj_get_normal(const Obj_Mesh *mesh, uint32_t idx, float normal[3]) {
+    get_normal(mesh, idx, normal);
+}
+
+void obj_get_texcoord(const Obj_Mesh *mesh, uint32_t idx, float texcoord[2]) {
+    get_texcoord(mesh, idx, texcoord);
+}
+
+const char *obj_get_range_name(
+    const Obj_Mesh      *mesh,
+    Obj_RangeKind        kind,
+    const Obj_FaceRange *range
+) {
+    return get_range_name(mesh, kind, range);
+}
+
+const Obj_Material *obj_find_material(const Obj_Mesh *mesh, const char *name) {
+    return find_material(mesh, name);
+}
+
+void obj_material_cache_clear(void) {
+    clear_material_cache();
+}
+
+bool obj_read_many(
+    const char *const     *paths,
+    uint32_t               count,
+    Obj_Return            *results,
+    const Obj_ReadOptions *options
+) {
+    return read_many(paths, count, results, options);
+}
+
+bool obj_write_cache(const Obj_Mesh *mesh, const char *path) {
+    Obj_Parser parser;
+    init_parser(&parser, NULL);
+    parser.path = path;
+    Obj_FileStamp noSource = {0};
+    return write_cache(&parser, mesh, path, OBJ_LOAD_ALL, &noSource);
+}
+
+Obj_Return obj_read_cache(const char *path) {
+    Obj_Parser parser;
+    init_parser(&parser, NULL);
+    reset_errors(&parser);
+    Obj_Return ret;
+    read_cache(&parser, path, NULL, NULL, &ret);
+    ret.error = finish_errors(&parser);
+    release_parser(&parser);
+    return ret;
+}
+
+bool obj_write(const Obj_Mesh *mesh, const char *path, const Obj_WriteOptions *options) {
+    Obj_WriteOptions defaults = {0};
+    options                   = options ? options : &defaults;
+
+    if (options->format == OBJ_WRITE_CACHE) {
+        return obj_write_cache(mesh, path);
+    }
+
+    Obj_Parser parser;
+    init_parser(&parser, NULL);
+    parser.path = path;
+    return write_wavefront(&parser, mesh, path, options->numThreads);
+}
+
+bool obj_gpu_mesh_build(const Obj_Mesh *mesh, const Obj_GpuOptions *options, Obj_GpuMesh *gpuMesh) {
+    Obj_GpuOptions defaults = {0};
+    return build_gpu_mesh(mesh, options ? options : &defaults, gpuMesh);
+}
+
+void obj_gpu_mesh_free(Obj_GpuMesh *gpuMesh) {
+    free_gpu_mesh(gpuMesh);
+}
+
+bool obj_meshlets_build(
+    const Obj_Mesh           *mesh,
+    const Obj_MeshletOptions *options,
+    Obj_Meshlets             *meshlets
+) {
+    Obj_MeshletOptions defaults = {0};
+    return build_meshlets(mesh, options ? options : &defaults, meshlets);
+}
+
+void obj_meshlets_free(Obj_Meshlets *meshlets) {
+    free_meshlets(meshlets);
+}
+
+Obj_Bounds obj_compute_bounds(const Obj_Mesh *mesh, uint32_t numThreads) {
+    return compute_bounds(mesh, numThreads);
+}
+
+bool obj_compute_normals(
+    const Obj_Mesh *mesh,
+    uint32_t        numThreads,
+    float          *normX,
+    float          *normY,
+    float          *normZ
+) {
+    float *const normals[3] = {normX, normY, normZ};
+    return compute_normals(mesh, numThreads, normals);
+}
+
+bool obj_compute_tangents(
+    const Obj_Mesh *mesh,
+    uint32_t        numThreads,
+    float          *tanX,
+    float          *tanY,
+    float          *tanZ,
+    float          *tanW
+) {
+    float *const tangents[4] = {tanX, tanY, tanZ, tanW};
+    return compute_tangents(mesh, numThreads, tangents);
+}
+
+Obj_Stream *obj_stream_open(const char *path, const Obj_ReadOptions *options, size_t bufferSize) {
+    // The stream keeps its own copy of the path, which errors refer to until it is closed
+    size_t      pathLen = strlen(path);
+    Obj_Stream *stream  = malloc(sizeof(*stream) + pathLen + 1u);
+    if (!stream) {
+        return NULL;
+    }
+    *stream = (Obj_Stream) {.bufferSize = bufferSize ? bufferSize : DEFAULT_STREAM_BUFFER_SIZE};
+    init_parser(&stream->parser, options);
+    stream->parser.options.quantizeFlags = OBJ_QUANTIZE_NONE;
+    stream->parser.options.stats         = NULL;
+    stream->state = (Obj_ParseState) {.parser = &stream->parser};
+
+    char *pathCopy = (char *)(stream + 1);
+    memcpy(pathCopy, path, pathLen + 1u);
+    stream->parser.path = pathCopy;
+
+    if (!try_open_obj(&stream->parser, &stream->file)) {
+        free(stream);
+        return NULL;
+    }
+
+    stream->buffer = malloc(stream->bufferSize);
+    if (!stream->buffer) {
+        report_error(&stream->parser, OBJ_ERROR_OUT_OF_MEMORY);
+        fclose(stream->file);
+        free(stream);
+        return NULL;
+    }
+
+    if (stream->parser.options.verbose) {
+        fprintf(stdout, "Opened obj file %s for streaming\n", stream->parser.path);
+    }
+    return stream;
+}
+
+bool obj_stream_next(Obj_Stream *stream, Obj_Batch *batch) {
+    *batch = (Obj_Batch) {};
+
+    if (stream->failed || (stream->endOfFile && stream->carryLen == 0u)) {
+        return false;
+    }
+    if (!read_stream_batch(stream)) {
+        stream->failed = true;
+        return false;
+    }
+
+    batch->sizes = stream->state.count;
+    batch->base  = stream->state.base;
+    batch->data  = stream->state.data;
+    return true;
+}
+
+bool obj_stream_failed(const Obj_Stream *stream) {
+    return stream->failed;
+}
+
+void obj_stream_close(Obj_Stream *stream) {
+    if (stream) {
+        free_mesh_data(&stream->parser.options.allocator, &stream->state.data, NULL);
+        free(stream->buffer);
+        fclose(stream->file);
+        release_parser(&stream->parser);
+        free(stream);
+    }
+}
+
+Obj_LazyMesh *obj_open_lazy(const char *path, const Obj_ReadOptions *options, bool mapped) {
+    // The lazy mesh keeps its own copy of the path, which its loads open again
+    size_t        pathLen = strlen(path);
+    Obj_LazyMesh *lazy    = malloc(sizeof(*lazy) + pathLen + 1u);
+    if (!lazy) {
+        return NULL;
+    }
+    *lazy = (Obj_LazyMesh) {.mapped = mapped};
+    init_parser(&lazy->parser, options);
+    lazy->parser.options.stats = NULL;
+
+    char *pathCopy = (char *)(lazy + 1);
+    memcpy(pathCopy, path, pathLen + 1u);
+    lazy->parser.path = pathCopy;
+
+    if (!index_lazy_file(lazy)) {
+        obj_lazy_close(lazy);
+        return NULL;
+    }
+    return lazy;
+}
+
+const Obj_Mesh *obj_lazy_mesh(const Obj_LazyMesh *lazy) {
+    return &lazy->mesh;
+}
+
+bool obj_lazy_load(Obj_LazyMesh *lazy, uint32_t streams) {
+    uint32_t missing = streams & OBJ_LAZY_ALL & ~lazy->loaded;
+    if (missing == 0u) {
+        return true;
+    }
+
+    reset_errors(&lazy->parser);
+    bool loaded = load_lazy_streams(lazy, missing);
+    finish_errors(&lazy->parser);
+    if (!loaded) {
+        return false;
+    }
+    lazy->loaded |= missing;
+    return true;
+}
+
+void obj_lazy_close(Obj_LazyMesh *lazy) {
+    if (lazy) {
+        free_mesh_data(&lazy->mesh.allocator, &lazy->mesh.data, NULL);
+        if (lazy->mapped) {
+            unmap_obj(&lazy->mapping);
+        }
+        FREE(lazy->runs);
+        release_parser(&lazy->parser);
+        free(lazy);
+    }
 }
@@ -11,9 +11,10 @@
  * a binary representation of it, and which should be easier to work with/get started. Any
  * re-ordering of the data, such as storing vertices in their own structs/classes using things like
  * float3s or vec3s is left for the user to do. 
- *    Currently, only vertex positions, normals, texture coordinates and faces are supported, and
- * only if the .obj doesn't use relative indices. The author is planning to support groups, objects
- * material declaration and usage, and lines.
+ *    Currently, only vertex positions, normals, texture coordinates and faces are supported, along
+ * with the objects, groups, materials and smoothing groups the faces belong to, and the material
+ * libraries. Relative (negative) face indices are resolved to absolute ones. The author is planning
+ * to support lines.
  *
  * Copyright (c) 2025 Jordan Emme
  *
@@ -44,6 +45,7 @@
 *************************************************************************************************/
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**************************************************************************************************
@@ -74,6 +76,28 @@ typedef struct Obj_VertIdx {
     int32_t texIdx;
 } Obj_VertIdx;
 
+/*
+ * Obj_QuantizedData:
+ *
+ * Vertex attributes of a mesh read with Obj_QuantizeFlags, which replace the float arrays of the
+ * attributes quantized
+ */
+typedef struct Obj_QuantizedData {
+    // Vertex positions, as 16-bit unsigned normalized values spanning the mesh bounds
+    uint16_t *posX;
+    uint16_t *posY;
+    uint16_t *posZ;
+
+    // Vertex normals, as half precision floats
+    uint16_t *normX;
+    uint16_t *normY;
+    uint16_t *normZ;
+
+    // Vertex texture coordinates, as 16-bit unsigned normalized values clamped to [0, 1]
+    uint16_t *texU;
+    uint16_t *texV;
+} Obj_QuantizedData;
+
 typedef struct Obj_MeshData {
     // Vertex position data
     float *posX;
@@ -93,23 +117,927 @@ typedef struct Obj_MeshData {
     // Polygon vertices
     Obj_VertIdx *faces;
 
+    // Compact polygon vertices, replacing faces once obj_compact_faces was called
+    void *compactFaces;
+
     // Faces offsets in previous 3 datasets
     uint32_t *faceSizes;
 
+    // Quantized vertex attributes
+    Obj_QuantizedData quantized;
+
 } Obj_MeshData;
 
+/*
+ * Obj_Bounds:
+ *
+ * Axis aligned bounding box
+ */
+typedef struct Obj_Bounds {
+    float min[3];
+    float max[3];
+} Obj_Bounds;
+
+/*
+ * Obj_FaceStreams:
+ *
+ * Index streams held by compact face vertices besides positions, which are always present
+ */
+typedef enum Obj_FaceStreams {
+    OBJ_FACE_POSITIONS = 0,
+    OBJ_FACE_TEXCOORDS = 1u << 0,
+    OBJ_FACE_NORMALS   = 1u << 1,
+} Obj_FaceStreams;
+
+/*
+ * Obj_FaceFormat:
+ *
+ * Layout of compact face vertices, every one of which takes @stride consecutive bytes holding its
+ * position index, followed by its texture coordinates and normal indices when these streams are
+ * present. Indices are absolute, 0 marking a face vertex without the element.
+ * @streams: Obj_FaceStreams bitmask of the streams present
+ * @indexSize: bytes per index, 2 when all indices fit in 16 bits and 4 otherwise
+ * @stride: bytes per face vertex
+ */
+typedef struct Obj_FaceFormat {
+    uint32_t streams;
+    uint32_t indexSize;
+    uint32_t stride;
+} Obj_FaceFormat;
+
+/*
+ * Obj_RangeKind:
+ *
+ * Statements splitting the faces of a mesh in ranges, each of which spans the faces from one such
+ * statement to the next one of the same kind
+ * @OBJ_RANGE_OBJECT: o statements, naming an object
+ * @OBJ_RANGE_GROUP: g statements, naming a group, or the group names of the line together
+ * @OBJ_RANGE_MATERIAL: usemtl statements, naming the material used
+ * @OBJ_RANGE_SMOOTHING: s statements, setting a smoothing group number, 0 when off
+ */
+typedef enum Obj_RangeKind {
+    OBJ_RANGE_OBJECT    = 0,
+    OBJ_RANGE_GROUP     = 1,
+    OBJ_RANGE_MATERIAL  = 2,
+    OBJ_RANGE_SMOOTHING = 3,
+
+    OBJ_NUM_RANGE_KINDS,
+} Obj_RangeKind;
+
+/*
+ * Obj_FaceRange:
+ *
+ * Consecutive faces sharing the same object, group, material or smoothing group
+ * @firstFace, @numFaces: faces of the range in faceSizes
+ * @firstCorner, @numCorners: face vertices of the range in faces
+ * @name: index of the range name in the mesh names, or the smoothing group number of smoothing
+ *  ranges
+ */
+typedef struct Obj_FaceRange {
+    uint32_t firstFace;
+    uint32_t numFaces;
+    uint32_t firstCorner;
+    uint32_t numCorners;
+    uint32_t name;
+} Obj_FaceRange;
+
+/*
+ * Obj_FaceRanges:
+ *
+ * Face ranges of a mesh for each Obj_RangeKind, in the order of their faces. Faces before the first
+ * statement of a kind belong to no range of that kind. Ranges without faces are left out, and the
+ * ones following a range of the same name extend it instead. Names are interned, so ranges of the
+ * same name share the same index whatever their kind.
+ * @ranges, @numRanges: ranges of each kind
+ * @names: null terminated names, back to back
+ * @namesSize: size of @names in bytes
+ * @nameOffsets, @numNames: offset of each name in @names
+ * @block: single allocation the ranges and names are carved from, NULL when the mesh has no ranges
+ *  or they point into a cache mapping
+ */
+typedef struct Obj_FaceRanges {
+    Obj_FaceRange *ranges[OBJ_NUM_RANGE_KINDS];
+    uint32_t       numRanges[OBJ_NUM_RANGE_KINDS];
+    char          *names;
+    uint32_t       namesSize;
+    uint32_t      *nameOffsets;
+    uint32_t       numNames;
+    void          *block;
+} Obj_FaceRanges;
+
+/*
+ * Obj_Material:
+ *
+ * Material of a material library. Statements missing from the library leave black colours, a
+ * dissolve and an optical density of 1, and a shininess and illumination model of 0. Texture maps
+ * hold their file name as written in the library, without the map options, or NULL when absent.
+ */
+typedef struct Obj_Material {
+    const char *name;
+    float       ambient[3];
+    float       diffuse[3];
+    float       specular[3];
+    float       emissive[3];
+    float       shininess;
+    float       opticalDensity;
+    float       dissolve;
+    uint32_t    illum;
+
+    // Texture maps
+    const char *ambientMap;
+    const char *diffuseMap;
+    const char *specularMap;
+    const char *shininessMap;
+    const char *dissolveMap;
+    const char *bumpMap;
+} Obj_Material;
+
+/*
+ * Obj_MaterialLib:
+ *
+ * Materials of a .mtl file
+ * @path: path of the file, as named by the mtllib statement and relative to the directory of the
+ *  wavefront file, or to the working directory for in-memory reads
+ * @successfulRead: whether the file could be read, failed libraries holding no materials
+ * @materials: materials of the library, in the order they are declared
+ * @numMaterials: number of materials
+ */
+typedef struct Obj_MaterialLib {
+    const char   *path;
+    bool          successfulRead;
+    Obj_Material *materials;
+    uint32_t      numMaterials;
+} Obj_MaterialLib;
+
+/*
+ * Obj_Allocator:
+ *
+ * Memory allocation hooks used for the mesh arrays
+ * @allocate: returns @size bytes aligned on @alignment, a power of two, or NULL on failure
+ * @deallocate: frees memory returned by @allocate
+ * @userData: passed to both callbacks, e.g. to point at a frame or pool allocator
+ */
+typedef struct Obj_Allocator {
+    void *(*allocate)(size_t size, size_t alignment, void *userData);
+    void (*deallocate)(void *ptr, void *userData);
+    void *userData;
+} Obj_Allocator;
+
+/*
+ * Obj_Mesh:
+ *
+ * @allocator: allocator the mesh arrays come from, with NULL callbacks for malloc and free
+ * @block: single block all the mesh arrays are carved from, or NULL when they are allocated
+ *  separately
+ * @mapping: mapped binary cache the mesh arrays point into, or NULL when the mesh was parsed
+ * @mappingSize: size of @mapping in bytes
+ * @faceFormat: layout of the compact face vertices, all zero while faces holds Obj_VertIdx
+ * @quantizeFlags: Obj_QuantizeFlags bitmask of the attributes stored in data.quantized
+ * @posBounds: bounds of the vertex positions, which quantized positions are relative to
+ * @faceRanges: object, group, material and smoothing group ranges of the faces, allocated with
+ *  @allocator
+ * @materialLibs: material libraries of the mtllib statements of a mesh read with loadMaterials, in
+ *  the order of the statements. Libraries are shared by all the meshes referring to them, and are
+ *  read-only.
+ * @numMaterialLibs: number of material libraries
+ */
 typedef struct Obj_Mesh {
-    bool          isValid;
-    Obj_MeshSizes sizes;
-    Obj_MeshData  data;
+    bool           isValid;
+    Obj_MeshSizes  sizes;
+    Obj_MeshData   data;
+    Obj_Allocator  allocator;
+    void          *block;
+    void          *mapping;
+    size_t         mappingSize;
+    Obj_FaceFormat faceFormat;
+    uint32_t       quantizeFlags;
+    Obj_Bounds     posBounds;
+    Obj_FaceRanges faceRanges;
+
+    const Obj_MaterialLib **materialLibs;
+    uint32_t                numMaterialLibs;
 } Obj_Mesh;
 
+/*
+ * Obj_ErrorCode:
+ *
+ * Kinds of errors reads report. Malformed vertex attributes, allocation and I/O failures always
+ * fail the read, while the lines the error policy lets a read skip are left out of the mesh. Face
+ * lines are the exception: a skipped one stays in the mesh as a face without vertices, counted in
+ * nFaces, so that faces are numbered as in the file.
+ * @OBJ_ERROR_NOT_OBJ_FILE: the path does not end with .obj
+ * @OBJ_ERROR_OPEN_FAILED: the file could not be opened, queried or mapped
+ * @OBJ_ERROR_READ_FAILED: the file could not be read
+ * @OBJ_ERROR_WRITE_FAILED: a cache or a wavefront file could not be written
+ * @OBJ_ERROR_OUT_OF_MEMORY: an allocation failed
+ * @OBJ_ERROR_UNKNOWN_LINE: a line starts with no known keyword, and is skipped
+ * @OBJ_ERROR_INVALID_POSITION: a v line holds fewer than 3 coordinates
+ * @OBJ_ERROR_INVALID_TEXCOORD: a vt line holds no coordinate
+ * @OBJ_ERROR_INVALID_NORMAL: a vn line holds fewer than 3 coordinates
+ * @OBJ_ERROR_INVALID_FACE: a face vertex is malformed or its relative index points before the
+ *  first element, and the face is left without vertices
+ * @OBJ_ERROR_DEGENERATE_FACE: a face has fewer than 3 vertices, and is kept as is
+ * @OBJ_ERROR_INVALID_SMOOTHING_GROUP: a s line holds neither a number nor off, and is skipped
+ * @OBJ_ERROR_UNCOUNTED_ELEMENTS: a line holds more elements than the counting pass found
+ * @OBJ_ERROR_MATERIAL_LIB: a material library could not be read, which does not fail the read
+ * @OBJ_ERROR_FILE_CHANGED: a lazily opened file changed since it was opened
+ * @OBJ_ERROR_INVALID_CACHE: a cache is truncated, corrupted or was written by another version
+ * @OBJ_ERROR_UNSUPPORTED_MESH: a mesh with compact faces or quantized attributes was to be cached
+ * @OBJ_ERROR_MISSING_ELEMENTS: faces refer to elements the mesh does not have
+ * @OBJ_ERROR_MESH_TOO_LARGE: a GPU mesh would hold more triangles than 32-bit indices address
+ * @OBJ_ERROR_INVALID_OPTIONS: options are out of their range
+ */
+typedef enum Obj_ErrorCode {
+    OBJ_ERROR_NONE                    = 0,
+    OBJ_ERROR_NOT_OBJ_FILE            = 1,
+    OBJ_ERROR_OPEN_FAILED             = 2,
+    OBJ_ERROR_READ_FAILED             = 3,
+    OBJ_ERROR_WRITE_FAILED            = 4,
+    OBJ_ERROR_OUT_OF_MEMORY           = 5,
+    OBJ_ERROR_UNKNOWN_LINE            = 6,
+    OBJ_ERROR_INVALID_POSITION        = 7,
+    OBJ_ERROR_INVALID_TEXCOORD        = 8,
+    OBJ_ERROR_INVALID_NORMAL          = 9,
+    OBJ_ERROR_INVALID_FACE            = 10,
+    OBJ_ERROR_DEGENERATE_FACE         = 11,
+    OBJ_ERROR_INVALID_SMOOTHING_GROUP = 12,
+    OBJ_ERROR_UNCOUNTED_ELEMENTS      = 13,
+    OBJ_ERROR_MATERIAL_LIB            = 14,
+    OBJ_ERROR_FILE_CHANGED            = 15,
+    OBJ_ERROR_INVALID_CACHE           = 16,
+    OBJ_ERROR_UNSUPPORTED_MESH        = 17,
+    OBJ_ERROR_MISSING_ELEMENTS        = 18,
+    OBJ_ERROR_MESH_TOO_LARGE          = 19,
+    OBJ_ERROR_INVALID_OPTIONS         = 20,
+
+    OBJ_NUM_ERROR_CODES,
+} Obj_ErrorCode;
+
+/*
+ * Obj_Error:
+ *
+ * Error reported by a read
+ * @code: kind of the error
+ * @line: number of the line the error is about, from 1, or 0 when it is about no line
+ * @offset: offset in bytes of the start of that line in the file or buffer read, 0 when there is no
+ *  line
+ */
+typedef struct Obj_Error {
+    Obj_ErrorCode code;
+    uint32_t      line;
+    uint64_t      offset;
+} Obj_Error;
+
+/*
+ * Obj_ErrorPolicy:
+ *
+ * How reads go on past the errors of the lines they can skip, see Obj_ErrorCode
+ * @OBJ_ERRORS_SKIP: skip the lines and keep reading
+ * @OBJ_ERRORS_FAIL_FAST: fail the read at the first error. Chunked reads report the same errors as
+ *  single-threaded ones, dropping those of the lines past the failure.
+ * @OBJ_ERRORS_FAIL_AT_CAP: skip the lines until @maxErrors errors were reported, then fail the
+ *  read. Chunked reads count the errors of all their chunks towards the cap, so they may fail at an
+ *  earlier line than single-threaded ones.
+ */
+typedef enum Obj_ErrorPolicy {
+    OBJ_ERRORS_SKIP        = 0,
+    OBJ_ERRORS_FAIL_FAST   = 1,
+    OBJ_ERRORS_FAIL_AT_CAP = 2,
+} Obj_ErrorPolicy;
+
+/*
+ * Obj_Return:
+ *
+ * @successfulRead: whether the read succeeded
+ * @mesh: mesh read, zero-initialised when the read failed
+ * @error: first error of the read, in the order of the file, with an OBJ_ERROR_NONE code when there
+ *  was none
+ */
 typedef struct Obj_Return {
-    bool     successfulRead;
-    Obj_Mesh mesh;
+    bool      successfulRead;
+    Obj_Mesh  mesh;
+    Obj_Error error;
 } Obj_Return;
 
+/*
+ * Obj_LoadFlags:
+ *
+ * Attribute streams that may be left out of a read. Skipped lines are stepped over without being
+ * tokenized, and the arrays of a skipped stream are neither allocated nor written: they stay NULL
+ * and their count is 0. Faces then hold -1 in place of the skipped normal or texture indices.
+ * @OBJ_LOAD_SKIP_POSW: leaves posW NULL, while still reading the other position coordinates
+ */
+typedef enum Obj_LoadFlags {
+    OBJ_LOAD_ALL            = 0,
+    OBJ_LOAD_SKIP_NORMALS   = 1u << 0,
+    OBJ_LOAD_SKIP_TEXCOORDS = 1u << 1,
+    OBJ_LOAD_SKIP_POSW      = 1u << 2,
+    OBJ_LOAD_SKIP_FACES     = 1u << 3,
+} Obj_LoadFlags;
+
+/*
+ * Obj_QuantizeFlags:
+ *
+ * Vertex attributes which are quantized to 16 bits while being parsed, so that their float arrays
+ * never exist. Quantized positions need the mesh bounds, which the counting pass finds: reads
+ * quantizing them always count the elements first, ignoring @singlePass.
+ * @OBJ_QUANTIZE_POSITIONS: positions, relative to the mesh bounds. posW stays a float when loaded.
+ * @OBJ_QUANTIZE_NORMALS: normals, as half precision floats
+ * @OBJ_QUANTIZE_TEXCOORDS: texture coordinates, clamped to [0, 1]
+ */
+typedef enum Obj_QuantizeFlags {
+    OBJ_QUANTIZE_NONE      = 0,
+    OBJ_QUANTIZE_POSITIONS = 1u << 0,
+    OBJ_QUANTIZE_NORMALS   = 1u << 1,
+    OBJ_QUANTIZE_TEXCOORDS = 1u << 2,
+} Obj_QuantizeFlags;
+
+/*
+ * Obj_LineType:
+ *
+ * Kinds of lines of a wavefront file, identified by their leading keyword. Blank lines count as
+ * comments, and lines starting with no known keyword as OBJ_INVALID_LINE.
+ */
+typedef enum Obj_LineType {
+    OBJ_COMMENT  = 0,
+    OBJ_VECPOS   = 1,
+    OBJ_VECTEXT  = 2,
+    OBJ_VECNORM  = 3,
+    OBJ_VECPARAM = 4,
+    OBJ_FACE     = 5,
+    OBJ_LINE     = 6,
+    OBJ_MTLSPEC  = 7,
+    OBJ_MTLUSE   = 8,
+    OBJ_OBJECT   = 9,
+    OBJ_GROUP    = 10,
+    OBJ_SSHADING = 11,
+
+    OBJ_NUM_LINE_TYPES,
+    OBJ_INVALID_LINE,
+} Obj_LineType;
+
+/*
+ * Obj_Stats:
+ *
+ * Counters and timings of a read, filled when its options ask for them
+ * @bytesRead: bytes read from the file, buffer or cache. Files counted first are read twice.
+ * @numLines: number of lines of each Obj_LineType parsed
+ * @numInvalidLines: number of lines starting with no known keyword
+ * @numUnsupportedLines: number of lines with a known keyword whose data is not read
+ * @countSeconds: time spent counting the elements before parsing them
+ * @allocSeconds: time spent allocating the mesh arrays up front, and trimming or packing them once
+ *  parsed. Arrays grown while parsing count as parsing.
+ * @parseSeconds: time spent parsing the elements into the mesh arrays
+ * @totalSeconds: time spent in the whole read
+ * @peakBytes: largest number of bytes held at once by the mesh arrays and the read buffers, which
+ *  counts grown arrays along with the ones they replace
+ */
+typedef struct Obj_Stats {
+    uint64_t bytesRead;
+    uint64_t numLines[OBJ_NUM_LINE_TYPES];
+    uint64_t numInvalidLines;
+    uint64_t numUnsupportedLines;
+    double   countSeconds;
+    double   allocSeconds;
+    double   parseSeconds;
+    double   totalSeconds;
+    size_t   peakBytes;
+} Obj_Stats;
+
+/*
+ * Obj_ReadOptions:
+ *
+ * Options controlling how a wavefront file is read. A NULL options pointer selects the defaults,
+ * which are those of a zero-initialised struct.
+ * @singlePass: parse the file in a single pass, growing the mesh arrays geometrically as elements
+ *  are read, instead of counting them in a first pass over the file
+ * @shrinkToFit: in single pass mode, trim the mesh arrays to their exact sizes once parsed
+ * @numThreads: number of threads parsing in-memory and mapped files, which are split in chunks at
+ *  line boundaries. Chunked reads always count the elements first, ignoring @singlePass.
+ *  0 or 1 parse on the calling thread only.
+ * @singleBlock: carve all the mesh arrays out of a single, cache line aligned block sized from the
+ *  element counts, so the mesh is freed in one go. Single pass reads grow separate arrays, and pack
+ *  them in the block once done.
+ * @allocator: allocation hooks for the mesh arrays, malloc and free when the callbacks are NULL
+ * @loadFlags: Obj_LoadFlags bitmask of the attribute streams to skip, OBJ_LOAD_ALL by default
+ * @useCache: read files from their binary cache, at their path followed by ".cache", when it was
+ *  written from the file as it is now, of the same size and modification time to the nanosecond,
+ *  and with the same @loadFlags. Files are parsed otherwise, and their cache written for the next
+ *  reads. In-memory reads never use caches.
+ * @compactFaces: store the faces of the meshes read as compact face vertices, see obj_compact_faces
+ * @quantizeFlags: Obj_QuantizeFlags bitmask of the attributes to quantize. Quantized reads do not
+ *  use caches.
+ * @stats: filled with the counters and timings of each read when not NULL. Collecting them costs
+ *  nothing otherwise. obj_read_many and streams leave it untouched.
+ * @verbose: log the files opened to stdout
+ * @loadMaterials: read the material libraries of the mtllib statements into the materialLibs of the
+ *  mesh. Each library is parsed on a thread of its own as soon as its statement is read, while the
+ *  geometry keeps being parsed. Libraries are kept in a process-wide cache keyed by their path,
+ *  so that meshes sharing a library only parse it once, until its file changes. Libraries which
+ *  cannot be read are reported as errors, but do not fail the read.
+ * @generateNormals: give the meshes read without normals the smooth normals of obj_compute_normals,
+ *  one per position, which the face vertices then refer to. They are computed on @numThreads
+ *  threads once the faces are parsed, and reads allocating the mesh up front make room for them
+ *  then. Caches of such reads hold the normals, and only serve reads generating normals.
+ * @incremental: split in-memory and mapped files in chunks whose boundaries depend on their
+ *  content, and keep the content hash, line and element counts of each chunk in the parser, so
+ *  that obj_parser_reload only parses the chunks which changed. Such reads are chunked whatever
+ *  @numThreads, and do not use caches.
+ * @maxErrors: number of errors a parser records for each read, 16 when 0. Further errors are only
+ *  counted. The threads of chunked reads record them as they come, so that the ones recorded are
+ *  not always the first of the file, but they are sorted in the order of the file once read.
+ * @errorPolicy: Obj_ErrorPolicy applied to the lines reads can skip. Errors are never printed.
+ */
+typedef struct Obj_ReadOptions {
+    bool            singlePass;
+    bool            shrinkToFit;
+    uint32_t        numThreads;
+    bool            singleBlock;
+    Obj_Allocator   allocator;
+    uint32_t        loadFlags;
+    bool            useCache;
+    bool            compactFaces;
+    uint32_t        quantizeFlags;
+    Obj_Stats      *stats;
+    bool            verbose;
+    bool            loadMaterials;
+    bool            generateNormals;
+    bool            incremental;
+    uint32_t        maxErrors;
+    Obj_ErrorPolicy errorPolicy;
+} Obj_ReadOptions;
+
+/*
+ * Obj_Parser:
+ *
+ * Reentrant reader context, owning the buffers, options and error state of the reads done with it.
+ * Each parser may only be used by one thread at a time, but any number of parsers may read
+ * concurrently. The obj_read* functions are wrappers using a temporary parser.
+ */
+typedef struct Obj_Parser Obj_Parser;
+
+extern Obj_Parser *obj_parser_create(const Obj_ReadOptions *options);
+extern void        obj_parser_destroy(Obj_Parser *parser);
+extern Obj_Return  obj_parser_read(Obj_Parser *parser, const char *path);
+extern Obj_Return  obj_parser_read_mmap(Obj_Parser *parser, const char *path);
+extern Obj_Return  obj_parser_read_from_memory(Obj_Parser *parser, const char *data, size_t len);
+
+/*
+ * obj_parser_num_errors / obj_parser_errors / obj_error_string:
+ *
+ * obj_parser_num_errors returns the number of errors reported by the last read of @parser.
+ *
+ * obj_parser_errors returns the errors recorded by the last read of @parser, in the order of the
+ * file, and points @count at their number, which the @maxErrors option caps. They stay valid until
+ * the next read.
+ *
+ * obj_error_string returns a static, human readable description of @code.
+ */
+extern uint32_t         obj_parser_num_errors(const Obj_Parser *parser);
+extern const Obj_Error *obj_parser_errors(const Obj_Parser *parser, uint32_t *count);
+extern const char      *obj_error_string(Obj_ErrorCode code);
+
+/*
+ * obj_parser_reload:
+ *
+ * Maps the wavefront file at @path and reads it again into @mesh, which holds the mesh of the last
+ * read of @parser or a zero-initialised mesh. Parsers with the @incremental option only parse the
+ * chunks of the file whose content changed since their last in-memory, mapped or reloaded read,
+ * and copy the elements of the others from @mesh, adjusting their offsets. Chunks whose relative
+ * face indices now resolve differently, or holding mtllib statements, are parsed again, and meshes
+ * whose faces were compacted or that come from a cache are read in full. Other parsers always read
+ * the file in full. The errors of the chunks reused are reported again, at the lines they moved to,
+ * so the parser reports the same errors as a full read. The mesh read replaces @mesh, which is
+ * freed, and is left untouched when the read fails. Stats only count the lines parsed.
+ */
+extern bool obj_parser_reload(Obj_Parser *parser, const char *path, Obj_Mesh *mesh);
+
 extern Obj_Return obj_read(const char *path);
-extern void       obj_free(Obj_Mesh *mesh);
+extern Obj_Return obj_read_ex(const char *path, const Obj_ReadOptions *options);
+
+/*
+ * obj_read_mmap:
+ *
+ * Same as obj_read_ex, but maps the file in memory and parses it in place instead of reading it
+ * through read-ahead buffers.
+ */
+extern Obj_Return obj_read_mmap(const char *path, const Obj_ReadOptions *options);
+
+/*
+ * obj_read_from_memory:
+ *
+ * Reads a mesh from the @len bytes of wavefront data held at @data, e.g. as received from the
+ * network or extracted from an archive. The buffer needs neither be null terminated nor outlive the
+ * call, and is parsed in place like a mapped file.
+ */
+extern Obj_Return obj_read_from_memory(
+    const char            *data,
+    size_t                 len,
+    const Obj_ReadOptions *options
+);
+extern void obj_free(Obj_Mesh *mesh);
+
+/*
+ * obj_compact_faces / obj_get_face_vertex:
+ *
+ * Replace the faces of a mesh, three 32-bit indices for each face vertex, by compact face vertices
+ * holding only the index streams present in the faces, in 16 bits when they fit, as the faceFormat
+ * of the mesh describes. Faces with only positions then take 2 bytes per face vertex instead of 12.
+ * The faces are compacted in place, and their array shrunk, except in single block meshes which
+ * keep their block. Returns false when a mesh mapped from a cache could not get its compact array.
+ *
+ * obj_get_face_vertex returns face vertex @idx of @mesh, whether its faces are compact or not.
+ */
+extern bool        obj_compact_faces(Obj_Mesh *mesh);
+extern Obj_VertIdx obj_get_face_vertex(const Obj_Mesh *mesh, uint32_t idx);
+
+/*
+ * obj_get_position / obj_get_normal / obj_get_texcoord:
+ *
+ * Return vertex attribute @idx of @mesh as floats, whether it was quantized or not
+ */
+extern void obj_get_position(const Obj_Mesh *mesh, uint32_t idx, float position[3]);
+extern void obj_get_normal(const Obj_Mesh *mesh, uint32_t idx, float normal[3]);
+extern void obj_get_texcoord(const Obj_Mesh *mesh, uint32_t idx, float texcoord[2]);
+
+/*
+ * obj_get_range_name:
+ *
+ * Returns the name of @range, one of the @kind face ranges of @mesh, or NULL for smoothing ranges
+ */
+extern const char *obj_get_range_name(
+    const Obj_Mesh      *mesh,
+    Obj_RangeKind        kind,
+    const Obj_FaceRange *range
+);
+
+/*
+ * obj_find_material / obj_material_cache_clear:
+ *
+ * obj_find_material returns the material named @name in the material libraries of @mesh, searched
+ * in order, or NULL when none declares it.
+ *
+ * obj_material_cache_clear frees the cached material libraries which no mesh refers to anymore, so
+ * that the next reads parse them again.
+ */
+extern const Obj_Material *obj_find_material(const Obj_Mesh *mesh, const char *name);
+extern void                obj_material_cache_clear(void);
+
+/*
+ * obj_read_many:
+ *
+ * Reads the @count files at @paths, spread across @numThreads threads of @options, and stores the
+ * result of the read of @paths[i] in @results[i]. Files are mapped as with obj_read_mmap. Files
+ * large enough to keep all the threads busy are split in chunks, while smaller ones are read whole
+ * on a single thread each. Returns whether every read succeeded.
+ */
+extern bool obj_read_many(
+    const char *const     *paths,
+    uint32_t               count,
+    Obj_Return            *results,
+    const Obj_ReadOptions *options
+);
+
+/*
+ * obj_write_cache / obj_read_cache:
+ *
+ * Write a mesh to a versioned binary cache at @path, and read it back. The cache holds the mesh
+ * sizes, arrays and face ranges laid out as they are in memory, so reading it maps the file and
+ * points the mesh arrays straight into the mapping, without any parsing. Writing to the arrays of a
+ * cached mesh only modifies private copies of the pages written. Caches are only compatible with
+ * machines of the same byte order, and their content is trusted as is. The caches written by
+ * obj_write_cache are not tied to a wavefront file, so that reads with the useCache option do not
+ * use them.
+ */
+extern bool       obj_write_cache(const Obj_Mesh *mesh, const char *path);
+extern Obj_Return obj_read_cache(const char *path);
+
+/*
+ * Obj_WriteFormat:
+ *
+ * Formats obj_write writes meshes in
+ * @OBJ_WRITE_WAVEFRONT: wavefront text
+ * @OBJ_WRITE_CACHE: binary cache, as obj_write_cache writes it
+ */
+typedef enum Obj_WriteFormat {
+    OBJ_WRITE_WAVEFRONT = 0,
+    OBJ_WRITE_CACHE     = 1,
+} Obj_WriteFormat;
+
+/*
+ * Obj_WriteOptions:
+ *
+ * Options controlling how obj_write writes a mesh. A NULL options pointer selects the defaults,
+ * which are those of a zero-initialised struct.
+ * @format: Obj_WriteFormat of the file written
+ * @numThreads: number of threads formatting the lines of wavefront files, each into a buffer of
+ *  its own, the buffers being written in order. 0 or 1 format them on the calling thread only.
+ */
+typedef struct Obj_WriteOptions {
+    Obj_WriteFormat format;
+    uint32_t        numThreads;
+} Obj_WriteOptions;
+
+/*
+ * obj_write:
+ *
+ * Writes @mesh to @path, in the format of @options. Wavefront files hold the mtllib statements of
+ * the material libraries of the mesh, its positions, texture coordinates and normals, then its
+ * faces with absolute indices, preceded by the o, g, usemtl and s statements starting their
+ * ranges. Quantized attributes are written as the floats they stand for, and the position weights
+ * which are not 1 are kept. Floats are written with the fewest digits which read back to the same
+ * float, so that reading the file again gives back the same mesh, except for the payload of NaNs.
+ * Returns false when the file could not be written, in which case it is removed.
+ */
+extern bool obj_write(const Obj_Mesh *mesh, const char *path, const Obj_WriteOptions *options);
+
+/*
+ * Obj_GpuOptions:
+ *
+ * Options controlling how obj_gpu_mesh_build lays a mesh out. A NULL options pointer selects the
+ * defaults, which are those of a zero-initialised struct.
+ * @interleaved: store the vertices in a single interleaved array, instead of an array per component
+ * @earClipping: triangulate polygons by clipping their ears, which handles concave ones, instead of
+ *  fanning them out of their first vertex. Polygons which are not simple fall back on fans.
+ * @indices32: always emit 32-bit indices, even when the vertices fit 16-bit ones
+ * @optimizeVertexCache: reorder the triangles so that the vertices they share hit the vertex cache
+ *  of the GPU, in groups of consecutive triangles reordered on separate threads
+ * @optimizeOverdraw: with @optimizeVertexCache, also move first the clusters of triangles facing
+ *  furthest out of the mesh, which are the most likely to hide the others
+ * @optimizeVertexFetch: renumber the vertices in the order the triangles first use them
+ * @cacheSize: number of vertices of the vertex cache the triangles are ordered for, 16 when 0
+ * @numThreads: number of threads the faces are split across, 0 or 1 for the calling thread only
+ * @allocator: allocation hooks for the output arrays, malloc and free when the callbacks are NULL
+ */
+typedef struct Obj_GpuOptions {
+    bool          interleaved;
+    bool          earClipping;
+    bool          indices32;
+    bool          optimizeVertexCache;
+    bool          optimizeOverdraw;
+    bool          optimizeVertexFetch;
+    uint32_t      cacheSize;
+    uint32_t      numThreads;
+    Obj_Allocator allocator;
+} Obj_GpuOptions;
+
+/*
+ * Obj_GpuMesh:
+ *
+ * Triangle list with a single index per vertex, as consumed by graphics APIs. Each vertex is a
+ * distinct (position, texture coordinates, normal) triplet of the source mesh, in the order they
+ * first appear in its faces, which the triangles follow unless the options reorder them.
+ * @nVerts: number of vertices
+ * @nIndices: number of indices, three per triangle
+ * @hasNormals: whether the vertices have normals, zero for the face vertices without one
+ * @hasTexCoords: whether the vertices have texture coordinates, zero for the face vertices without
+ * @stride: number of floats per interleaved vertex, holding the position, then the normal and the
+ *  texture coordinates when the mesh has them, or 0 when the vertices are not interleaved
+ * @allocator: allocator the arrays come from, with NULL callbacks for malloc and free
+ */
+typedef struct Obj_GpuMesh {
+    uint32_t nVerts;
+    uint32_t nIndices;
+    bool     hasNormals;
+    bool     hasTexCoords;
+    uint32_t stride;
+
+    // Interleaved vertices
+    float *vertices;
+
+    // Separate vertex arrays, when not interleaved
+    float *posX;
+    float *posY;
+    float *posZ;
+    float *normX;
+    float *normY;
+    float *normZ;
+    float *texU;
+    float *texV;
+
+    // Triangle indices, 16-bit when all vertices fit and 32-bit otherwise, the other one being NULL
+    uint16_t *indices16;
+    uint32_t *indices32;
+
+    Obj_Allocator allocator;
+} Obj_GpuMesh;
+
+/*
+ * obj_gpu_mesh_build:
+ *
+ * Triangulates the faces of @mesh and merges the face vertices sharing the same indices, to build a
+ * vertex and an index buffer ready for upload. Faces of fewer than three vertices are left out.
+ * The triangles and vertices are then reordered for the GPU as @options ask for.
+ * Returns false when a face refers to elements the mesh does not have, or an allocation fails.
+ */
+extern bool obj_gpu_mesh_build(
+    const Obj_Mesh       *mesh,
+    const Obj_GpuOptions *options,
+    Obj_GpuMesh          *gpuMesh
+);
+extern void obj_gpu_mesh_free(Obj_GpuMesh *gpuMesh);
+
+/*
+ * Obj_MeshletOptions:
+ *
+ * Options controlling how obj_meshlets_build splits a mesh in meshlets. A NULL options pointer
+ * selects the defaults, which are those of a zero-initialised struct.
+ * @gpu: options of the GPU mesh the meshlets index, whose triangle order they follow, so that
+ *  @gpu.optimizeVertexCache packs them tighter
+ * @maxVertices: largest number of vertices of a meshlet, from 3 to 256, 64 when 0
+ * @maxTriangles: largest number of triangles of a meshlet, up to 512, 124 when 0
+ */
+typedef struct Obj_MeshletOptions {
+    Obj_GpuOptions gpu;
+    uint32_t       maxVertices;
+    uint32_t       maxTriangles;
+} Obj_MeshletOptions;
+
+/*
+ * Obj_Meshlet:
+ *
+ * Cluster of triangles drawn by a single mesh shader workgroup, with the bounds used to cull it
+ * @vertexOffset, @vertexCount: vertex indices of the meshlet within the meshlet vertex indices
+ * @triangleOffset, @triangleCount: byte offset of the triangles of the meshlet within the meshlet
+ *  triangles, a multiple of 4, and their number, each triangle being three bytes indexing the
+ *  vertices of the meshlet
+ * @center, @radius: bounding sphere of the vertices
+ * @coneApex, @coneAxis, @coneCutoff: normal cone of the triangles. The meshlet only shows back
+ *  faces to a camera at c when dot(normalize(@coneApex - c), @coneAxis) >= @coneCutoff, which
+ *  never holds when the cutoff is 1.
+ */
+typedef struct Obj_Meshlet {
+    uint32_t vertexOffset;
+    uint32_t triangleOffset;
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    float    center[3];
+    float    radius;
+    float    coneApex[3];
+    float    coneAxis[3];
+    float    coneCutoff;
+} Obj_Meshlet;
+
+/*
+ * Obj_Meshlets:
+ *
+ * Meshlets of a mesh, over the vertices of a GPU mesh. The meshlets, their vertex indices and
+ * their triangles are contiguous in a single block, in this order, so that they upload as one
+ * buffer.
+ * @mesh: GPU mesh holding the vertices, without an index buffer, nIndices being 0
+ * @nMeshlets: number of meshlets
+ * @nVertexIndices: number of vertex indices of all meshlets
+ * @nTriangleBytes: number of bytes of the triangles of all meshlets, padding included
+ * @meshlets: meshlets, at the start of the block
+ * @vertexIndices: indices in the vertices of @mesh of the vertices of each meshlet
+ * @triangles: triangles of each meshlet
+ */
+typedef struct Obj_Meshlets {
+    Obj_GpuMesh  mesh;
+    uint32_t     nMeshlets;
+    uint32_t     nVertexIndices;
+    uint32_t     nTriangleBytes;
+    Obj_Meshlet *meshlets;
+    uint32_t    *vertexIndices;
+    uint8_t     *triangles;
+} Obj_Meshlets;
+
+/*
+ * obj_meshlets_build:
+ *
+ * Builds the GPU mesh of @mesh as obj_gpu_mesh_build does, and splits its triangles in meshlets,
+ * each taking triangles in order while they fit its limits. The bounds of the meshlets are
+ * computed on the threads of the GPU options. Returns false when the limits are out of range, the
+ * GPU mesh fails to build, or an allocation fails.
+ */
+extern bool obj_meshlets_build(
+    const Obj_Mesh           *mesh,
+    const Obj_MeshletOptions *options,
+    Obj_Meshlets             *meshlets
+);
+extern void obj_meshlets_free(Obj_Meshlets *meshlets);
+
+/*
+ * obj_compute_bounds / obj_compute_normals / obj_compute_tangents:
+ *
+ * Passes over the positions and faces of a mesh, split across @numThreads threads, 0 or 1 for the
+ * calling thread only. They read meshes whether their faces are compact or their attributes
+ * quantized.
+ *
+ * obj_compute_bounds returns the bounds of the positions of @mesh, whose min is above its max when
+ * it has none.
+ *
+ * obj_compute_normals writes the smooth normal of each position of @mesh to @normX, @normY and
+ * @normZ, which hold sizes.nPos floats each: the normalized sum of the normals of the faces using
+ * the position, weighted by their area. Positions of no face, or only of degenerate ones, get a
+ * null normal.
+ *
+ * obj_compute_tangents writes a tangent per face vertex of @mesh to @tanX, @tanY, @tanZ and @tanW,
+ * which hold sizes.flatFacesSize floats each, laid out as MikkTSpace tangents: a unit tangent
+ * orthogonal to the normal of the face vertex, and in @tanW the sign of the bitangent, which is
+ * @tanW * cross(normal, tangent). Tangents are summed over the faces sharing texture coordinates,
+ * weighted by area, apart for faces with mirrored coordinates. Face vertices without a normal use
+ * the smooth normal of their position, and the ones without texture coordinates get a null tangent
+ * and a @tanW of 1.
+ *
+ * obj_compute_normals and obj_compute_tangents return false when a face refers to elements the mesh
+ * does not have, or an allocation fails.
+ */
+extern Obj_Bounds obj_compute_bounds(const Obj_Mesh *mesh, uint32_t numThreads);
+extern bool       obj_compute_normals(
+    const Obj_Mesh *mesh,
+    uint32_t        numThreads,
+    float          *normX,
+    float          *normY,
+    float          *normZ
+);
+extern bool obj_compute_tangents(
+    const Obj_Mesh *mesh,
+    uint32_t        numThreads,
+    float          *tanX,
+    float          *tanY,
+    float          *tanZ,
+    float          *tanW
+);
+
+/*
+ * Obj_Batch:
+ *
+ * Elements read from a range of consecutive lines of a streamed file
+ * @sizes: number of elements of each kind in the batch, any of which may be 0
+ * @base: number of elements of each kind in all previous batches. Face indices are absolute as in a
+ *  fully read mesh, so element i of the batch has index @base + i + 1, and faces may refer to
+ *  elements of previous batches.
+ * @data: arrays holding the batch elements, which are owned by the stream and only valid until the
+ *  next call to obj_stream_next or obj_stream_close
+ */
+typedef struct Obj_Batch {
+    Obj_MeshSizes sizes;
+    Obj_MeshSizes base;
+    Obj_MeshData  data;
+} Obj_Batch;
+
+/*
+ * Obj_Stream:
+ *
+ * Pull iterator reading a file in batches, for meshes which need not or can not be held in memory
+ * at once. The file is read through a buffer of @bufferSize bytes, 1MiB when 0, which only grows
+ * for lines longer than it, and the batch arrays are reused from one batch to the next, so memory
+ * use does not depend on the file size. Only the @loadFlags and @allocator read options apply, and
+ * batches hold no face ranges.
+ *
+ * obj_stream_next returns false once the whole file was read, or when an error aborted the read,
+ * which obj_stream_failed tells.
+ */
+typedef struct Obj_Stream Obj_Stream;
+
+extern Obj_Stream *obj_stream_open(
+    const char            *path,
+    const Obj_ReadOptions *options,
+    size_t                 bufferSize
+);
+extern bool        obj_stream_next(Obj_Stream *stream, Obj_Batch *batch);
+extern bool        obj_stream_failed(const Obj_Stream *stream);
+extern void        obj_stream_close(Obj_Stream *stream);
+
+/*
+ * Obj_LazyStreams:
+ *
+ * Element streams of a lazily opened file, which obj_lazy_load parses on demand
+ * @OBJ_LAZY_POSITIONS: vertex positions, along with posW unless skipped
+ * @OBJ_LAZY_TEXCOORDS: vertex texture coordinates
+ * @OBJ_LAZY_NORMALS: vertex normals
+ * @OBJ_LAZY_FACES: faces and their sizes
+ */
+typedef enum Obj_LazyStreams {
+    OBJ_LAZY_POSITIONS = 1u << 0,
+    OBJ_LAZY_TEXCOORDS = 1u << 1,
+    OBJ_LAZY_NORMALS   = 1u << 2,
+    OBJ_LAZY_FACES     = 1u << 3,
+    OBJ_LAZY_ALL       = 0xFu,
+} Obj_LazyStreams;
+
+/*
+ * Obj_LazyMesh:
+ *
+ * Wavefront file opened for its element counts, whose streams are only parsed once asked for.
+ * obj_open_lazy runs the counting pass alone over the file, either @mapped or read through
+ * read-ahead buffers which are freed once done, and records the byte offsets of every run of
+ * consecutive lines holding elements of the same kind. Its mesh then holds the sizes of the file,
+ * but NULL arrays, until obj_lazy_load parses the Obj_LazyStreams @streams asked for, by parsing
+ * their runs only: in place when the file is mapped, and by seeking to them otherwise. Files which
+ * are not mapped are closed in between, so any number of them can stay open, and loads fail when
+ * the file changed since. Faces are loaded apart from the vertex attributes, their relative indices
+ * resolving against the counts of the elements preceding them.
+ * Only the @loadFlags, @allocator, @quantizeFlags and @verbose read options apply, and the mesh has
+ * no face ranges nor material libraries. The mesh belongs to the lazy file, and is freed with it
+ * by obj_lazy_close.
+ */
+typedef struct Obj_LazyMesh Obj_LazyMesh;
+
+extern Obj_LazyMesh   *obj_open_lazy(const char *path, const Obj_ReadOptions *options, bool mapped);
+extern const Obj_Mesh *obj_lazy_mesh(const Obj_LazyMesh *lazy);
+extern bool            obj_lazy_load(Obj_LazyMesh *lazy, uint32_t streams);
+extern void            obj_lazy_close(Obj_LazyMesh *lazy);
 
 #endif  // OBJ_READER_H